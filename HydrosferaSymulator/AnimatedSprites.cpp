@@ -0,0 +1,303 @@
+#include "AnimatedSprites.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+
+using namespace std;
+
+// Frame index from the clock, then the cell of that frame in the sheet grid. The clip table row
+// holds (frame width, frame height in sheet uv, columns, frame count) and (fps, looping, -, -).
+static const char* ANIMATED_VS =
+    "#version 330\n"
+    "layout(location = 0) in vec2 corner;\n"
+    "layout(location = 1) in vec4 instanceRect;\n"
+    "layout(location = 2) in vec3 instanceAnim;\n"
+    "layout(location = 3) in vec4 instanceTint;\n"
+    "uniform mat4 mvp;\n"
+    "uniform float time;\n"
+    "uniform sampler2D clipTable;\n"
+    "out vec2 uv;\n"
+    "out vec4 tint;\n"
+    "void main()\n"
+    "{\n"
+    "    int clip = int(instanceAnim.z + 0.5);\n"
+    "    vec4 grid = texelFetch(clipTable, ivec2(0, clip), 0);\n"
+    "    vec4 playback = texelFetch(clipTable, ivec2(1, clip), 0);\n"
+    "    float fps = (instanceAnim.y > 0.0) ? instanceAnim.y : playback.x;\n"
+    "    float frame = floor(max(time - instanceAnim.x, 0.0)*fps);\n"
+    "    frame = (playback.y > 0.5) ? mod(frame, grid.w) : min(frame, grid.w - 1.0);\n"
+    "    vec2 cell = vec2(mod(frame, grid.z), floor(frame/grid.z));\n"
+    "    vec2 local = vec2((instanceRect.z < 0.0) ? 1.0 - corner.x : corner.x, corner.y);\n"
+    "    uv = (cell + local)*grid.xy;\n"
+    "    tint = instanceTint;\n"
+    "    gl_Position = mvp*vec4(instanceRect.xy + corner*abs(instanceRect.zw), 0.0, 1.0);\n"
+    "}\n";
+
+static const char* ANIMATED_FS =
+    "#version 330\n"
+    "in vec2 uv;\n"
+    "in vec4 tint;\n"
+    "uniform sampler2D sheet;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    finalColor = texture(sheet, uv)*tint;\n"
+    "}\n";
+
+static int ClipColumns(const AnimationClip& clip)
+{
+    int sheetW = (clip.sheet != nullptr) ? clip.sheet->width : 0;
+    int cols = clip.columns;
+    if (cols <= 0) cols = (sheetW > 0 && clip.frameWidth > 0) ? (sheetW / clip.frameWidth) : 1;
+    return max(cols, 1);
+}
+
+// Same frame the shader picks, for the immediate-mode fallback
+static int FrameAt(const AnimationClip& clip, const AnimatedSpriteInstance& s, float time)
+{
+    float fps = (s.fps > 0.0f) ? s.fps : clip.fps;
+    if (clip.frameCount <= 0) return 0;
+    int frame = (int)floorf(max(time - s.startTime, 0.0f) * fps);
+    return (clip.loopMode == ANIM_LOOP) ? frame % clip.frameCount : min(frame, clip.frameCount - 1);
+}
+
+// Rebuild the clip table when a sheet was (re)loaded with a different size
+static void RefreshClipTable(AnimatedSprites& as)
+{
+    const vector<AnimationClip>& clips = *as.clips;
+    bool changed = false;
+    for (int c = 0; c < (int)clips.size(); ++c)
+    {
+        int w = (clips[c].sheet != nullptr) ? clips[c].sheet->width : 0;
+        int h = (clips[c].sheet != nullptr) ? clips[c].sheet->height : 0;
+        if (as.clipSheetSizes[2 * c] == w && as.clipSheetSizes[2 * c + 1] == h) continue;
+        as.clipSheetSizes[2 * c] = w;
+        as.clipSheetSizes[2 * c + 1] = h;
+        changed = true;
+
+        const AnimationClip& clip = clips[c];
+        float* row = &as.clipTableData[c * ANIMATED_SPRITE_CLIP_TEXELS * 4];
+        row[0] = (w > 0) ? (float)clip.frameWidth / (float)w : 0.0f;
+        row[1] = (h > 0) ? (float)clip.frameHeight / (float)h : 0.0f;
+        row[2] = (float)ClipColumns(clip);
+        row[3] = (float)max(clip.frameCount, 1);
+        row[4] = (clip.loopMode == ANIM_MANUAL) ? 0.0f : clip.fps;
+        row[5] = (clip.loopMode == ANIM_LOOP) ? 1.0f : 0.0f;
+        row[6] = 0.0f;
+        row[7] = 0.0f;
+    }
+    if (changed && as.clipTable.id != 0) UpdateTexture(as.clipTable, as.clipTableData.data());
+}
+
+AnimatedSprites CreateAnimatedSprites(const vector<AnimationClip>& clips, int capacity)
+{
+    AnimatedSprites as;
+    as.clips = &clips;
+    as.capacity = max(1, capacity);
+    as.dirty = false;
+    as.clipTable = { 0 };
+    as.clipTableData.assign(clips.size() * ANIMATED_SPRITE_CLIP_TEXELS * 4, 0.0f);
+    as.clipSheetSizes.assign(clips.size() * 2, -1);
+    as.quad = { 0, 0, 0 };
+    as.locMvp = as.locTime = as.locSheet = as.locClipTable = -1;
+    as.uploads = 0;
+    as.lastDrawMs = 0.0f;
+
+    as.shader = LoadShaderFromMemory(ANIMATED_VS, ANIMATED_FS);
+    as.instanced = (as.shader.id != 0 && as.shader.id != rlGetShaderIdDefault());
+    if (!as.instanced)
+    {
+        TraceLog(LOG_WARNING, "ANIMSPRITES: shader unavailable, frames are picked on the CPU");
+        return as;
+    }
+    as.locMvp = GetShaderLocation(as.shader, "mvp");
+    as.locTime = GetShaderLocation(as.shader, "time");
+    as.locSheet = GetShaderLocation(as.shader, "sheet");
+    as.locClipTable = GetShaderLocation(as.shader, "clipTable");
+
+    Image table = { as.clipTableData.data(), ANIMATED_SPRITE_CLIP_TEXELS, (int)clips.size(), 1, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32 };
+    as.clipTable = LoadTextureFromImage(table);
+    SetTextureFilter(as.clipTable, TEXTURE_FILTER_POINT);
+    RefreshClipTable(as);
+
+    // Offsets are moved to each group's first instance when drawing
+    const InstanceAttribute attributes[] = {
+        { 1, 4, RL_FLOAT, false, 0 },
+        { 2, 3, RL_FLOAT, false, (int)offsetof(AnimatedSpriteInstance, startTime) },
+        { 3, 4, RL_UNSIGNED_BYTE, true, (int)offsetof(AnimatedSpriteInstance, tint) }
+    };
+    as.quad = LoadInstancedQuad(as.capacity, (int)sizeof(AnimatedSpriteInstance), attributes, 3);
+    return as;
+}
+
+void UnloadAnimatedSprites(AnimatedSprites& as)
+{
+    UnloadInstancedQuad(as.quad);
+    if (as.clipTable.id != 0) UnloadTexture(as.clipTable);
+    as.clipTable = { 0 };
+    if (as.instanced) UnloadShader(as.shader);
+    as.instanced = false;
+    as.instances.clear();
+    as.layers.clear();
+    as.visible.clear();
+    as.upload.clear();
+    as.groups.clear();
+}
+
+int AddAnimatedSprite(AnimatedSprites& as, int clip, Rectangle dst, float startTime, int layer, float fps)
+{
+    if ((int)as.instances.size() >= as.capacity || clip < 0 || clip >= (int)as.clips->size()) return -1;
+
+    AnimatedSpriteInstance s = { dst.x, dst.y, dst.width, dst.height, startTime, fps, (float)clip, { 255, 255, 255, 255 } };
+    as.instances.push_back(s);
+    as.layers.push_back(layer);
+    as.visible.push_back(true);
+    as.dirty = true;
+    return (int)as.instances.size() - 1;
+}
+
+void SetAnimatedSprite(AnimatedSprites& as, int handle, Rectangle dst, Color tint)
+{
+    if (handle < 0 || handle >= (int)as.instances.size()) return;
+    AnimatedSpriteInstance& s = as.instances[handle];
+    AnimatedSpriteInstance updated = s;
+    updated.x = dst.x;
+    updated.y = dst.y;
+    updated.width = dst.width;
+    updated.height = dst.height;
+    updated.tint[0] = tint.r;
+    updated.tint[1] = tint.g;
+    updated.tint[2] = tint.b;
+    updated.tint[3] = tint.a;
+    if (memcmp(&updated, &s, sizeof(s)) == 0) return;
+    s = updated;
+    as.dirty = true;
+}
+
+void SetAnimatedSpriteVisible(AnimatedSprites& as, int handle, bool visible)
+{
+    if (handle < 0 || handle >= (int)as.instances.size() || as.visible[handle] == visible) return;
+    as.visible[handle] = visible;
+    as.dirty = true;
+}
+
+// Order the visible instances by layer and sheet and upload them in one go
+static void Rebuild(AnimatedSprites& as)
+{
+    const vector<AnimationClip>& clips = *as.clips;
+    vector<int> order;
+    for (int i = 0; i < (int)as.instances.size(); ++i) if (as.visible[i]) order.push_back(i);
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        if (as.layers[a] != as.layers[b]) return as.layers[a] < as.layers[b];
+        return less<const Texture2D*>()(clips[(int)as.instances[a].clip].sheet, clips[(int)as.instances[b].clip].sheet);
+        });
+
+    as.upload.clear();
+    as.groups.clear();
+    for (int i : order)
+    {
+        const AnimatedSpriteInstance& s = as.instances[i];
+        int clip = (int)s.clip;
+        if (as.groups.empty() || as.groups.back().layer != as.layers[i] || clips[as.groups.back().clip].sheet != clips[clip].sheet)
+        {
+            as.groups.push_back({ as.layers[i], clip, (int)as.upload.size(), 0 });
+        }
+        as.groups.back().count++;
+        as.upload.push_back(s);
+    }
+
+    if (as.quad.vao != 0 && !as.upload.empty())
+    {
+        rlUpdateVertexBuffer(as.quad.instanceVbo, as.upload.data(), (int)(as.upload.size() * sizeof(AnimatedSpriteInstance)), 0);
+    }
+    as.uploads++;
+    as.dirty = false;
+}
+
+void DrawAnimatedSprites(AnimatedSprites& as, int layer, float time)
+{
+    if (as.dirty) Rebuild(as);
+    auto start = chrono::high_resolution_clock::now();
+    const vector<AnimationClip>& clips = *as.clips;
+
+    bool any = false;
+    for (const AnimatedSpriteGroup& g : as.groups) any = any || (g.layer == layer && IsClipDrawable(clips[g.clip]));
+    if (!any) return;
+
+    if (as.quad.vao != 0)
+    {
+        RefreshClipTable(as);
+        int sheetSlot = 0;
+        int tableSlot = 1;
+        BeginCustomDraw(as.shader, as.locMvp);
+        rlSetUniform(as.locTime, &time, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(as.locSheet, &sheetSlot, RL_SHADER_UNIFORM_INT, 1);
+        rlSetUniform(as.locClipTable, &tableSlot, RL_SHADER_UNIFORM_INT, 1);
+        rlActiveTextureSlot(1);
+        rlEnableTexture(as.clipTable.id);
+
+        rlEnableVertexArray(as.quad.vao);
+        rlEnableVertexBuffer(as.quad.instanceVbo);
+        const int stride = (int)sizeof(AnimatedSpriteInstance);
+        for (const AnimatedSpriteGroup& g : as.groups)
+        {
+            if (g.layer != layer || !IsClipDrawable(clips[g.clip])) continue;
+
+            // No base-instance draws in GL 3.3: point the instance attributes at the group instead
+            int base = g.first * stride;
+            rlSetVertexAttribute(1, 4, RL_FLOAT, false, stride, base);
+            rlSetVertexAttribute(2, 3, RL_FLOAT, false, stride, base + (int)offsetof(AnimatedSpriteInstance, startTime));
+            rlSetVertexAttribute(3, 4, RL_UNSIGNED_BYTE, true, stride, base + (int)offsetof(AnimatedSpriteInstance, tint));
+
+            rlActiveTextureSlot(0);
+            rlEnableTexture(clips[g.clip].sheet->id);
+            rlDrawVertexArrayInstanced(0, 6, g.count);
+        }
+        rlDisableVertexBuffer();
+        rlDisableVertexArray();
+        rlActiveTextureSlot(1);
+        rlDisableTexture();
+        rlActiveTextureSlot(0);
+        rlDisableTexture();
+        rlDisableShader();
+    }
+    else
+    {
+        for (const AnimatedSpriteGroup& g : as.groups)
+        {
+            if (g.layer != layer || !IsClipDrawable(clips[g.clip])) continue;
+
+            const Texture2D& sheet = *clips[g.clip].sheet;
+            rlSetTexture(sheet.id);
+            rlBegin(RL_QUADS);
+            for (int i = g.first; i < g.first + g.count; ++i)
+            {
+                const AnimatedSpriteInstance& s = as.upload[i];
+                const AnimationClip& clip = clips[(int)s.clip];
+                Rectangle src = GetClipFrameRect(clip, FrameAt(clip, s, time));
+                float u0 = src.x / sheet.width;
+                float u1 = (src.x + src.width) / sheet.width;
+                float v0 = src.y / sheet.height;
+                float v1 = (src.y + src.height) / sheet.height;
+                if (s.width < 0.0f) swap(u0, u1);
+                float x1 = s.x + fabsf(s.width);
+                float y1 = s.y + s.height;
+
+                rlColor4ub(s.tint[0], s.tint[1], s.tint[2], s.tint[3]);
+                rlTexCoord2f(u0, v0); rlVertex2f(s.x, s.y);
+                rlTexCoord2f(u0, v1); rlVertex2f(s.x, y1);
+                rlTexCoord2f(u1, v1); rlVertex2f(x1, y1);
+                rlTexCoord2f(u1, v0); rlVertex2f(x1, s.y);
+            }
+            rlEnd();
+        }
+        rlSetTexture(0);
+        rlDrawRenderBatchActive();
+    }
+
+    as.lastDrawMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
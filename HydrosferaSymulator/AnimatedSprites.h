@@ -0,0 +1,74 @@
+#pragma once
+
+#include "raylib.h"
+#include "Animation.h"
+#include "GpuQuad.h"
+#include <vector>
+
+// Looping creatures animated entirely on the GPU. Each instance stores its clip, start time and
+// rate; the vertex shader works out the frame from the clock and reads the frame layout of the
+// clip from a small float texture (the clip table), so the CPU neither advances animators nor
+// builds source rectangles for them. Instances sharing a sheet are drawn with one instanced call.
+const int ANIMATED_SPRITE_CLIP_TEXELS = 2;   // clip table width: frame layout, playback
+
+struct AnimatedSpriteInstance
+{
+    float x;           // world destination; a negative width mirrors the sprite
+    float y;
+    float width;
+    float height;
+    float startTime;   // s on the clock passed to DrawAnimatedSprites
+    float fps;         // 0 = the clip's own rate
+    float clip;        // row of the clip table
+    unsigned char tint[4];
+};
+
+// Consecutive uploaded instances with the same layer and sheet
+struct AnimatedSpriteGroup
+{
+    int layer;
+    int clip;          // any clip of the group, for the sheet
+    int first;
+    int count;
+};
+
+struct AnimatedSprites
+{
+    const std::vector<AnimationClip>* clips;
+    int capacity;
+    std::vector<AnimatedSpriteInstance> instances;   // by handle
+    std::vector<int> layers;
+    std::vector<bool> visible;
+    std::vector<AnimatedSpriteInstance> upload;      // visible instances grouped by layer and sheet
+    std::vector<AnimatedSpriteGroup> groups;
+    bool dirty;
+
+    Texture2D clipTable;                 // RGBA32F, one row per clip
+    std::vector<float> clipTableData;
+    std::vector<int> clipSheetSizes;     // sheet width and height the table was built for
+
+    InstancedQuad quad;  // vao 0 when instancing is unavailable
+    Shader shader;
+    int locMvp;
+    int locTime;
+    int locSheet;
+    int locClipTable;
+    bool instanced;
+
+    int uploads;
+    float lastDrawMs;
+};
+
+// Needs a GL context (call after InitWindow). The clip table must outlive the renderer.
+AnimatedSprites CreateAnimatedSprites(const std::vector<AnimationClip>& clips, int capacity);
+void UnloadAnimatedSprites(AnimatedSprites& as);
+
+// Returns a handle, or -1 when the renderer is full
+int AddAnimatedSprite(AnimatedSprites& as, int clip, Rectangle dst, float startTime, int layer, float fps = 0.0f);
+
+// Changes only cause an upload when they differ from what is already there
+void SetAnimatedSprite(AnimatedSprites& as, int handle, Rectangle dst, Color tint);
+void SetAnimatedSpriteVisible(AnimatedSprites& as, int handle, bool visible);
+
+// Draw the instances of one layer inside BeginMode2D, one instanced call per sheet
+void DrawAnimatedSprites(AnimatedSprites& as, int layer, float time);
@@ -0,0 +1,83 @@
+#include "Animation.h"
+#include <algorithm>
+
+using namespace std;
+
+Animator MakeAnimator(int clip, bool playing)
+{
+    Animator a;
+    a.clip = clip;
+    a.frame = 0;
+    a.timer = 0.0f;
+    a.loops = 0;
+    a.playing = playing;
+    a.finished = false;
+    return a;
+}
+
+void RestartAnimator(Animator& animator)
+{
+    animator.frame = 0;
+    animator.timer = 0.0f;
+    animator.loops = 0;
+    animator.playing = true;
+    animator.finished = false;
+}
+
+void UpdateAnimators(vector<Animator>& animators, const vector<AnimationClip>& clips, float dt)
+{
+    for (Animator& a : animators)
+    {
+        if (!a.playing || a.finished) continue;
+
+        const AnimationClip& clip = clips[a.clip];
+        if (clip.loopMode == ANIM_MANUAL || clip.fps <= 0.0f || clip.frameCount <= 0) continue;
+
+        const float frameTime = 1.0f / clip.fps;
+        a.timer += dt;
+        while (a.timer >= frameTime)
+        {
+            a.timer -= frameTime;
+            a.frame++;
+            if (a.frame >= clip.frameCount)
+            {
+                if (clip.loopMode == ANIM_LOOP)
+                {
+                    a.frame = 0;
+                    a.loops++;
+                }
+                else
+                {
+                    a.frame = clip.frameCount - 1;
+                    a.finished = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+Rectangle GetClipFrameRect(const AnimationClip& clip, int frame)
+{
+    int sheetW = (clip.sheet != nullptr) ? clip.sheet->width : 0;
+    int sheetH = (clip.sheet != nullptr) ? clip.sheet->height : 0;
+
+    if (clip.frameCount > 0) frame = max(0, min(frame, clip.frameCount - 1));
+
+    int cols = clip.columns;
+    if (cols <= 0) cols = (sheetW > 0 && clip.frameWidth > 0) ? (sheetW / clip.frameWidth) : 1;
+    if (cols <= 0) cols = 1;
+
+    float srcX = (float)((frame % cols) * clip.frameWidth);
+    float srcY = (float)((frame / cols) * clip.frameHeight);
+
+    if (sheetW > 0 && srcX + clip.frameWidth > sheetW) srcX = (float)max(0, sheetW - clip.frameWidth);
+    if (sheetH > 0 && srcY + clip.frameHeight > sheetH) srcY = (float)max(0, sheetH - clip.frameHeight);
+
+    return { srcX, srcY, (float)clip.frameWidth, (float)clip.frameHeight };
+}
+
+bool IsClipDrawable(const AnimationClip& clip)
+{
+    return clip.sheet != nullptr && clip.sheet->id != 0;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "raylib.h"
+#include <vector>
+
+// How an animator advances once it reaches the last frame of its clip
+enum AnimLoopMode
+{
+    ANIM_LOOP = 0,  // wrap to frame 0 and count a completed loop
+    ANIM_ONCE,      // stop on the last frame and mark the animator finished
+    ANIM_MANUAL     // never advanced by time, frame is set by gameplay code (e.g. mouth open/closed)
+};
+
+// Clip ids, order matches the NPC spriteId values used in npcDefinitions
+enum ClipId
+{
+    CLIP_NPC = 0,
+    CLIP_CAT_POP,
+    CLIP_CAT_CRUNCH,
+    CLIP_CAT_CRY,
+    CLIP_CAT_SPINNING,
+    CLIP_HAPPY,
+    CLIP_CONGRATS,
+    CLIP_PLAYER_WALK,
+    CLIP_PLAYER_RUN,
+    CLIP_PLAYER_JUMP,
+    CLIP_COUNT
+};
+
+// One entry of the clip table: a spritesheet laid out as a grid of equally sized frames
+struct AnimationClip
+{
+    const Texture2D* sheet; // texture owned by the caller, reloads replace it in place
+    int frameWidth;
+    int frameHeight;
+    int frameCount;
+    int columns;            // frames per row, 0 = derive from sheet width
+    float fps;
+    AnimLoopMode loopMode;
+};
+
+// Per-instance playback state, kept small so all animators advance in one tight loop
+struct Animator
+{
+    int clip;
+    int frame;
+    float timer;
+    int loops;
+    bool playing;
+    bool finished;
+};
+
+Animator MakeAnimator(int clip, bool playing = true);
+void RestartAnimator(Animator& animator);
+
+// Advance every playing animator by dt in a single pass over the table
+void UpdateAnimators(std::vector<Animator>& animators, const std::vector<AnimationClip>& clips, float dt);
+
+// Source rectangle of a frame inside the clip's sheet (clamped to the sheet bounds)
+Rectangle GetClipFrameRect(const AnimationClip& clip, int frame);
+
+bool IsClipDrawable(const AnimationClip& clip);
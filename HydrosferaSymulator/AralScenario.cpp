@@ -0,0 +1,308 @@
+#include "AralScenario.h"
+#include "raylib.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+
+using namespace std;
+
+static const float FIELD_SCALE[ARAL_SCENARIO_FIELDS] = { 100.0f, 1.0f, 10.0f };
+
+static void WriteU16(ostream& out, unsigned v)
+{
+    out.put((char)(v & 0xFF));
+    out.put((char)((v >> 8) & 0xFF));
+}
+
+static void WriteU32(ostream& out, unsigned v)
+{
+    WriteU16(out, v & 0xFFFF);
+    WriteU16(out, v >> 16);
+}
+
+static void WriteVarint(string& out, int32_t v)
+{
+    uint32_t z = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+    while (z >= 0x80)
+    {
+        out.push_back((char)((z & 0x7F) | 0x80));
+        z >>= 7;
+    }
+    out.push_back((char)z);
+}
+
+static bool ReadU16(istream& in, unsigned& v)
+{
+    unsigned char b[2];
+    if (!in.read((char*)b, 2)) return false;
+    v = b[0] | (b[1] << 8);
+    return true;
+}
+
+static bool ReadU32(istream& in, unsigned& v)
+{
+    unsigned lo, hi;
+    if (!ReadU16(in, lo) || !ReadU16(in, hi)) return false;
+    v = lo | (hi << 16);
+    return true;
+}
+
+static bool ReadVarint(const unsigned char*& p, const unsigned char* end, int32_t& v)
+{
+    uint32_t z = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7)
+    {
+        unsigned char b = *p++;
+        z |= (uint32_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+        {
+            v = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+AralScenario LoadAralScenario(const string& path)
+{
+    AralScenario s;
+    s.loaded = false;
+    s.firstYear = 0;
+    s.sampleCount = 0;
+    s.samplesPerChunk = 1;
+    s.useCounter = 0;
+    s.chunksDecoded = 0;
+    for (AralChunk& c : s.cache) c.index = -1;
+
+    s.file.open(path, ios::binary);
+    char magic[4];
+    unsigned version, firstYear, sampleCount, samplesPerChunk, chunkCount;
+    if (!s.file.read(magic, 4) || string(magic, 4) != "ARAL" ||
+        !ReadU16(s.file, version) || !ReadU16(s.file, firstYear) || !ReadU16(s.file, sampleCount) ||
+        !ReadU16(s.file, samplesPerChunk) || !ReadU16(s.file, chunkCount) ||
+        version != ARAL_SCENARIO_VERSION || sampleCount < 2 || samplesPerChunk == 0 ||
+        chunkCount != (sampleCount + samplesPerChunk - 1) / samplesPerChunk)
+    {
+        TraceLog(LOG_WARNING, "ARAL: '%s' is missing or not a scenario file", path.c_str());
+        s.file.close();
+        return s;
+    }
+
+    s.chunkOffsets.resize(chunkCount + 1);
+    for (unsigned& offset : s.chunkOffsets)
+    {
+        if (!ReadU32(s.file, offset))
+        {
+            TraceLog(LOG_WARNING, "ARAL: '%s' has a truncated chunk table", path.c_str());
+            s.file.close();
+            return s;
+        }
+    }
+
+    s.firstYear = (int)(int16_t)firstYear;
+    s.sampleCount = (int)sampleCount;
+    s.samplesPerChunk = (int)samplesPerChunk;
+    for (AralChunk& c : s.cache) c.samples.reserve(s.samplesPerChunk);
+    s.loaded = true;
+    return s;
+}
+
+void UnloadAralScenario(AralScenario& scenario)
+{
+    scenario.file.close();
+    scenario.loaded = false;
+    for (AralChunk& c : scenario.cache)
+    {
+        c.index = -1;
+        c.samples.clear();
+    }
+}
+
+float GetAralScenarioFirstYear(const AralScenario& scenario)
+{
+    return (float)scenario.firstYear;
+}
+
+float GetAralScenarioLastYear(const AralScenario& scenario)
+{
+    return (float)(scenario.firstYear + max(0, scenario.sampleCount - 1));
+}
+
+// Cached chunk, decoded into the least recently used slot when missing
+static const AralChunk* GetChunk(AralScenario& s, int index)
+{
+    AralChunk* slot = &s.cache[0];
+    for (AralChunk& c : s.cache)
+    {
+        if (c.index == index)
+        {
+            c.lastUse = ++s.useCounter;
+            return &c;
+        }
+        if (c.index == -1 || (slot->index != -1 && c.lastUse < slot->lastUse)) slot = &c;
+    }
+
+    unsigned begin = s.chunkOffsets[index];
+    unsigned end = s.chunkOffsets[index + 1];
+    if (end <= begin) return nullptr;
+    vector<unsigned char> bytes(end - begin);
+    s.file.clear();
+    s.file.seekg(begin);
+    if (!s.file.read((char*)bytes.data(), bytes.size())) return nullptr;
+
+    int count = min(s.samplesPerChunk, s.sampleCount - index * s.samplesPerChunk);
+    const unsigned char* p = bytes.data();
+    const unsigned char* pEnd = p + bytes.size();
+    int32_t value[ARAL_SCENARIO_FIELDS] = { 0, 0, 0 };
+
+    slot->index = -1;
+    slot->samples.clear();
+    for (int i = 0; i < count; ++i)
+    {
+        // The first row is the keyframe, the rest are deltas from the row before
+        for (int f = 0; f < ARAL_SCENARIO_FIELDS; ++f)
+        {
+            int32_t d;
+            if (!ReadVarint(p, pEnd, d)) return nullptr;
+            value[f] = (i == 0) ? d : value[f] + d;
+        }
+        slot->samples.push_back({ value[0] / FIELD_SCALE[0], value[1] / FIELD_SCALE[1], value[2] / FIELD_SCALE[2] });
+    }
+
+    slot->index = index;
+    slot->lastUse = ++s.useCounter;
+    s.chunksDecoded++;
+    return slot;
+}
+
+static AralSample GetSample(AralScenario& s, int i)
+{
+    i = max(0, min(i, s.sampleCount - 1));
+    const AralChunk* c = GetChunk(s, i / s.samplesPerChunk);
+    if (c == nullptr) return { 0.0f, 0.0f, 0.0f };
+    return c->samples[i % s.samplesPerChunk];
+}
+
+void PrefetchAralScenario(AralScenario& scenario, float year, int direction)
+{
+    if (!scenario.loaded) return;
+    int chunkCount = (int)scenario.chunkOffsets.size() - 1;
+    int i = max(0, min((int)floorf(year) - scenario.firstYear, scenario.sampleCount - 1));
+    int chunk = i / scenario.samplesPerChunk;
+    GetChunk(scenario, chunk);
+    int ahead = chunk + (direction < 0 ? -1 : 1);
+    if (ahead >= 0 && ahead < chunkCount) GetChunk(scenario, ahead);
+}
+
+static float CatmullRom(float p0, float p1, float p2, float p3, float t)
+{
+    float v = 0.5f * (2.0f * p1 + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t * t +
+                      (3.0f * p1 - p0 - 3.0f * p2 + p3) * t * t * t);
+    return max(min(p1, p2), min(max(p1, p2), v));
+}
+
+AralSample SampleAralScenario(AralScenario& scenario, float year)
+{
+    if (!scenario.loaded) return { 0.0f, 0.0f, 0.0f };
+
+    float x = max(0.0f, min(year - (float)scenario.firstYear, (float)(scenario.sampleCount - 1)));
+    int i = min((int)x, scenario.sampleCount - 2);
+    float t = x - (float)i;
+
+    AralSample p0 = GetSample(scenario, i - 1);
+    AralSample p1 = GetSample(scenario, i);
+    AralSample p2 = GetSample(scenario, i + 1);
+    AralSample p3 = GetSample(scenario, i + 2);
+    return {
+        CatmullRom(p0.level, p1.level, p2.level, p3.level, t),
+        CatmullRom(p0.area, p1.area, p2.area, p3.area, t),
+        CatmullRom(p0.volume, p1.volume, p2.volume, p3.volume, t)
+    };
+}
+
+bool EncodeAralScenario(const string& csvPath, const string& binPath)
+{
+    ifstream in(csvPath);
+    if (!in)
+    {
+        TraceLog(LOG_WARNING, "ARAL: could not open '%s'", csvPath.c_str());
+        return false;
+    }
+
+    int firstYear = 0;
+    vector<int32_t> rows;
+    string line;
+    int lineNumber = 0;
+    while (getline(in, line))
+    {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#' || line.compare(0, 4, "year") == 0) continue;
+
+        // year,level_m,area_km2,volume_km3
+        replace(line.begin(), line.end(), ',', ' ');
+        istringstream fields(line);
+        int year;
+        float value[ARAL_SCENARIO_FIELDS];
+        if (!(fields >> year >> value[0] >> value[1] >> value[2]))
+        {
+            TraceLog(LOG_WARNING, "ARAL: %s:%d is not 'year,level,area,volume'", csvPath.c_str(), lineNumber);
+            return false;
+        }
+        int expected = firstYear + (int)rows.size() / ARAL_SCENARIO_FIELDS;
+        if (rows.empty()) firstYear = year;
+        else if (year != expected)
+        {
+            TraceLog(LOG_WARNING, "ARAL: %s:%d year %d should be %d", csvPath.c_str(), lineNumber, year, expected);
+            return false;
+        }
+        for (int f = 0; f < ARAL_SCENARIO_FIELDS; ++f) rows.push_back((int32_t)lroundf(value[f] * FIELD_SCALE[f]));
+    }
+
+    int sampleCount = (int)rows.size() / ARAL_SCENARIO_FIELDS;
+    if (sampleCount < 2 || sampleCount > 0xFFFF)
+    {
+        TraceLog(LOG_WARNING, "ARAL: '%s' needs at least two years of data", csvPath.c_str());
+        return false;
+    }
+
+    // Chunks are built first so the offset table can be written ahead of them
+    int chunkCount = (sampleCount + ARAL_SCENARIO_SAMPLES_PER_CHUNK - 1) / ARAL_SCENARIO_SAMPLES_PER_CHUNK;
+    vector<string> chunks(chunkCount);
+    for (int i = 0; i < sampleCount; ++i)
+    {
+        string& chunk = chunks[i / ARAL_SCENARIO_SAMPLES_PER_CHUNK];
+        bool keyframe = (i % ARAL_SCENARIO_SAMPLES_PER_CHUNK) == 0;
+        for (int f = 0; f < ARAL_SCENARIO_FIELDS; ++f)
+        {
+            int32_t v = rows[i * ARAL_SCENARIO_FIELDS + f];
+            WriteVarint(chunk, keyframe ? v : v - rows[(i - 1) * ARAL_SCENARIO_FIELDS + f]);
+        }
+    }
+
+    ofstream out(binPath, ios::binary);
+    out.write("ARAL", 4);
+    WriteU16(out, ARAL_SCENARIO_VERSION);
+    WriteU16(out, (unsigned)(int16_t)firstYear & 0xFFFF);
+    WriteU16(out, sampleCount);
+    WriteU16(out, ARAL_SCENARIO_SAMPLES_PER_CHUNK);
+    WriteU16(out, chunkCount);
+
+    unsigned offset = 14 + 4 * (chunkCount + 1);
+    for (const string& chunk : chunks)
+    {
+        WriteU32(out, offset);
+        offset += (unsigned)chunk.size();
+    }
+    WriteU32(out, offset);
+    for (const string& chunk : chunks) out.write(chunk.data(), chunk.size());
+
+    if (!out)
+    {
+        TraceLog(LOG_WARNING, "ARAL: could not write '%s'", binPath.c_str());
+        return false;
+    }
+    TraceLog(LOG_INFO, "ARAL: %d years from %d encoded into %u bytes", sampleCount, firstYear, offset);
+    return true;
+}
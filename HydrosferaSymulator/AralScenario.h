@@ -0,0 +1,61 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Aral Sea time-lapse: yearly level, area and volume streamed from a compact binary file.
+// Layout (little endian): "ARAL", u16 version, i16 first year, u16 sample count,
+// u16 samples per chunk, u16 chunk count, u32 file offset of every chunk. A chunk starts
+// with a keyframe of absolute values followed by zigzag varint deltas, fields stored as
+// integers (level in cm, area in km^2, volume in 0.1 km^3). Chunks are decoded on demand
+// into a small cache, so seeking anywhere on the timeline costs one chunk.
+const int ARAL_SCENARIO_VERSION = 1;
+const int ARAL_SCENARIO_FIELDS = 3;
+const int ARAL_SCENARIO_SAMPLES_PER_CHUNK = 8;
+const int ARAL_SCENARIO_CACHE_CHUNKS = 4;    // decoded chunks kept, least recently used is evicted
+
+struct AralSample
+{
+    float level;   // m above sea level
+    float area;    // km^2
+    float volume;  // km^3
+};
+
+struct AralChunk
+{
+    int index;                          // -1 while the slot is free
+    unsigned lastUse;
+    std::vector<AralSample> samples;
+};
+
+struct AralScenario
+{
+    std::ifstream file;
+    bool loaded;
+    int firstYear;
+    int sampleCount;
+    int samplesPerChunk;
+    std::vector<unsigned> chunkOffsets;  // one extra entry marks the end of the last chunk
+
+    AralChunk cache[ARAL_SCENARIO_CACHE_CHUNKS];
+    unsigned useCounter;
+    int chunksDecoded;                   // total decodes, for the debug overlay
+};
+
+// Read the header and offset table only; samples are decoded as the timeline reaches them
+AralScenario LoadAralScenario(const std::string& path);
+void UnloadAralScenario(AralScenario& scenario);
+
+float GetAralScenarioFirstYear(const AralScenario& scenario);
+float GetAralScenarioLastYear(const AralScenario& scenario);
+
+// Decode the chunk under 'year' and the next one in the playback direction if missing
+void PrefetchAralScenario(AralScenario& scenario, float year, int direction);
+
+// Values at a fractional year, Catmull-Rom between yearly samples clamped to the two
+// samples around it so the curve never overshoots the data
+AralSample SampleAralScenario(AralScenario& scenario, float year);
+
+// Convert 'year,level_m,area_km2,volume_km3' rows (consecutive years, '#' comments) to the binary format
+bool EncodeAralScenario(const std::string& csvPath, const std::string& binPath);
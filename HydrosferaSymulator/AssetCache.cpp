@@ -0,0 +1,210 @@
+#include "AssetCache.h"
+#include "HotReload.h"
+#include <deque>
+#include <unordered_map>
+
+using namespace std;
+
+struct AssetEntry
+{
+    string path;
+    bool isSound;
+    Texture2D texture;
+    Sound sound;
+    int refs;
+    unsigned lastUse;                  // stamped on release, the smallest unreferenced one is evicted first
+};
+
+struct AssetCache
+{
+    deque<AssetEntry> entries;         // deque keeps the references handed out stable
+    unordered_map<string, int> byPath;
+    size_t budgetBytes;
+    unsigned useCounter;
+    int loads;
+    int hits;
+    int evictions;
+
+    Texture2D missingTexture;          // returned for invalid handles
+    Sound missingSound;
+};
+
+AssetCache* CreateAssetCache(size_t budgetBytes)
+{
+    AssetCache* cache = new AssetCache();
+    cache->budgetBytes = budgetBytes;
+    cache->useCounter = 0;
+    cache->loads = 0;
+    cache->hits = 0;
+    cache->evictions = 0;
+    cache->missingTexture = { 0 };
+    cache->missingSound = { 0 };
+    return cache;
+}
+
+static bool IsResident(const AssetEntry& e)
+{
+    return e.isSound ? e.sound.frameCount != 0 : e.texture.id != 0;
+}
+
+static size_t ResidentBytes(const AssetEntry& e)
+{
+    if (!IsResident(e)) return 0;
+    if (e.isSound) return (size_t)e.sound.frameCount * e.sound.stream.channels * (e.sound.stream.sampleSize / 8);
+    return (size_t)GetPixelDataSize(e.texture.width, e.texture.height, e.texture.format);
+}
+
+static void Unload(AssetEntry& e)
+{
+    if (e.isSound && e.sound.frameCount != 0)
+    {
+        StopSound(e.sound);
+        UnloadSound(e.sound);
+    }
+    if (!e.isSound && e.texture.id != 0) UnloadTexture(e.texture);
+    e.texture = { 0 };
+    e.sound = { 0 };
+}
+
+static void Load(AssetCache* cache, AssetEntry& e)
+{
+    if (!FileExists(e.path.c_str()))
+    {
+        TraceLog(LOG_WARNING, "ASSETS: '%s' not found", e.path.c_str());
+        return;
+    }
+    if (e.isSound) e.sound = LoadSound(e.path.c_str());
+    else e.texture = LoadTexture(e.path.c_str());
+    if (IsResident(e)) cache->loads++;
+    else TraceLog(LOG_WARNING, "ASSETS: could not load '%s'", e.path.c_str());
+}
+
+// Evict unreferenced assets, least recently released first, until the resident set fits the budget.
+// Sizes are taken from the live assets, so hot reloads that change them are accounted for.
+static void Trim(AssetCache* cache)
+{
+    size_t total = 0;
+    for (const AssetEntry& e : cache->entries) total += ResidentBytes(e);
+
+    while (total > cache->budgetBytes)
+    {
+        AssetEntry* victim = nullptr;
+        for (AssetEntry& e : cache->entries)
+            if (e.refs == 0 && IsResident(e) && (victim == nullptr || e.lastUse < victim->lastUse)) victim = &e;
+        if (victim == nullptr) break;
+
+        total -= ResidentBytes(*victim);
+        Unload(*victim);
+        cache->evictions++;
+    }
+}
+
+static int Acquire(AssetCache* cache, const string& path, bool isSound)
+{
+    auto found = cache->byPath.find(path);
+    if (found != cache->byPath.end())
+    {
+        AssetEntry& e = cache->entries[found->second];
+        if (e.isSound != isSound)
+        {
+            TraceLog(LOG_WARNING, "ASSETS: '%s' is already cached as a %s", path.c_str(), e.isSound ? "sound" : "texture");
+            return -1;
+        }
+        e.refs++;
+        if (IsResident(e)) cache->hits++;
+        else Load(cache, e);
+        Trim(cache);
+        return found->second;
+    }
+
+    AssetEntry e;
+    e.path = path;
+    e.isSound = isSound;
+    e.texture = { 0 };
+    e.sound = { 0 };
+    e.refs = 1;
+    e.lastUse = 0;
+    cache->entries.push_back(e);
+    int index = (int)cache->entries.size() - 1;
+    cache->byPath[path] = index;
+    Load(cache, cache->entries[index]);
+    Trim(cache);
+    return index;
+}
+
+static void Release(AssetCache* cache, int index)
+{
+    if (index < 0 || index >= (int)cache->entries.size()) return;
+    AssetEntry& e = cache->entries[index];
+    if (e.refs == 0) return;
+    if (--e.refs == 0) e.lastUse = ++cache->useCounter;
+    Trim(cache);
+}
+
+TextureHandle AcquireTexture(AssetCache* cache, const string& path)
+{
+    return { Acquire(cache, path, false) };
+}
+
+SoundHandle AcquireSound(AssetCache* cache, const string& path)
+{
+    return { Acquire(cache, path, true) };
+}
+
+void ReleaseTexture(AssetCache* cache, TextureHandle handle)
+{
+    Release(cache, handle.index);
+}
+
+void ReleaseSound(AssetCache* cache, SoundHandle handle)
+{
+    Release(cache, handle.index);
+}
+
+Texture2D& GetTexture(AssetCache* cache, TextureHandle handle)
+{
+    if (handle.index < 0 || handle.index >= (int)cache->entries.size() || cache->entries[handle.index].isSound) return cache->missingTexture;
+    return cache->entries[handle.index].texture;
+}
+
+Sound& GetSound(AssetCache* cache, SoundHandle handle)
+{
+    if (handle.index < 0 || handle.index >= (int)cache->entries.size() || !cache->entries[handle.index].isSound) return cache->missingSound;
+    return cache->entries[handle.index].sound;
+}
+
+void WatchAssetCache(AssetCache* cache, HotReloader* reloader, const function<void(const void*)>& onReload)
+{
+    for (AssetEntry& e : cache->entries)
+    {
+        const void* asset = e.isSound ? (const void*)&e.sound : (const void*)&e.texture;
+        function<void()> notify = nullptr;
+        if (onReload) notify = [onReload, asset]() { onReload(asset); };
+        if (e.isSound) WatchSound(reloader, e.path, &e.sound, notify);
+        else WatchTexture(reloader, e.path, &e.texture, notify);
+    }
+}
+
+AssetCacheStats GetAssetCacheStats(const AssetCache* cache)
+{
+    AssetCacheStats stats = { 0 };
+    stats.entries = (int)cache->entries.size();
+    for (const AssetEntry& e : cache->entries)
+    {
+        if (e.refs > 0) stats.referenced++;
+        if (IsResident(e)) stats.resident++;
+        stats.residentBytes += ResidentBytes(e);
+    }
+    stats.budgetBytes = cache->budgetBytes;
+    stats.loads = cache->loads;
+    stats.hits = cache->hits;
+    stats.evictions = cache->evictions;
+    return stats;
+}
+
+void DestroyAssetCache(AssetCache* cache)
+{
+    if (cache == nullptr) return;
+    for (AssetEntry& e : cache->entries) Unload(e);
+    delete cache;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "raylib.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+struct HotReloader;
+
+// Central store for textures and sounds loaded from files. Acquiring the same path twice returns
+// the same handle and bumps its reference count. Assets nobody references stay resident until the
+// budget is exceeded; then the least recently released ones are unloaded first. Entries are never
+// removed, so the reference GetTexture/GetSound returns stays valid for the cache's lifetime: it
+// reads as id 0 / frameCount 0 while the file is missing or the asset is evicted, and acquiring it
+// again loads it back.
+const size_t ASSET_CACHE_DEFAULT_BUDGET = 256u * 1024u * 1024u;
+
+struct TextureHandle
+{
+    int index;       // -1 for none
+};
+
+struct SoundHandle
+{
+    int index;
+};
+
+struct AssetCacheStats
+{
+    int entries;
+    int referenced;
+    int resident;
+    size_t residentBytes;
+    size_t budgetBytes;
+    int loads;
+    int hits;
+    int evictions;
+};
+
+struct AssetCache;
+
+AssetCache* CreateAssetCache(size_t budgetBytes = ASSET_CACHE_DEFAULT_BUDGET);
+
+// Unloads every resident asset, referenced or not
+void DestroyAssetCache(AssetCache* cache);
+
+TextureHandle AcquireTexture(AssetCache* cache, const std::string& path);
+SoundHandle AcquireSound(AssetCache* cache, const std::string& path);
+void ReleaseTexture(AssetCache* cache, TextureHandle handle);
+void ReleaseSound(AssetCache* cache, SoundHandle handle);
+
+Texture2D& GetTexture(AssetCache* cache, TextureHandle handle);
+Sound& GetSound(AssetCache* cache, SoundHandle handle);
+
+// Register every entry acquired so far with the reloader (call before StartHotReloader). onReload
+// gets the Texture2D or Sound that was replaced, on the main thread.
+void WatchAssetCache(AssetCache* cache, HotReloader* reloader, const std::function<void(const void*)>& onReload = nullptr);
+
+AssetCacheStats GetAssetCacheStats(const AssetCache* cache);
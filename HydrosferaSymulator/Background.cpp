@@ -0,0 +1,263 @@
+#include "Background.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static const char* BIOME_BLEND_FS =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform sampler2D biomeTo;\n"
+    "uniform vec2 biomeToOffset;\n"
+    "uniform float mixAmount;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    vec4 a = texture(texture0, fragTexCoord);\n"
+    "    vec4 b = texture(biomeTo, fragTexCoord + biomeToOffset);\n"
+    "    finalColor = mix(a, b, mixAmount)*fragColor;\n"
+    "}\n";
+
+static const char* const PARALLAX_LAYER_SUFFIXES[PARALLAX_MAX_LAYERS] = { "", "_far", "_near" };
+
+// Per-layer scroll speed relative to the camera
+static const float PARALLAX_SPEEDS[PARALLAX_MAX_LAYERS] = {
+    0.05f, // sky, the biome image
+    0.25f, // far hills
+    0.6f   // near foliage
+};
+
+BiomeBackground LoadBiomeBackground(void)
+{
+    BiomeBackground bg = { 0 };
+    bg.blendShader = LoadShaderFromMemory(nullptr, BIOME_BLEND_FS);
+    bg.hasBlendShader = (bg.blendShader.id != 0 && bg.blendShader.id != rlGetShaderIdDefault());
+    if (bg.hasBlendShader)
+    {
+        bg.locSecondTexture = GetShaderLocation(bg.blendShader, "biomeTo");
+        bg.locSecondOffset = GetShaderLocation(bg.blendShader, "biomeToOffset");
+        bg.locMixAmount = GetShaderLocation(bg.blendShader, "mixAmount");
+    }
+    else
+    {
+        TraceLog(LOG_WARNING, "BACKGROUND: blend shader unavailable, crossfades fall back to two alpha-blended passes");
+    }
+    return bg;
+}
+
+void UnloadBiomeBackground(BiomeBackground& bg)
+{
+    if (bg.hasBlendShader) UnloadShader(bg.blendShader);
+    bg.hasBlendShader = false;
+}
+
+void DrawBiomeBackground(const BiomeBackground& bg, const Texture2D& from, Rectangle fromSrc,
+                         const Texture2D* to, Rectangle toSrc, float t, Rectangle dst)
+{
+    bool fading = (to != nullptr && to->id != 0 && t > 0.0f);
+
+    if (fading && !bg.hasBlendShader)
+    {
+        DrawTexturePro(from, fromSrc, dst, { 0, 0 }, 0.0f, WHITE);
+        DrawTexturePro(*to, toSrc, dst, { 0, 0 }, 0.0f, Fade(WHITE, t));
+        return;
+    }
+
+    // The background covers the whole screen, so skip the blend unit: flush pending
+    // geometry, draw opaque, flush again before later layers re-enable blending
+    rlDrawRenderBatchActive();
+    rlDisableColorBlend();
+
+    if (fading && t < 1.0f)
+    {
+        Vector2 offset = { (toSrc.x - fromSrc.x) / (float)to->width, 0.0f };
+        BeginShaderMode(bg.blendShader);
+        SetShaderValueTexture(bg.blendShader, bg.locSecondTexture, *to);
+        SetShaderValue(bg.blendShader, bg.locSecondOffset, &offset, SHADER_UNIFORM_VEC2);
+        SetShaderValue(bg.blendShader, bg.locMixAmount, &t, SHADER_UNIFORM_FLOAT);
+        DrawTexturePro(from, fromSrc, dst, { 0, 0 }, 0.0f, WHITE);
+        EndShaderMode();
+    }
+    else if (fading)
+    {
+        DrawTexturePro(*to, toSrc, dst, { 0, 0 }, 0.0f, WHITE);
+    }
+    else
+    {
+        DrawTexturePro(from, fromSrc, dst, { 0, 0 }, 0.0f, WHITE);
+    }
+
+    rlDrawRenderBatchActive();
+    rlEnableColorBlend();
+}
+
+ParallaxBackground CreateParallaxBackground(AssetCache* assets, const string& pathPrefix, int chunkCount, int chunkWidth, int screenWidth, int screenHeight)
+{
+    ParallaxBackground px;
+    px.chunks.resize(chunkCount);
+    for (int i = 0; i < chunkCount; ++i)
+    {
+        ParallaxChunk& chunk = px.chunks[i];
+        chunk.baked = false;
+        for (int l = 0; l < PARALLAX_MAX_LAYERS; ++l)
+        {
+            chunk.layers[l] = { 0 };
+            chunk.images[l] = { -1 };
+            string path = pathPrefix + to_string(i + 1) + PARALLAX_LAYER_SUFFIXES[l] + ".png";
+            if (l > 0 && !FileExists(path.c_str())) continue;
+            chunk.paths[l] = path;
+            ReleaseTexture(assets, AcquireTexture(assets, path));
+        }
+    }
+    px.assets = assets;
+    px.chunkWidth = chunkWidth;
+    px.screenWidth = screenWidth;
+    px.screenHeight = screenHeight;
+    return px;
+}
+
+static void UnloadParallaxChunk(ParallaxBackground& px, ParallaxChunk& chunk)
+{
+    for (int l = 0; l < PARALLAX_MAX_LAYERS; ++l)
+    {
+        ParallaxLayer& layer = chunk.layers[l];
+        if (layer.present) UnloadRenderTexture(layer.target);
+        layer = { 0 };
+        if (chunk.images[l].index >= 0) ReleaseTexture(px.assets, chunk.images[l]);
+        chunk.images[l] = { -1 };
+    }
+    chunk.baked = false;
+}
+
+void UnloadParallaxBackground(ParallaxBackground& px)
+{
+    for (ParallaxChunk& chunk : px.chunks) UnloadParallaxChunk(px, chunk);
+}
+
+// Render 'tex' into a render texture wide enough for the layer to scroll 'margin' either way without
+// running out of image: zoomed to that width and anchored at the bottom so the ground lines up
+static bool BakeLayer(ParallaxLayer& layer, const Texture2D& tex, float margin, int screenWidth, int screenHeight)
+{
+    int width = screenWidth + 2 * (int)margin;
+    layer.target = LoadRenderTexture(width, screenHeight);
+    if (layer.target.id == 0) return false;
+
+    SetTextureWrap(layer.target.texture, TEXTURE_WRAP_CLAMP);
+    SetTextureFilter(layer.target.texture, TEXTURE_FILTER_BILINEAR);
+
+    BeginTextureMode(layer.target);
+    ClearBackground(BLANK);
+    float zoom = (float)width / (float)screenWidth;
+    Rectangle src = { 0.0f, 0.0f, (float)tex.width, (float)tex.height };
+    Rectangle dst = { 0.0f, screenHeight * (1.0f - zoom), (float)width, screenHeight * zoom };
+    DrawTexturePro(tex, src, dst, { 0, 0 }, 0.0f, WHITE);
+    EndTextureMode();
+
+    layer.margin = margin;
+    layer.bandY = 0.0f;
+    layer.bandH = (float)screenHeight;
+    layer.present = true;
+    return true;
+}
+
+// The images stay resident in the cache unless it ran over budget since they were last used, so
+// baking a chunk rarely touches the disk. Far and near layers only exist where there is art for
+// them, otherwise the chunk is its sky alone.
+static void BakeParallaxChunk(ParallaxBackground& px, int index)
+{
+    ParallaxChunk& chunk = px.chunks[index];
+    for (int l = 0; l < PARALLAX_MAX_LAYERS; ++l)
+    {
+        if (chunk.paths[l].empty()) continue;
+        chunk.images[l] = AcquireTexture(px.assets, chunk.paths[l]);
+        const Texture2D& tex = GetTexture(px.assets, chunk.images[l]);
+        if (tex.id == 0) continue;
+        BakeLayer(chunk.layers[l], tex, ceilf(0.5f * px.chunkWidth * PARALLAX_SPEEDS[l]), px.screenWidth, px.screenHeight);
+    }
+
+    chunk.baked = true;
+}
+
+void UpdateParallaxCache(ParallaxBackground& px, int centerChunk)
+{
+    for (int i = 0; i < (int)px.chunks.size(); ++i)
+    {
+        bool keep = abs(i - centerChunk) <= 1;
+        if (keep && !px.chunks[i].baked) BakeParallaxChunk(px, i);
+        else if (!keep && px.chunks[i].baked) UnloadParallaxChunk(px, px.chunks[i]);
+    }
+}
+
+void InvalidateParallaxTexture(ParallaxBackground& px, const void* texture)
+{
+    for (ParallaxChunk& chunk : px.chunks)
+    {
+        if (!chunk.baked) continue;
+        for (const TextureHandle& image : chunk.images)
+        {
+            if (image.index < 0 || &GetTexture(px.assets, image) != texture) continue;
+            UnloadParallaxChunk(px, chunk);
+            break;
+        }
+    }
+}
+
+// Source rect of a layer scrolled relative to the centre of its chunk (render textures are stored
+// flipped). The scroll stops at the baked margin, e.g. for the chunk fading out past its edge.
+static Rectangle LayerSource(const ParallaxBackground& px, const ParallaxLayer& layer, int chunk, int l, float cameraX)
+{
+    float chunkCenter = (chunk + 0.5f) * (float)px.chunkWidth;
+    float scroll = (cameraX - chunkCenter) * PARALLAX_SPEEDS[l];
+    scroll = fmaxf(-layer.margin, fminf(layer.margin, scroll));
+    return { layer.margin + scroll, 0.0f, (float)px.screenWidth, -layer.bandH };
+}
+
+bool GetParallaxSky(const ParallaxBackground& px, int chunk, float cameraX, Texture2D& texture, float& scrollU, float& scaleU)
+{
+    if (chunk < 0 || chunk >= (int)px.chunks.size()) return false;
+    const ParallaxLayer& sky = px.chunks[chunk].layers[0];
+    if (!px.chunks[chunk].baked || !sky.present) return false;
+    texture = sky.target.texture;
+    scrollU = LayerSource(px, sky, chunk, 0, cameraX).x / (float)texture.width;
+    scaleU = (float)px.screenWidth / (float)texture.width;
+    return true;
+}
+
+void DrawParallaxBackground(const BiomeBackground& bg, const ParallaxBackground& px, int from, int to, float t, float cameraX)
+{
+    if (from < 0 || from >= (int)px.chunks.size()) return;
+    const ParallaxChunk& a = px.chunks[from];
+    const ParallaxChunk* b = (to >= 0 && to < (int)px.chunks.size() && px.chunks[to].baked) ? &px.chunks[to] : nullptr;
+
+    // Sky: opaque, both chunks blended in one pass
+    const ParallaxLayer& skyA = a.layers[0];
+    const ParallaxLayer* skyB = (b != nullptr && b->layers[0].present) ? &b->layers[0] : nullptr;
+    Rectangle dst = { 0.0f, 0.0f, (float)px.screenWidth, (float)px.screenHeight };
+    if (skyA.present)
+    {
+        DrawBiomeBackground(bg, skyA.target.texture, LayerSource(px, skyA, from, 0, cameraX),
+                            skyB ? &skyB->target.texture : nullptr, skyB ? LayerSource(px, *skyB, to, 0, cameraX) : Rectangle{ 0 },
+                            t, dst);
+    }
+    else if (skyB != nullptr)
+    {
+        DrawBiomeBackground(bg, skyB->target.texture, LayerSource(px, *skyB, to, 0, cameraX), nullptr, Rectangle{ 0 }, 0.0f, dst);
+    }
+
+    // Overlays of one chunk at a time: the outgoing ones fade out over the first half of a
+    // crossfade and the incoming ones fade in over the second, never both stacked
+    const ParallaxChunk& shown = (b != nullptr && t >= 0.5f) ? *b : a;
+    int shownId = (b != nullptr && t >= 0.5f) ? to : from;
+    float alpha = (b == nullptr) ? 1.0f : fabsf(2.0f * t - 1.0f);
+    if (alpha <= 0.0f) return;
+    for (int l = 1; l < PARALLAX_MAX_LAYERS; ++l)
+    {
+        const ParallaxLayer& layer = shown.layers[l];
+        if (!layer.present) continue;
+        Rectangle band = { 0.0f, layer.bandY, (float)px.screenWidth, layer.bandH };
+        DrawTexturePro(layer.target.texture, LayerSource(px, layer, shownId, l, cameraX), band, { 0, 0 }, 0.0f, Fade(WHITE, alpha));
+    }
+}
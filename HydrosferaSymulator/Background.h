@@ -0,0 +1,78 @@
+#pragma once
+
+#include "raylib.h"
+#include "AssetCache.h"
+#include <string>
+#include <vector>
+
+// Screen-space biome background: opaque blit when static, single-pass shader blend while crossfading
+struct BiomeBackground
+{
+    Shader blendShader;
+    int locSecondTexture;
+    int locSecondOffset;
+    int locMixAmount;
+    bool hasBlendShader;
+};
+
+BiomeBackground LoadBiomeBackground(void);
+void UnloadBiomeBackground(BiomeBackground& bg);
+
+// Draw 'from' (and 'to' blended by t in [0,1] when non-null) over dst with color blending disabled.
+// The source rectangles may be scrolled past the texture edge, textures are expected to wrap.
+void DrawBiomeBackground(const BiomeBackground& bg, const Texture2D& from, Rectangle fromSrc,
+                         const Texture2D* to, Rectangle toSrc, float t, Rectangle dst);
+
+// Parallax: layer 0 is the biome image itself (sky, '<prefix>N.png'), drawn opaque. The far and
+// near layers only exist where there is art for them ('<prefix>N_far.png', '<prefix>N_near.png');
+// without it a chunk costs one full-screen pass. A chunk holds its images in the asset cache while
+// it is baked and releases them when it is dropped, so the cache may evict them under pressure.
+const int PARALLAX_MAX_LAYERS = 3;
+
+struct ParallaxLayer
+{
+    RenderTexture2D target; // layer baked wider than the screen by its scroll range
+    float margin;           // extra width on each side, the most the layer scrolls either way
+    float bandY;            // top of the band in screen space
+    float bandH;
+    bool present;
+};
+
+struct ParallaxChunk
+{
+    ParallaxLayer layers[PARALLAX_MAX_LAYERS];
+    std::string paths[PARALLAX_MAX_LAYERS];    // empty for a layer without art
+    TextureHandle images[PARALLAX_MAX_LAYERS]; // held while baked
+    bool baked;
+};
+
+struct ParallaxBackground
+{
+    std::vector<ParallaxChunk> chunks; // one per biome segment
+    AssetCache* assets;
+    int chunkWidth;
+    int screenWidth;
+    int screenHeight;
+};
+
+// Loads every image once so the cache knows them (call before WatchAssetCache), then lets them go
+// until a chunk is baked
+ParallaxBackground CreateParallaxBackground(AssetCache* assets, const std::string& pathPrefix, int chunkCount, int chunkWidth, int screenWidth, int screenHeight);
+
+// Releases the images of baked chunks (call before DestroyAssetCache)
+void UnloadParallaxBackground(ParallaxBackground& px);
+
+// Bake the chunks around 'centerChunk' (outside BeginDrawing) and drop the render textures of far ones
+void UpdateParallaxCache(ParallaxBackground& px, int centerChunk);
+
+// Re-bake the chunks built from 'texture', e.g. after it was reloaded
+void InvalidateParallaxTexture(ParallaxBackground& px, const void* texture);
+
+// Sky layer of a baked chunk as it is drawn for cameraX: its texture, the horizontal scroll and the
+// width of the screen, both in texture widths (v = 1 is the top of the screen). False when the
+// chunk has no sky baked.
+bool GetParallaxSky(const ParallaxBackground& px, int chunk, float cameraX, Texture2D& texture, float& scrollU, float& scaleU);
+
+// Draw every layer of the displayed chunk scrolled by its speed, crossfading the sky to 'to' by t when
+// to != -1; the overlays of the outgoing chunk fade out before those of the incoming one fade in
+void DrawParallaxBackground(const BiomeBackground& bg, const ParallaxBackground& px, int from, int to, float t, float cameraX);
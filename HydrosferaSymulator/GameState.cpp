@@ -0,0 +1,142 @@
+#include "GameState.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+
+using namespace std;
+
+static_assert(is_trivially_copyable<GameState>::value, "GameState is written as raw bytes");
+
+static void PutU16(unsigned char* p, unsigned v)
+{
+    p[0] = (unsigned char)(v & 0xFF);
+    p[1] = (unsigned char)((v >> 8) & 0xFF);
+}
+
+static void PutU32(unsigned char* p, uint32_t v)
+{
+    PutU16(p, v & 0xFFFF);
+    PutU16(p + 2, v >> 16);
+}
+
+static unsigned GetU16(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t GetU32(const unsigned char* p)
+{
+    return GetU16(p) | ((uint32_t)GetU16(p + 2) << 16);
+}
+
+static uint32_t Fnv1a(const unsigned char* data, size_t size)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; ++i)
+    {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+GameState MakeGameState()
+{
+    GameState state;
+    memset(&state, 0, sizeof(state));
+    state.frameDirection = 1.0f;
+    state.activeNPC = -1;
+    state.spinningCatScale = 1.5f;
+    state.displayedBiome = -1;
+    state.fadingFrom = -1;
+    state.fadingTo = -1;
+    return state;
+}
+
+void WriteGameStateSnapshot(const GameState& state, vector<unsigned char>& out)
+{
+    out.resize(GAME_STATE_HEADER_SIZE + sizeof(GameState));
+    unsigned char* p = out.data();
+    memcpy(p, "HSNP", 4);
+    PutU16(p + 4, GAME_STATE_VERSION);
+    PutU16(p + 6, 0);
+    PutU32(p + 8, (uint32_t)sizeof(GameState));
+    memcpy(p + GAME_STATE_HEADER_SIZE, &state, sizeof(GameState));
+    PutU32(p + 12, Fnv1a(p + GAME_STATE_HEADER_SIZE, sizeof(GameState)));
+}
+
+bool ReadGameStateSnapshot(GameState& state, const unsigned char* data, size_t size)
+{
+    if (size < GAME_STATE_HEADER_SIZE || memcmp(data, "HSNP", 4) != 0)
+    {
+        TraceLog(LOG_WARNING, "SNAPSHOT: not a game state snapshot");
+        return false;
+    }
+    if (GetU16(data + 4) != GAME_STATE_VERSION || GetU32(data + 8) != sizeof(GameState))
+    {
+        TraceLog(LOG_WARNING, "SNAPSHOT: version %u with %u bytes, this build reads version %d with %u bytes",
+                 GetU16(data + 4), GetU32(data + 8), GAME_STATE_VERSION, (unsigned)sizeof(GameState));
+        return false;
+    }
+    if (size != GAME_STATE_HEADER_SIZE + sizeof(GameState) || GetU32(data + 12) != Fnv1a(data + GAME_STATE_HEADER_SIZE, sizeof(GameState)))
+    {
+        TraceLog(LOG_WARNING, "SNAPSHOT: truncated or corrupted");
+        return false;
+    }
+
+    GameState loaded;
+    memcpy(&loaded, data + GAME_STATE_HEADER_SIZE, sizeof(GameState));
+    if (loaded.npcCount < 0 || loaded.npcCount > GAME_STATE_MAX_NPCS ||
+        loaded.activeCoinCount < 0 || loaded.activeCoinCount > GAME_STATE_MAX_COINS ||
+        loaded.wellCount < 0 || loaded.wellCount > GROUNDWATER_MAX_WELLS ||
+        loaded.damCount < 0 || loaded.damCount > WATER_MAX_DAMS)
+    {
+        TraceLog(LOG_WARNING, "SNAPSHOT: counts out of range");
+        return false;
+    }
+    memcpy(&state, &loaded, sizeof(GameState));
+    return true;
+}
+
+bool SaveGameState(const GameState& state, const string& path)
+{
+    vector<unsigned char> bytes;
+    WriteGameStateSnapshot(state, bytes);
+
+    string temp = path + ".tmp";
+    {
+        ofstream out(temp, ios::binary | ios::trunc);
+        out.write((const char*)bytes.data(), bytes.size());
+        if (!out)
+        {
+            TraceLog(LOG_WARNING, "SNAPSHOT: could not write '%s'", temp.c_str());
+            return false;
+        }
+    }
+
+    // rename() does not replace an existing file on Windows
+    remove(path.c_str());
+    if (rename(temp.c_str(), path.c_str()) != 0)
+    {
+        TraceLog(LOG_WARNING, "SNAPSHOT: could not move '%s' to '%s'", temp.c_str(), path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool LoadGameState(GameState& state, const string& path)
+{
+    // A crash between the remove and the rename in SaveGameState leaves only the temporary file
+    ifstream in(path, ios::binary);
+    if (!in) in.open(path + ".tmp", ios::binary);
+    if (!in)
+    {
+        TraceLog(LOG_WARNING, "SNAPSHOT: could not open '%s'", path.c_str());
+        return false;
+    }
+    vector<unsigned char> bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    return ReadGameStateSnapshot(state, bytes.data(), bytes.size());
+}
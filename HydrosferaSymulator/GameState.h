@@ -0,0 +1,85 @@
+#pragma once
+
+#include "raylib.h"
+#include "Water.h"
+#include "Groundwater.h"
+#include <string>
+#include <vector>
+
+// Everything a session needs to resume: player, coins, NPC progress, dialogue cursor, biome
+// crossfade, secret room and the lesson settings the player changed. Plain data only, so a
+// snapshot is the struct's bytes behind a small header:
+// "HSNP", u16 version, u16 reserved, u32 payload size, u32 FNV-1a of the payload.
+// The payload layout is this build's; bump the version whenever a field changes.
+const int GAME_STATE_VERSION = 1;
+const int GAME_STATE_HEADER_SIZE = 16;
+const int GAME_STATE_MAX_NPCS = 8;
+const int GAME_STATE_MAX_COINS = 16;
+
+struct Coin
+{
+    Vector2 position;
+    bool active;
+    float bobOffset;
+};
+
+struct NPCState
+{
+    bool paid;
+};
+
+struct GameState
+{
+    Rectangle player;
+    float frameDirection;
+    bool isJumping;
+    float jumpTimer;
+
+    int collectedCoins;
+    int activeCoinCount;
+    Coin activeCoins[GAME_STATE_MAX_COINS];
+    int npcCount;
+    NPCState npcStates[GAME_STATE_MAX_NPCS];
+
+    // Dialogue cursor; the text itself is rebuilt from the NPC lines on load
+    int activeNPC;
+    int currentDialogueLine;           // -1 thanks for the coins, -2 asks for them
+    int textDisplayLength;
+    int prevTextDisplayLength;
+    float charTimer;
+    float punctuationPauseRemaining;
+    bool mouthOpen;
+    float mouthTimer;
+
+    bool spinningCatVanished;
+    bool spinningCatVanishing;
+    float spinningCatVanishTimer;
+    float spinningCatScale;
+
+    int displayedBiome;
+    int fadingFrom;
+    int fadingTo;
+    float fadeTimer;
+
+    bool finishTriggered;
+
+    // Lesson settings; the simulations rebuild their fields from these
+    bool aralTimelapse;
+    float aralYear;
+    bool factoryOutfallActive;
+    bool treatmentPlantActive;
+    int wellCount;
+    float wellX[GROUNDWATER_MAX_WELLS];
+    int damCount;
+    float damX[WATER_MAX_DAMS];
+};
+
+// Zeroed state, padding included, so identical states give identical snapshots
+GameState MakeGameState();
+
+void WriteGameStateSnapshot(const GameState& state, std::vector<unsigned char>& out);
+bool ReadGameStateSnapshot(GameState& state, const unsigned char* data, size_t size);
+
+// Written to 'path.tmp' first and renamed over 'path', so a crash mid-write keeps the old file
+bool SaveGameState(const GameState& state, const std::string& path);
+bool LoadGameState(GameState& state, const std::string& path);
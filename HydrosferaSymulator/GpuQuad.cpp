@@ -0,0 +1,56 @@
+#include "GpuQuad.h"
+#include "rlgl.h"
+#include "raymath.h"
+
+// Top-left, bottom-left, bottom-right and top-left, bottom-right, top-right: the winding raylib
+// uses, so back-face culling keeps the quad
+static const float UNIT_QUAD[12] = {
+    0.0f, 0.0f,   0.0f, 1.0f,   1.0f, 1.0f,
+    0.0f, 0.0f,   1.0f, 1.0f,   1.0f, 0.0f
+};
+
+InstancedQuad LoadInstancedQuad(int capacity, int stride, const InstanceAttribute* attributes, int attributeCount)
+{
+    InstancedQuad quad;
+    quad.vao = rlLoadVertexArray();
+    rlEnableVertexArray(quad.vao);
+
+    quad.quadVbo = rlLoadVertexBuffer(UNIT_QUAD, sizeof(UNIT_QUAD), false);
+    rlSetVertexAttribute(0, 2, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(0);
+
+    quad.instanceVbo = rlLoadVertexBuffer(nullptr, capacity * stride, true);
+    for (int i = 0; i < attributeCount; ++i)
+    {
+        const InstanceAttribute& a = attributes[i];
+        rlSetVertexAttribute(a.index, a.size, a.type, a.normalized, stride, a.offset);
+        rlEnableVertexAttribute(a.index);
+        rlSetVertexAttributeDivisor(a.index, 1);
+    }
+
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+    return quad;
+}
+
+void UnloadInstancedQuad(InstancedQuad& quad)
+{
+    if (quad.vao != 0) rlUnloadVertexArray(quad.vao);
+    if (quad.quadVbo != 0) rlUnloadVertexBuffer(quad.quadVbo);
+    if (quad.instanceVbo != 0) rlUnloadVertexBuffer(quad.instanceVbo);
+    quad = { 0, 0, 0 };
+}
+
+void DrawInstancedQuad(const InstancedQuad& quad, int count)
+{
+    rlEnableVertexArray(quad.vao);
+    rlDrawVertexArrayInstanced(0, 6, count);
+    rlDisableVertexArray();
+}
+
+void BeginCustomDraw(const Shader& shader, int locMvp)
+{
+    rlDrawRenderBatchActive();
+    rlEnableShader(shader.id);
+    rlSetUniformMatrix(locMvp, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "raylib.h"
+
+// Shared plumbing of the renderers that draw with their own shader and vertex arrays instead of
+// raylib's batch: the unit quad the instanced ones expand per instance, and the state every custom
+// draw starts from.
+struct InstanceAttribute
+{
+    unsigned int index;   // shader location, 1 and up (0 is the quad corner)
+    int size;
+    int type;             // RL_FLOAT, RL_UNSIGNED_BYTE, ...
+    bool normalized;
+    int offset;           // bytes into the instance
+};
+
+struct InstancedQuad
+{
+    unsigned int vao;     // 0 when not loaded
+    unsigned int quadVbo;
+    unsigned int instanceVbo;
+};
+
+// Corners (0,0)..(1,1) at location 0, plus a dynamic buffer of 'capacity' instances of 'stride'
+// bytes read once per instance through 'attributes'
+InstancedQuad LoadInstancedQuad(int capacity, int stride, const InstanceAttribute* attributes, int attributeCount);
+void UnloadInstancedQuad(InstancedQuad& quad);
+
+// Draw 'count' instances from the start of the instance buffer with the shader already enabled
+void DrawInstancedQuad(const InstancedQuad& quad, int count);
+
+// Flush raylib's pending geometry, which a custom draw would otherwise end up underneath, and enable
+// 'shader' with the current modelview-projection at 'locMvp'
+void BeginCustomDraw(const Shader& shader, int locMvp);
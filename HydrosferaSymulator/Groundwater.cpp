@@ -0,0 +1,399 @@
+#include "Groundwater.h"
+#include "Water.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GROUNDWATER_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Rows per job; dot products are summed per block and reduced in block order, so the
+// result does not depend on the thread count
+static const int GROUNDWATER_BLOCK_ROWS = 4;
+static const int GROUNDWATER_PARALLEL_MIN_CELLS = 8192;
+
+static const float KX = GROUNDWATER_CONDUCTIVITY_X / (GROUNDWATER_CELL_WIDTH * GROUNDWATER_CELL_WIDTH);
+static const float KZ = GROUNDWATER_CONDUCTIVITY_Z / (GROUNDWATER_CELL_HEIGHT * GROUNDWATER_CELL_HEIGHT);
+
+Groundwater CreateGroundwater(float originX, float width, float initialHead, JobSystem* jobs)
+{
+    Groundwater gw;
+    gw.columns = max(1, (int)ceilf(width / GROUNDWATER_CELL_WIDTH));
+    gw.rows = GROUNDWATER_ROWS;
+    gw.originX = originX;
+
+    const int n = gw.columns * gw.rows;
+    gw.head.assign(n, initialHead);
+    gw.recharge.assign(gw.columns, 0.0f);
+    gw.rhs.assign(n, 0.0f);
+    gw.diag.assign(n, 0.0f);
+    gw.invDiag.assign(n, 0.0f);
+    gw.residual.assign(n, 0.0f);
+    gw.direction.assign(n, 0.0f);
+    gw.product.assign(n, 0.0f);
+    gw.precond.assign(n, 0.0f);
+    gw.topStage.assign(gw.columns, NAN);
+    gw.zeroRow.assign(gw.columns, 0.0f);
+    gw.partial.assign((gw.rows + GROUNDWATER_BLOCK_ROWS - 1) / GROUNDWATER_BLOCK_ROWS * 2, 0.0);
+
+    gw.jobs = jobs;
+    gw.accumulator = 0.0f;
+    gw.pumped = 0.0;
+    gw.leaked = 0.0;
+    gw.lastIterations = 0;
+    gw.lastResidual = 0.0f;
+    gw.lastSolveMs = 0.0f;
+    gw.lastFrameMs = 0.0f;
+    gw.stepMs = 0.0f;
+    gw.solving = false;
+    gw.solverRz = 0.0;
+    gw.solverInitialNorm = 0.0;
+    return gw;
+}
+
+int AddGroundwaterWell(Groundwater& gw, float x, float depth, float rate)
+{
+    if ((int)gw.wells.size() >= GROUNDWATER_MAX_WELLS) return -1;
+    int row = (int)(depth / GROUNDWATER_CELL_HEIGHT);
+    gw.wells.push_back({ x, max(0, min(row, gw.rows - 1)), rate, true });
+    return (int)gw.wells.size() - 1;
+}
+
+void RemoveGroundwaterWell(Groundwater& gw, int index)
+{
+    if (index < 0 || index >= (int)gw.wells.size()) return;
+    gw.wells.erase(gw.wells.begin() + index);
+}
+
+static inline int ColumnAt(const Groundwater& gw, float x)
+{
+    int c = (int)floorf((x - gw.originX) / GROUNDWATER_CELL_WIDTH);
+    return max(0, min(c, gw.columns - 1));
+}
+
+// product = A * v over rows [r0, r1): storage + leakage on the diagonal, 5-point stencil with
+// no-flow sides and bottom. Missing rows read a zero row and the end columns are done apart,
+// so the inner loop has no branches and vectorises.
+static void ApplyOperator(const Groundwater& gw, const float* v, float* out, int r0, int r1)
+{
+    const int nx = gw.columns;
+    const float* zero = gw.zeroRow.data();
+    for (int r = r0; r < r1; ++r)
+    {
+        const float* row = v + r * nx;
+        const float* up = (r > 0) ? row - nx : zero;
+        const float* down = (r + 1 < gw.rows) ? row + nx : zero;
+        const float* d = gw.diag.data() + r * nx;
+        float* o = out + r * nx;
+
+        if (nx == 1)
+        {
+            o[0] = d[0] * row[0] - KZ * (up[0] + down[0]);
+            continue;
+        }
+        o[0] = d[0] * row[0] - KX * row[1] - KZ * (up[0] + down[0]);
+        for (int c = 1; c < nx - 1; ++c)
+        {
+            o[c] = d[c] * row[c] - KX * (row[c - 1] + row[c + 1]) - KZ * (up[c] + down[c]);
+        }
+        o[nx - 1] = d[nx - 1] * row[nx - 1] - KX * row[nx - 2] - KZ * (up[nx - 1] + down[nx - 1]);
+    }
+}
+
+static inline float HorizontalSum(float a, float b, float c, float d)
+{
+    return (a + b) + (c + d);
+}
+
+// sum a[i] * b[i] with four lanes
+static float DotKernel(const float* a, const float* b, int n)
+{
+    int i = 0;
+    float sum;
+#ifdef GROUNDWATER_USE_SSE2
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = HorizontalSum(lanes[0], lanes[1], lanes[2], lanes[3]);
+#else
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    for (; i + 4 <= n; i += 4)
+    {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    sum = HorizontalSum(s0, s1, s2, s3);
+#endif
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+// x += alpha p, r -= alpha q, z = r / diag; returns r.z and r.r
+static void UpdateKernel(float* x, float* r, float* z, const float* p, const float* q, const float* invDiag,
+                         int n, float alpha, float& rz, float& rr)
+{
+    int i = 0;
+    float sumRz = 0.0f, sumRr = 0.0f;
+#ifdef GROUNDWATER_USE_SSE2
+    const __m128 vA = _mm_set1_ps(alpha);
+    __m128 accRz = _mm_setzero_ps();
+    __m128 accRr = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 vx = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(vA, _mm_loadu_ps(p + i)));
+        __m128 vr = _mm_sub_ps(_mm_loadu_ps(r + i), _mm_mul_ps(vA, _mm_loadu_ps(q + i)));
+        __m128 vz = _mm_mul_ps(vr, _mm_loadu_ps(invDiag + i));
+        _mm_storeu_ps(x + i, vx);
+        _mm_storeu_ps(r + i, vr);
+        _mm_storeu_ps(z + i, vz);
+        accRz = _mm_add_ps(accRz, _mm_mul_ps(vr, vz));
+        accRr = _mm_add_ps(accRr, _mm_mul_ps(vr, vr));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, accRz);
+    sumRz = HorizontalSum(lanes[0], lanes[1], lanes[2], lanes[3]);
+    _mm_storeu_ps(lanes, accRr);
+    sumRr = HorizontalSum(lanes[0], lanes[1], lanes[2], lanes[3]);
+#endif
+    for (; i < n; ++i)
+    {
+        x[i] += alpha * p[i];
+        r[i] -= alpha * q[i];
+        z[i] = r[i] * invDiag[i];
+        sumRz += r[i] * z[i];
+        sumRr += r[i] * r[i];
+    }
+    rz = sumRz;
+    rr = sumRr;
+}
+
+template <typename Fn>
+static void ForEachBlock(Groundwater& gw, Fn fn)
+{
+    const int blocks = (gw.rows + GROUNDWATER_BLOCK_ROWS - 1) / GROUNDWATER_BLOCK_ROWS;
+    JobSystem* jobs = (gw.columns * gw.rows >= GROUNDWATER_PARALLEL_MIN_CELLS) ? gw.jobs : nullptr;
+    ParallelFor(jobs, blocks, [&](int b) {
+        int r0 = b * GROUNDWATER_BLOCK_ROWS;
+        fn(b, r0, min(gw.rows, r0 + GROUNDWATER_BLOCK_ROWS));
+    });
+}
+
+static double SumPartials(const Groundwater& gw, int slot)
+{
+    const int blocks = (gw.rows + GROUNDWATER_BLOCK_ROWS - 1) / GROUNDWATER_BLOCK_ROWS;
+    double sum = 0.0;
+    for (int b = 0; b < blocks; ++b) sum += gw.partial[b * 2 + slot];
+    return sum;
+}
+
+// Assemble diagonal and right-hand side of (S/dt - div K grad) h' = S/dt h + sources
+static void Assemble(Groundwater& gw, const ShallowWater& water, float dt)
+{
+    const int nx = gw.columns;
+    const float storage = GROUNDWATER_STORAGE / dt;
+    const float leak = GROUNDWATER_LEAKANCE / GROUNDWATER_CELL_HEIGHT;
+
+    for (int r = 0; r < gw.rows; ++r)
+    {
+        for (int c = 0; c < nx; ++c)
+        {
+            int i = r * nx + c;
+            float d = storage;
+            if (c > 0) d += KX;
+            if (c + 1 < nx) d += KX;
+            if (r > 0) d += KZ;
+            if (r + 1 < gw.rows) d += KZ;
+            gw.diag[i] = d;
+            gw.rhs[i] = storage * gw.head[i];
+        }
+    }
+
+    // Top row: leaky river bed where the river is wet, springs where the water table rises above
+    // a dry bed, recharge everywhere else
+    for (int c = 0; c < nx; ++c)
+    {
+        float x0 = gw.originX + c * GROUNDWATER_CELL_WIDTH;
+        float x1 = x0 + GROUNDWATER_CELL_WIDTH - water.cellSize;
+        float depth = (float)(GetWaterVolume(water, x0, x1) / GROUNDWATER_CELL_WIDTH);
+        float bed = GetWaterCellBed(water, WaterCellAt(water, x0));
+
+        float stage = NAN;
+        if (depth > WATER_DRY_EPS) stage = bed + depth;
+        else if (gw.head[c] > bed) stage = bed;
+        gw.topStage[c] = stage;
+
+        if (!std::isnan(stage))
+        {
+            gw.diag[c] += leak;
+            gw.rhs[c] += leak * stage;
+        }
+        else
+        {
+            gw.rhs[c] += gw.recharge[c] / GROUNDWATER_CELL_HEIGHT;
+        }
+    }
+    for (int i = 0; i < nx * gw.rows; ++i) gw.invDiag[i] = 1.0f / gw.diag[i];
+
+    for (const GroundwaterWell& w : gw.wells)
+    {
+        if (!w.active) continue;
+        gw.rhs[w.row * nx + ColumnAt(gw, w.x)] -= w.rate / (GROUNDWATER_CELL_WIDTH * GROUNDWATER_CELL_HEIGHT);
+    }
+}
+
+// Jacobi-preconditioned conjugate gradient, warm-started from the current head.
+// BeginSolve sets up the residual; ContinueSolve runs a bounded number of iterations and can
+// be resumed next frame, the head array holding the current iterate in between.
+static bool BeginSolve(Groundwater& gw)
+{
+    const int nx = gw.columns;
+    float* x = gw.head.data();
+    float* r = gw.residual.data();
+    float* p = gw.direction.data();
+    float* q = gw.product.data();
+    float* z = gw.precond.data();
+    const float* b = gw.rhs.data();
+    const float* invDiag = gw.invDiag.data();
+
+    // r = b - A x, z = r / diag, p = z
+    ForEachBlock(gw, [&](int blk, int r0, int r1) {
+        ApplyOperator(gw, x, q, r0, r1);
+        for (int i = r0 * nx; i < r1 * nx; ++i)
+        {
+            r[i] = b[i] - q[i];
+            z[i] = r[i] * invDiag[i];
+            p[i] = z[i];
+        }
+        gw.partial[blk * 2] = DotKernel(r + r0 * nx, z + r0 * nx, (r1 - r0) * nx);
+        gw.partial[blk * 2 + 1] = DotKernel(r + r0 * nx, r + r0 * nx, (r1 - r0) * nx);
+    });
+    gw.solverRz = SumPartials(gw, 0);
+    gw.solverInitialNorm = sqrt(SumPartials(gw, 1));
+    gw.lastIterations = 0;
+    gw.lastResidual = 0.0f;
+    return gw.solverInitialNorm < 1e-12;
+}
+
+static bool ContinueSolve(Groundwater& gw, int maxIterations)
+{
+    const int nx = gw.columns;
+    float* x = gw.head.data();
+    float* r = gw.residual.data();
+    float* p = gw.direction.data();
+    float* q = gw.product.data();
+    float* z = gw.precond.data();
+    const float* invDiag = gw.invDiag.data();
+
+    for (int n = 0; n < maxIterations; ++n)
+    {
+        if (gw.lastIterations >= GROUNDWATER_MAX_ITERATIONS) return true;
+
+        ForEachBlock(gw, [&](int blk, int r0, int r1) {
+            ApplyOperator(gw, p, q, r0, r1);
+            gw.partial[blk * 2] = DotKernel(p + r0 * nx, q + r0 * nx, (r1 - r0) * nx);
+        });
+        double pq = SumPartials(gw, 0);
+        if (pq <= 0.0) return true;
+        const float alpha = (float)(gw.solverRz / pq);
+
+        ForEachBlock(gw, [&](int blk, int r0, int r1) {
+            int i0 = r0 * nx;
+            float rzNew, rr;
+            UpdateKernel(x + i0, r + i0, z + i0, p + i0, q + i0, invDiag + i0, (r1 - r0) * nx, alpha, rzNew, rr);
+            gw.partial[blk * 2] = rzNew;
+            gw.partial[blk * 2 + 1] = rr;
+        });
+        double rzNew = SumPartials(gw, 0);
+        double rNorm = sqrt(SumPartials(gw, 1));
+        gw.lastIterations++;
+        gw.lastResidual = (float)(rNorm / gw.solverInitialNorm);
+        if (rNorm <= GROUNDWATER_TOLERANCE * gw.solverInitialNorm) return true;
+
+        const float beta = (float)(rzNew / gw.solverRz);
+        gw.solverRz = rzNew;
+        ForEachBlock(gw, [&](int, int r0, int r1) {
+            for (int i = r0 * nx; i < r1 * nx; ++i) p[i] = z[i] + beta * p[i];
+        });
+    }
+    return false;
+}
+
+// Move the leakage through the river bed into / out of the shallow-water layer
+static void FinishStep(Groundwater& gw, ShallowWater& water, float dt)
+{
+    for (int c = 0; c < gw.columns; ++c)
+    {
+        float stage = gw.topStage[c];
+        if (std::isnan(stage)) continue;
+        float flux = GROUNDWATER_LEAKANCE * (stage - gw.head[c]);   // px/s, positive into the aquifer
+        float x0 = gw.originX + c * GROUNDWATER_CELL_WIDTH;
+        double moved = ExchangeShallowWater(water, x0, x0 + GROUNDWATER_CELL_WIDTH - water.cellSize, -flux * dt);
+        gw.leaked -= moved;
+    }
+    for (const GroundwaterWell& w : gw.wells)
+    {
+        if (w.active) gw.pumped += w.rate * dt;
+    }
+}
+
+void StepGroundwater(Groundwater& gw, ShallowWater& water, float dt)
+{
+    auto start = chrono::high_resolution_clock::now();
+
+    Assemble(gw, water, dt);
+    if (!BeginSolve(gw)) ContinueSolve(gw, GROUNDWATER_MAX_ITERATIONS);
+    FinishStep(gw, water, dt);
+    gw.solving = false;
+
+    gw.lastSolveMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+    gw.lastFrameMs = gw.lastSolveMs;
+}
+
+bool UpdateGroundwater(Groundwater& gw, ShallowWater& water, float dt)
+{
+    auto start = chrono::high_resolution_clock::now();
+
+    // A new step starts once the previous solve is done; time owed beyond that is dropped,
+    // the implicit step is stable at any length
+    gw.accumulator = min(gw.accumulator + dt, 2.0f * GROUNDWATER_TICK);
+    bool finished = false;
+    if (!gw.solving && gw.accumulator >= GROUNDWATER_TICK)
+    {
+        gw.accumulator -= GROUNDWATER_TICK;
+        gw.stepMs = 0.0f;
+        Assemble(gw, water, GROUNDWATER_TICK);
+        gw.solving = !BeginSolve(gw);
+        finished = !gw.solving;
+    }
+    if (gw.solving && ContinueSolve(gw, GROUNDWATER_ITERATIONS_PER_FRAME))
+    {
+        gw.solving = false;
+        finished = true;
+    }
+    if (finished) FinishStep(gw, water, GROUNDWATER_TICK);
+
+    gw.lastFrameMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+    gw.stepMs += gw.lastFrameMs;
+    if (finished) gw.lastSolveMs = gw.stepMs;
+    return finished;
+}
+
+float GetGroundwaterHead(const Groundwater& gw, int column, int row)
+{
+    column = max(0, min(column, gw.columns - 1));
+    row = max(0, min(row, gw.rows - 1));
+    return gw.head[row * gw.columns + column];
+}
+
+float GetGroundwaterTableAt(const Groundwater& gw, float x)
+{
+    return gw.head[ColumnAt(gw, x)];
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+struct JobSystem;
+struct ShallowWater;
+
+// Vertical slice of aquifer under the ground strip. Hydraulic head is in px above the channel
+// datum (same frame as the shallow-water surface); the aquifer spans GROUNDWATER_DEPTH px below it.
+const float GROUNDWATER_CELL_WIDTH = 8.0f;
+const float GROUNDWATER_CELL_HEIGHT = 8.0f;
+const int GROUNDWATER_ROWS = 32;
+const float GROUNDWATER_DEPTH = GROUNDWATER_ROWS * GROUNDWATER_CELL_HEIGHT;
+const float GROUNDWATER_TICK = 0.25f;              // implicit step, stable at any length
+const float GROUNDWATER_CONDUCTIVITY_X = 80.0f;    // px/s
+const float GROUNDWATER_CONDUCTIVITY_Z = 20.0f;    // px/s, layered sediments conduct less vertically
+const float GROUNDWATER_STORAGE = 0.01f;           // storativity
+const float GROUNDWATER_LEAKANCE = 0.005f;         // 1/s, river bed conductance
+const int GROUNDWATER_MAX_ITERATIONS = 200;
+const int GROUNDWATER_ITERATIONS_PER_FRAME = 16;   // a step's solve is spread over frames
+const float GROUNDWATER_TOLERANCE = 1e-4f;         // residual reduction per step
+const int GROUNDWATER_MAX_WELLS = 8;
+
+// Pumps rate px^2/s (volume per unit slice thickness) out of one cell
+struct GroundwaterWell
+{
+    float x;
+    int row;
+    float rate;
+    bool active;
+};
+
+struct Groundwater
+{
+    int columns;
+    int rows;
+    float originX;
+
+    // Row-major head field, row 0 at the top of the aquifer
+    std::vector<float> head;
+    std::vector<float> recharge;    // per column, px/s infiltrating from above where the river is dry
+
+    // Conjugate-gradient scratch, sized once
+    std::vector<float> rhs;
+    std::vector<float> diag;
+    std::vector<float> invDiag;
+    std::vector<float> residual;
+    std::vector<float> direction;
+    std::vector<float> product;
+    std::vector<float> precond;
+    std::vector<float> topStage;    // river stage over each column for the step being solved, or NaN
+    std::vector<float> zeroRow;     // stands in for the rows above the top and below the bottom
+    std::vector<double> partial;    // per-block dot product sums, reduced in order
+    bool solving;                   // a step is assembled and its solve still running
+    double solverRz;
+    double solverInitialNorm;
+
+    std::vector<GroundwaterWell> wells;
+    JobSystem* jobs;
+
+    float accumulator;
+    double pumped;                  // total volume taken by wells
+    double leaked;                  // net volume moved from the river into the aquifer
+    int lastIterations;
+    float lastResidual;
+    float lastSolveMs;              // wall time of the last completed step over all its frames
+    float lastFrameMs;
+    float stepMs;
+};
+
+Groundwater CreateGroundwater(float originX, float width, float initialHead, JobSystem* jobs = nullptr);
+
+int AddGroundwaterWell(Groundwater& gw, float x, float depth, float rate);
+void RemoveGroundwaterWell(Groundwater& gw, int index);
+
+// Accumulate frame time and advance the implicit step in progress by at most
+// GROUNDWATER_ITERATIONS_PER_FRAME solver iterations, exchanging leakage with the river when it
+// completes. Returns true on the frame a step completes.
+bool UpdateGroundwater(Groundwater& gw, ShallowWater& water, float dt);
+
+// One implicit step of length dt solved to completion
+void StepGroundwater(Groundwater& gw, ShallowWater& water, float dt);
+
+float GetGroundwaterHead(const Groundwater& gw, int column, int row);
+
+// Head of the top aquifer row under x, i.e. the water table when it sits below the datum
+float GetGroundwaterTableAt(const Groundwater& gw, float x);
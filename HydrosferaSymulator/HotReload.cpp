@@ -0,0 +1,288 @@
+#include "HotReload.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+struct WatchedAsset
+{
+    string path;
+    string directory;
+    string fileName;
+    Texture2D* texture;                // exactly one of texture and sound is set
+    Sound* sound;
+    function<void()> onReload;
+    long modTime;                      // last seen by the worker when polling
+};
+
+// Decoded on the worker, uploaded on the main thread
+struct DecodedAsset
+{
+    int index;
+    Image image;
+    Wave wave;
+};
+
+struct HotReloader
+{
+    vector<WatchedAsset> assets;       // fixed once the worker starts
+
+    thread worker;
+    mutex lock;
+    condition_variable wake;
+    atomic<bool> stopping;
+    atomic<bool> reloadAll;
+    vector<DecodedAsset> decoded;      // guarded by lock
+
+    int inotifyFd;                     // -1 when polling
+    vector<pair<int, string>> watchedDirectories;
+
+    int reloadCount;
+    float lastApplyMs;
+};
+
+HotReloader* CreateHotReloader()
+{
+    HotReloader* r = new HotReloader();
+    r->stopping = false;
+    r->reloadAll = false;
+    r->inotifyFd = -1;
+    r->reloadCount = 0;
+    r->lastApplyMs = 0.0f;
+    return r;
+}
+
+static void Watch(HotReloader* r, const string& path, Texture2D* texture, Sound* sound, const function<void()>& onReload)
+{
+    WatchedAsset a;
+    a.path = path;
+    size_t slash = path.find_last_of("/\\");
+    a.directory = (slash == string::npos) ? "." : path.substr(0, slash);
+    a.fileName = (slash == string::npos) ? path : path.substr(slash + 1);
+    a.texture = texture;
+    a.sound = sound;
+    a.onReload = onReload;
+    a.modTime = FileExists(path.c_str()) ? GetFileModTime(path.c_str()) : 0;
+    r->assets.push_back(a);
+}
+
+void WatchTexture(HotReloader* reloader, const string& path, Texture2D* texture, const function<void()>& onReload)
+{
+    Watch(reloader, path, texture, nullptr, onReload);
+}
+
+void WatchSound(HotReloader* reloader, const string& path, Sound* sound, const function<void()>& onReload)
+{
+    Watch(reloader, path, nullptr, sound, onReload);
+}
+
+// Worker side: read the file into memory; a failed decode keeps the old asset
+static void Decode(HotReloader* r, int index)
+{
+    const WatchedAsset& a = r->assets[index];
+    DecodedAsset d = { index, { 0 }, { 0 } };
+    if (a.texture != nullptr)
+    {
+        d.image = LoadImage(a.path.c_str());
+        if (d.image.data == nullptr) return;
+    }
+    else
+    {
+        d.wave = LoadWave(a.path.c_str());
+        if (d.wave.data == nullptr) return;
+    }
+
+    lock_guard<mutex> guard(r->lock);
+    // A newer decode of the same file replaces one still waiting
+    for (DecodedAsset& pending : r->decoded)
+    {
+        if (pending.index != index) continue;
+        if (pending.image.data != nullptr) UnloadImage(pending.image);
+        if (pending.wave.data != nullptr) UnloadWave(pending.wave);
+        pending = d;
+        return;
+    }
+    r->decoded.push_back(d);
+}
+
+#if defined(__linux__)
+// Block up to the poll interval for inotify events and collect the assets they touch
+static void WaitForInotify(HotReloader* r, vector<int>& changed)
+{
+    pollfd pfd = { r->inotifyFd, POLLIN, 0 };
+    if (poll(&pfd, 1, (int)(HOT_RELOAD_POLL_INTERVAL * 1000.0f)) <= 0) return;
+
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(r->inotifyFd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char* p = buffer; p < buffer + length; )
+        {
+            const inotify_event* e = (const inotify_event*)p;
+            p += sizeof(inotify_event) + e->len;
+            if (e->len == 0) continue;
+
+            string directory;
+            for (const auto& w : r->watchedDirectories) if (w.first == e->wd) directory = w.second;
+            for (int i = 0; i < (int)r->assets.size(); ++i)
+                if (r->assets[i].directory == directory && r->assets[i].fileName == e->name) changed.push_back(i);
+        }
+    }
+}
+#endif
+
+static void PollModTimes(HotReloader* r, vector<int>& changed)
+{
+    {
+        unique_lock<mutex> guard(r->lock);
+        r->wake.wait_for(guard, chrono::duration<float>(HOT_RELOAD_POLL_INTERVAL), [r] { return r->stopping.load() || r->reloadAll.load(); });
+    }
+    for (int i = 0; i < (int)r->assets.size(); ++i)
+    {
+        WatchedAsset& a = r->assets[i];
+        long modTime = FileExists(a.path.c_str()) ? GetFileModTime(a.path.c_str()) : 0;
+        if (modTime != a.modTime && modTime != 0) changed.push_back(i);
+        a.modTime = modTime;
+    }
+}
+
+static void WorkerLoop(HotReloader* r)
+{
+    vector<int> changed;
+    while (!r->stopping)
+    {
+        changed.clear();
+#if defined(__linux__)
+        if (r->inotifyFd >= 0) WaitForInotify(r, changed);
+        else PollModTimes(r, changed);
+#else
+        PollModTimes(r, changed);
+#endif
+        if (r->stopping) break;
+
+        if (r->reloadAll.exchange(false))
+            for (int i = 0; i < (int)r->assets.size(); ++i) changed.push_back(i);
+
+        sort(changed.begin(), changed.end());
+        changed.erase(unique(changed.begin(), changed.end()), changed.end());
+        for (int index : changed) Decode(r, index);
+    }
+}
+
+void StartHotReloader(HotReloader* reloader)
+{
+    if (reloader->worker.joinable()) return;
+
+#if defined(__linux__)
+    reloader->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (reloader->inotifyFd >= 0)
+    {
+        for (const WatchedAsset& a : reloader->assets)
+        {
+            bool known = false;
+            for (const auto& w : reloader->watchedDirectories) known = known || w.second == a.directory;
+            if (known) continue;
+            int wd = inotify_add_watch(reloader->inotifyFd, a.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (wd >= 0) reloader->watchedDirectories.push_back({ wd, a.directory });
+        }
+    }
+    if (reloader->inotifyFd < 0) TraceLog(LOG_WARNING, "HOTRELOAD: inotify unavailable, polling modification times");
+#endif
+
+    reloader->worker = thread(WorkerLoop, reloader);
+    TraceLog(LOG_INFO, "HOTRELOAD: watching %d assets (%s)", (int)reloader->assets.size(), reloader->inotifyFd >= 0 ? "inotify" : "polling");
+}
+
+void ReloadAllAssets(HotReloader* reloader)
+{
+    reloader->reloadAll = true;
+    reloader->wake.notify_one();
+}
+
+int ApplyHotReloads(HotReloader* reloader)
+{
+    vector<DecodedAsset> ready;
+    {
+        lock_guard<mutex> guard(reloader->lock);
+        if (reloader->decoded.empty()) return 0;
+        ready.swap(reloader->decoded);
+    }
+    auto start = chrono::high_resolution_clock::now();
+
+    int swapped = 0;
+    for (DecodedAsset& d : ready)
+    {
+        WatchedAsset& a = reloader->assets[d.index];
+        if (a.texture != nullptr)
+        {
+            Texture2D texture = LoadTextureFromImage(d.image);
+            UnloadImage(d.image);
+            if (texture.id == 0) continue;
+            if (a.texture->id != 0) UnloadTexture(*a.texture);
+            *a.texture = texture;
+        }
+        else
+        {
+            Sound sound = LoadSoundFromWave(d.wave);
+            UnloadWave(d.wave);
+            if (sound.frameCount == 0) continue;
+            if (a.sound->frameCount != 0)
+            {
+                StopSound(*a.sound);
+                UnloadSound(*a.sound);
+            }
+            *a.sound = sound;
+        }
+        TraceLog(LOG_INFO, "HOTRELOAD: '%s' reloaded", a.path.c_str());
+        if (a.onReload) a.onReload();
+        swapped++;
+    }
+
+    reloader->reloadCount += swapped;
+    reloader->lastApplyMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+    return swapped;
+}
+
+void DestroyHotReloader(HotReloader* reloader)
+{
+    if (reloader == nullptr) return;
+    reloader->stopping = true;
+    reloader->wake.notify_one();
+    if (reloader->worker.joinable()) reloader->worker.join();
+
+#if defined(__linux__)
+    if (reloader->inotifyFd >= 0) close(reloader->inotifyFd);
+#endif
+    for (DecodedAsset& d : reloader->decoded)
+    {
+        if (d.image.data != nullptr) UnloadImage(d.image);
+        if (d.wave.data != nullptr) UnloadWave(d.wave);
+    }
+    delete reloader;
+}
+
+bool IsHotReloaderUsingInotify(const HotReloader* reloader)
+{
+    return reloader->inotifyFd >= 0;
+}
+
+int GetHotReloadCount(const HotReloader* reloader)
+{
+    return reloader->reloadCount;
+}
+
+float GetHotReloadApplyMs(const HotReloader* reloader)
+{
+    return reloader->lastApplyMs;
+}
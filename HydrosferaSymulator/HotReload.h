@@ -0,0 +1,32 @@
+#pragma once
+
+#include "raylib.h"
+#include <functional>
+#include <string>
+
+// Watches asset files and reloads the ones that change. A background thread notices the change
+// (inotify on Linux, modification times polled elsewhere) and decodes the file; the GPU upload and
+// the swap happen in ApplyHotReloads between frames. The watched Texture2D/Sound is replaced in
+// place, so pointers to it (animation clips, NPC speech, static props) stay valid.
+const float HOT_RELOAD_POLL_INTERVAL = 0.25f;   // s between modification time checks
+
+struct HotReloader;
+
+HotReloader* CreateHotReloader();
+void DestroyHotReloader(HotReloader* reloader);
+
+// Register before StartHotReloader. onReload runs on the main thread after the new asset is in place.
+void WatchTexture(HotReloader* reloader, const std::string& path, Texture2D* texture, const std::function<void()>& onReload = nullptr);
+void WatchSound(HotReloader* reloader, const std::string& path, Sound* sound, const std::function<void()>& onReload = nullptr);
+
+void StartHotReloader(HotReloader* reloader);
+
+// Queue every watched file for reloading, whether or not it changed
+void ReloadAllAssets(HotReloader* reloader);
+
+// Swap in the assets decoded since the last call; returns how many were replaced
+int ApplyHotReloads(HotReloader* reloader);
+
+bool IsHotReloaderUsingInotify(const HotReloader* reloader);
+int GetHotReloadCount(const HotReloader* reloader);
+float GetHotReloadApplyMs(const HotReloader* reloader);
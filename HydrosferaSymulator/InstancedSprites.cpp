@@ -0,0 +1,136 @@
+#include "InstancedSprites.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+using namespace std;
+
+static const char* INSTANCED_VS =
+    "#version 330\n"
+    "layout(location = 0) in vec2 corner;\n"
+    "layout(location = 1) in vec3 instance;\n"
+    "uniform mat4 mvp;\n"
+    "uniform vec2 size;\n"
+    "uniform vec2 bob;\n"
+    "uniform float time;\n"
+    "out vec2 uv;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 centre = instance.xy + vec2(0.0, sin(time*bob.y + instance.z)*bob.x);\n"
+    "    uv = corner;\n"
+    "    gl_Position = mvp*vec4(centre + (corner - 0.5)*size, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* INSTANCED_FS =
+    "#version 330\n"
+    "in vec2 uv;\n"
+    "uniform sampler2D texture0;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    finalColor = texture(texture0, uv);\n"
+    "}\n";
+
+InstancedSprites CreateInstancedSprites(int capacity, Vector2 size, float bobAmplitude, float bobSpeed)
+{
+    InstancedSprites is;
+    is.capacity = max(1, capacity);
+    is.instances.reserve(is.capacity);
+    is.count = 0;
+    is.size = size;
+    is.bobAmplitude = bobAmplitude;
+    is.bobSpeed = bobSpeed;
+    is.quad = { 0, 0, 0 };
+    is.locMvp = is.locSize = is.locBob = is.locTime = is.locTexture = -1;
+    is.uploads = 0;
+    is.lastDrawMs = 0.0f;
+
+    is.shader = LoadShaderFromMemory(INSTANCED_VS, INSTANCED_FS);
+    is.instanced = (is.shader.id != 0 && is.shader.id != rlGetShaderIdDefault());
+    if (!is.instanced)
+    {
+        TraceLog(LOG_WARNING, "INSTANCING: shader unavailable, instances fall back to the immediate-mode batch");
+        return is;
+    }
+    is.locMvp = GetShaderLocation(is.shader, "mvp");
+    is.locSize = GetShaderLocation(is.shader, "size");
+    is.locBob = GetShaderLocation(is.shader, "bob");
+    is.locTime = GetShaderLocation(is.shader, "time");
+    is.locTexture = GetShaderLocation(is.shader, "texture0");
+
+    const InstanceAttribute attributes[] = { { 1, 3, RL_FLOAT, false, 0 } };
+    is.quad = LoadInstancedQuad(is.capacity, (int)sizeof(SpriteInstance), attributes, 1);
+    return is;
+}
+
+void UnloadInstancedSprites(InstancedSprites& is)
+{
+    UnloadInstancedQuad(is.quad);
+    if (is.instanced) UnloadShader(is.shader);
+    is.instanced = false;
+    is.instances.clear();
+    is.count = 0;
+}
+
+void SetSpriteInstances(InstancedSprites& is, const SpriteInstance* instances, int count)
+{
+    count = min(max(count, 0), is.capacity);
+    if (count == is.count && memcmp(is.instances.data(), instances, count * sizeof(SpriteInstance)) == 0) return;
+
+    is.instances.assign(instances, instances + count);
+    is.count = count;
+    if (is.quad.vao != 0 && count > 0)
+    {
+        rlUpdateVertexBuffer(is.quad.instanceVbo, is.instances.data(), count * (int)sizeof(SpriteInstance), 0);
+    }
+    is.uploads++;
+}
+
+void DrawInstancedSprites(InstancedSprites& is, Texture2D texture, float time)
+{
+    if (is.count == 0 || texture.id == 0) return;
+    auto start = chrono::high_resolution_clock::now();
+
+    if (is.quad.vao != 0)
+    {
+        float bob[2] = { is.bobAmplitude, is.bobSpeed };
+        int slot = 0;
+        BeginCustomDraw(is.shader, is.locMvp);
+        rlSetUniform(is.locSize, &is.size, RL_SHADER_UNIFORM_VEC2, 1);
+        rlSetUniform(is.locBob, bob, RL_SHADER_UNIFORM_VEC2, 1);
+        rlSetUniform(is.locTime, &time, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(is.locTexture, &slot, RL_SHADER_UNIFORM_INT, 1);
+        rlActiveTextureSlot(0);
+        rlEnableTexture(texture.id);
+
+        DrawInstancedQuad(is.quad, is.count);
+        rlDisableTexture();
+        rlDisableShader();
+    }
+    else
+    {
+        // Same quads through the batch, the bob worked out here instead
+        float hw = is.size.x * 0.5f;
+        float hh = is.size.y * 0.5f;
+        rlSetTexture(texture.id);
+        rlBegin(RL_QUADS);
+        rlColor4ub(255, 255, 255, 255);
+        for (int i = 0; i < is.count; ++i)
+        {
+            const SpriteInstance& s = is.instances[i];
+            float y = s.y + sinf(time * is.bobSpeed + s.phase) * is.bobAmplitude;
+            rlTexCoord2f(0.0f, 0.0f); rlVertex2f(s.x - hw, y - hh);
+            rlTexCoord2f(0.0f, 1.0f); rlVertex2f(s.x - hw, y + hh);
+            rlTexCoord2f(1.0f, 1.0f); rlVertex2f(s.x + hw, y + hh);
+            rlTexCoord2f(1.0f, 0.0f); rlVertex2f(s.x + hw, y - hh);
+        }
+        rlEnd();
+        rlSetTexture(0);
+        rlDrawRenderBatchActive();
+    }
+
+    is.lastDrawMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "raylib.h"
+#include "GpuQuad.h"
+#include <vector>
+
+// Many copies of one texture drawn with a single instanced draw call. Each instance only carries
+// its position and a phase; the vertex shader adds the bob (amplitude * sin(time * speed + phase)),
+// so an unchanged set costs no CPU work or upload per frame.
+struct SpriteInstance
+{
+    float x;       // world centre of the quad at rest
+    float y;
+    float phase;   // radians
+};
+
+struct InstancedSprites
+{
+    int capacity;
+    std::vector<SpriteInstance> instances;   // what the instance buffer holds
+    int count;
+    Vector2 size;
+    float bobAmplitude;                       // px
+    float bobSpeed;                           // rad/s
+
+    InstancedQuad quad;    // vao 0 when instancing is unavailable
+    Shader shader;
+    int locMvp;
+    int locSize;
+    int locBob;
+    int locTime;
+    int locTexture;
+    bool instanced;
+
+    int uploads;
+    float lastDrawMs;
+};
+
+// Needs a GL context (call after InitWindow)
+InstancedSprites CreateInstancedSprites(int capacity, Vector2 size, float bobAmplitude, float bobSpeed);
+void UnloadInstancedSprites(InstancedSprites& is);
+
+// Replace the instance set; the buffer is only uploaded when it differs from the last one
+void SetSpriteInstances(InstancedSprites& is, const SpriteInstance* instances, int count);
+
+// Draw inside BeginMode2D in one draw call; time drives the bob
+void DrawInstancedSprites(InstancedSprites& is, Texture2D texture, float time);
@@ -0,0 +1,175 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct JobTask
+{
+    const function<void(int)>* fn;
+    int index;
+    atomic<int>* pending;
+};
+
+struct JobQueue
+{
+    mutex lock;
+    deque<JobTask> tasks;
+};
+
+struct JobSystem
+{
+    vector<thread> workers;
+    vector<unique_ptr<JobQueue>> queues; // queue 0 belongs to the calling thread
+    mutex sleepLock;
+    condition_variable wake;
+    atomic<int> queued;
+    atomic<bool> quit;
+    atomic<bool> deterministic;
+};
+
+// Owner pops from the back (most recently pushed, still warm in cache)
+static bool PopLocal(JobQueue& q, JobTask& out)
+{
+    lock_guard<mutex> guard(q.lock);
+    if (q.tasks.empty()) return false;
+    out = q.tasks.back();
+    q.tasks.pop_back();
+    return true;
+}
+
+// Thieves take from the front, away from the owner
+static bool Steal(JobQueue& q, JobTask& out)
+{
+    lock_guard<mutex> guard(q.lock);
+    if (q.tasks.empty()) return false;
+    out = q.tasks.front();
+    q.tasks.pop_front();
+    return true;
+}
+
+static bool FindTask(JobSystem* jobs, int self, JobTask& out)
+{
+    if (PopLocal(*jobs->queues[self], out)) return true;
+    if (jobs->deterministic.load(memory_order_relaxed)) return false;
+
+    int n = (int)jobs->queues.size();
+    for (int k = 1; k < n; ++k)
+    {
+        if (Steal(*jobs->queues[(self + k) % n], out)) return true;
+    }
+    return false;
+}
+
+static void RunTask(JobSystem* jobs, const JobTask& task)
+{
+    jobs->queued.fetch_sub(1, memory_order_relaxed);
+    (*task.fn)(task.index);
+    task.pending->fetch_sub(1, memory_order_acq_rel);
+}
+
+static void WorkerLoop(JobSystem* jobs, int self)
+{
+    while (!jobs->quit.load(memory_order_acquire))
+    {
+        JobTask task;
+        if (FindTask(jobs, self, task))
+        {
+            RunTask(jobs, task);
+            continue;
+        }
+
+        unique_lock<mutex> guard(jobs->sleepLock);
+        jobs->wake.wait(guard, [&] {
+            if (jobs->quit.load(memory_order_acquire)) return true;
+            if (jobs->queued.load(memory_order_acquire) <= 0) return false;
+            if (!jobs->deterministic.load(memory_order_relaxed)) return true;
+            lock_guard<mutex> q(jobs->queues[self]->lock);
+            return !jobs->queues[self]->tasks.empty();
+        });
+    }
+}
+
+JobSystem* CreateJobSystem(int workerCount)
+{
+    if (workerCount < 0) workerCount = max(0, (int)thread::hardware_concurrency() - 1);
+
+    JobSystem* jobs = new JobSystem();
+    jobs->queued = 0;
+    jobs->quit = false;
+    jobs->deterministic = false;
+    for (int i = 0; i < workerCount + 1; ++i) jobs->queues.push_back(unique_ptr<JobQueue>(new JobQueue()));
+    for (int i = 0; i < workerCount; ++i) jobs->workers.push_back(thread(WorkerLoop, jobs, i + 1));
+    return jobs;
+}
+
+void DestroyJobSystem(JobSystem* jobs)
+{
+    if (jobs == nullptr) return;
+    {
+        lock_guard<mutex> guard(jobs->sleepLock);
+        jobs->quit = true;
+    }
+    jobs->wake.notify_all();
+    for (thread& t : jobs->workers) t.join();
+    delete jobs;
+}
+
+int GetJobWorkerCount(const JobSystem* jobs)
+{
+    return (jobs != nullptr) ? (int)jobs->workers.size() : 0;
+}
+
+void SetJobSystemDeterministic(JobSystem* jobs, bool deterministic)
+{
+    if (jobs != nullptr) jobs->deterministic = deterministic;
+}
+
+bool IsJobSystemDeterministic(const JobSystem* jobs)
+{
+    return jobs != nullptr && jobs->deterministic.load();
+}
+
+void ParallelFor(JobSystem* jobs, int count, const function<void(int)>& fn)
+{
+    if (count <= 0) return;
+    if (jobs == nullptr || jobs->workers.empty() || count == 1)
+    {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    atomic<int> pending(count);
+    int threads = (int)jobs->queues.size();
+
+    // Round-robin distribution; pushing in reverse lets each owner pop its lowest index first
+    for (int q = 0; q < threads; ++q)
+    {
+        JobQueue& queue = *jobs->queues[q];
+        lock_guard<mutex> guard(queue.lock);
+        int last = q + ((count - 1 - q) / threads) * threads;
+        for (int i = last; i >= q && i < count; i -= threads)
+        {
+            queue.tasks.push_back({ &fn, i, &pending });
+        }
+    }
+    {
+        lock_guard<mutex> guard(jobs->sleepLock);
+        jobs->queued.fetch_add(count, memory_order_release);
+    }
+    jobs->wake.notify_all();
+
+    // The caller works through its own share (and steals) until everything is done
+    while (pending.load(memory_order_acquire) > 0)
+    {
+        JobTask task;
+        if (FindTask(jobs, 0, task)) RunTask(jobs, task);
+        else this_thread::yield();
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <functional>
+
+// Small work-stealing thread pool. The calling thread takes part in every ParallelFor,
+// so a pool with zero workers simply runs the loop inline.
+struct JobSystem;
+
+// workerCount < 0 picks hardware_concurrency - 1
+JobSystem* CreateJobSystem(int workerCount = -1);
+void DestroyJobSystem(JobSystem* jobs);
+
+int GetJobWorkerCount(const JobSystem* jobs);
+
+// Deterministic mode hands index i to thread i % threads and disables stealing, so the same
+// index always runs on the same thread in the same order
+void SetJobSystemDeterministic(JobSystem* jobs, bool deterministic);
+bool IsJobSystemDeterministic(const JobSystem* jobs);
+
+// Run fn(i) for i in [0, count) across the pool and wait for all of them
+void ParallelFor(JobSystem* jobs, int count, const std::function<void(int)>& fn);
@@ -0,0 +1,303 @@
+#include "Particles.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+using namespace std;
+
+// Unit quad expanded per instance; round materials fade the corners out into a soft dot
+static const char* PARTICLE_VS =
+    "#version 330\n"
+    "layout(location = 0) in vec2 corner;\n"
+    "layout(location = 1) in vec4 instanceRect;\n"
+    "layout(location = 2) in vec4 instanceColor;\n"
+    "uniform mat4 mvp;\n"
+    "out vec2 fragCorner;\n"
+    "out vec4 fragColor;\n"
+    "void main()\n"
+    "{\n"
+    "    fragCorner = corner - 0.5;\n"
+    "    fragColor = instanceColor;\n"
+    "    gl_Position = mvp*vec4(instanceRect.xy + fragCorner*instanceRect.zw, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* PARTICLE_FS =
+    "#version 330\n"
+    "in vec2 fragCorner;\n"
+    "in vec4 fragColor;\n"
+    "uniform int roundShape;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    float a = 1.0;\n"
+    "    if (roundShape != 0) a = clamp(1.0 - length(fragCorner)*2.0, 0.0, 1.0)*2.0;\n"
+    "    finalColor = vec4(fragColor.rgb, fragColor.a*min(a, 1.0));\n"
+    "}\n";
+
+struct ParticleMaterialDef
+{
+    int capacity;
+    Color color;
+    float gravity;  // px/s^2
+    float drag;     // 1/s
+    float width;
+    float height;
+    bool round;
+};
+
+static const ParticleMaterialDef PARTICLE_MATERIALS[PARTICLE_MATERIAL_COUNT] = {
+    { 131072, { 170, 200, 235, 150 },   0.0f, 0.0f, 1.5f, 14.0f, false }, // rain streaks, already at terminal speed
+    {  16384, { 120, 170, 230, 220 }, 900.0f, 0.5f, 5.0f,  5.0f, true  }, // water droplets
+    {   8192, { 255, 215,  80, 255 }, 300.0f, 2.0f, 6.0f,  6.0f, true  }  // coin pickup sparks
+};
+
+static float RandomSigned(unsigned int& state)
+{
+    // xorshift32, cheap enough to call several times per spawned particle
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (float)(state & 0xFFFFFF) / (float)0x800000 - 1.0f;
+}
+
+static void SpawnParticles(ParticleSystem& ps, ParticleMaterial material, Vector2 position, Vector2 extent,
+                           int count, Vector2 velocity, Vector2 spread, float life)
+{
+    ParticlePool& pool = ps.pools[material];
+    count = min(count, pool.capacity - pool.count);
+    if (count <= 0 || life <= 0.0f) return;
+
+    for (int n = 0; n < count; ++n)
+    {
+        int i = pool.count++;
+        pool.x[i] = position.x + RandomSigned(ps.rng) * extent.x * 0.5f;
+        pool.y[i] = position.y + RandomSigned(ps.rng) * extent.y * 0.5f;
+        pool.vx[i] = velocity.x + RandomSigned(ps.rng) * spread.x;
+        pool.vy[i] = velocity.y + RandomSigned(ps.rng) * spread.y;
+        float l = life * (0.75f + 0.25f * RandomSigned(ps.rng));
+        pool.life[i] = l;
+        pool.invLife[i] = 1.0f / l;
+    }
+}
+
+ParticleSystem CreateParticleSystem(void)
+{
+    ParticleSystem ps;
+    ps.rng = 0x9E3779B9u;
+    ps.lastUpdateMs = 0.0f;
+    ps.lastDrawMs = 0.0f;
+    ps.locMvp = -1;
+    ps.locRound = -1;
+
+    ps.shader = LoadShaderFromMemory(PARTICLE_VS, PARTICLE_FS);
+    ps.instanced = (ps.shader.id != 0 && ps.shader.id != rlGetShaderIdDefault());
+    if (ps.instanced)
+    {
+        ps.locMvp = GetShaderLocation(ps.shader, "mvp");
+        ps.locRound = GetShaderLocation(ps.shader, "roundShape");
+    }
+    else
+    {
+        TraceLog(LOG_WARNING, "PARTICLES: shader unavailable, particles fall back to the immediate-mode batch");
+    }
+
+    int largest = 0;
+    for (int m = 0; m < PARTICLE_MATERIAL_COUNT; ++m)
+    {
+        ParticlePool& pool = ps.pools[m];
+        pool.capacity = PARTICLE_MATERIALS[m].capacity;
+        pool.count = 0;
+        pool.x.resize(pool.capacity);
+        pool.y.resize(pool.capacity);
+        pool.vx.resize(pool.capacity);
+        pool.vy.resize(pool.capacity);
+        pool.life.resize(pool.capacity);
+        pool.invLife.resize(pool.capacity);
+        pool.floorY = 1e30f;
+        pool.quad = { 0, 0, 0 };
+        largest = max(largest, pool.capacity);
+
+        if (!ps.instanced) continue;
+
+        const InstanceAttribute attributes[] = {
+            { 1, 4, RL_FLOAT, false, 0 },
+            { 2, 4, RL_UNSIGNED_BYTE, true, (int)offsetof(ParticleInstance, color) }
+        };
+        pool.quad = LoadInstancedQuad(pool.capacity, (int)sizeof(ParticleInstance), attributes, 2);
+    }
+    ps.staging.resize(largest);
+    return ps;
+}
+
+void UnloadParticleSystem(ParticleSystem& ps)
+{
+    for (ParticlePool& pool : ps.pools)
+    {
+        UnloadInstancedQuad(pool.quad);
+        pool.count = 0;
+    }
+    if (ps.instanced) UnloadShader(ps.shader);
+    ps.instanced = false;
+    ps.emitters.clear();
+}
+
+int AddParticleEmitter(ParticleSystem& ps, ParticleMaterial material, Vector2 position, Vector2 extent,
+                       Vector2 velocity, Vector2 spread, float life, float rate)
+{
+    ParticleEmitter e;
+    e.material = material;
+    e.position = position;
+    e.extent = extent;
+    e.velocity = velocity;
+    e.spread = spread;
+    e.life = life;
+    e.rate = rate;
+    e.accumulator = 0.0f;
+    e.active = true;
+    ps.emitters.push_back(e);
+    return (int)ps.emitters.size() - 1;
+}
+
+void EmitParticleBurst(ParticleSystem& ps, ParticleMaterial material, Vector2 position, int count,
+                       Vector2 velocity, Vector2 spread, float life)
+{
+    SpawnParticles(ps, material, position, { 0.0f, 0.0f }, count, velocity, spread, life);
+}
+
+void SetParticleFloor(ParticleSystem& ps, ParticleMaterial material, float floorY)
+{
+    ps.pools[material].floorY = floorY;
+}
+
+void UpdateParticles(ParticleSystem& ps, float dt)
+{
+    auto start = chrono::high_resolution_clock::now();
+
+    for (ParticleEmitter& e : ps.emitters)
+    {
+        if (!e.active || e.rate <= 0.0f) continue;
+        e.accumulator += e.rate * dt;
+        int n = (int)e.accumulator;
+        e.accumulator -= (float)n;
+        SpawnParticles(ps, e.material, e.position, e.extent, n, e.velocity, e.spread, e.life);
+    }
+
+    for (int m = 0; m < PARTICLE_MATERIAL_COUNT; ++m)
+    {
+        ParticlePool& pool = ps.pools[m];
+        const ParticleMaterialDef& def = PARTICLE_MATERIALS[m];
+        int count = pool.count;
+        if (count == 0) continue;
+
+        float* x = pool.x.data();
+        float* y = pool.y.data();
+        float* vx = pool.vx.data();
+        float* vy = pool.vy.data();
+        float* life = pool.life.data();
+        float* invLife = pool.invLife.data();
+
+        // Integrate: straight loops over each array so the compiler can vectorise them
+        const float dv = def.gravity * dt;
+        const float keep = 1.0f / (1.0f + def.drag * dt);
+        for (int i = 0; i < count; ++i)
+        {
+            float nvx = vx[i] * keep;
+            float nvy = (vy[i] + dv) * keep;
+            vx[i] = nvx;
+            vy[i] = nvy;
+            x[i] += nvx * dt;
+            y[i] += nvy * dt;
+            life[i] -= dt;
+        }
+
+        // Compact: move the last live particle into each dead slot
+        const float floorY = pool.floorY;
+        int i = 0;
+        while (i < count)
+        {
+            if (life[i] > 0.0f && y[i] < floorY)
+            {
+                ++i;
+                continue;
+            }
+            --count;
+            x[i] = x[count];
+            y[i] = y[count];
+            vx[i] = vx[count];
+            vy[i] = vy[count];
+            life[i] = life[count];
+            invLife[i] = invLife[count];
+        }
+        pool.count = count;
+    }
+
+    ps.lastUpdateMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+void DrawParticles(ParticleSystem& ps)
+{
+    auto start = chrono::high_resolution_clock::now();
+
+    for (int m = 0; m < PARTICLE_MATERIAL_COUNT; ++m)
+    {
+        const ParticlePool& pool = ps.pools[m];
+        const ParticleMaterialDef& def = PARTICLE_MATERIALS[m];
+        if (pool.count == 0) continue;
+
+        // Fade out over the last third of each particle's life
+        ParticleInstance* out = ps.staging.data();
+        const float alpha = (float)def.color.a;
+        for (int i = 0; i < pool.count; ++i)
+        {
+            ParticleInstance& p = out[i];
+            p.x = pool.x[i];
+            p.y = pool.y[i];
+            p.width = def.width;
+            p.height = def.height;
+            p.color[0] = def.color.r;
+            p.color[1] = def.color.g;
+            p.color[2] = def.color.b;
+            p.color[3] = (unsigned char)(alpha * min(1.0f, pool.life[i] * pool.invLife[i] * 3.0f));
+        }
+
+        if (ps.instanced)
+        {
+            rlUpdateVertexBuffer(pool.quad.instanceVbo, out, pool.count * (int)sizeof(ParticleInstance), 0);
+
+            int roundShape = def.round ? 1 : 0;
+            BeginCustomDraw(ps.shader, ps.locMvp);
+            rlSetUniform(ps.locRound, &roundShape, RL_SHADER_UNIFORM_INT, 1);
+            DrawInstancedQuad(pool.quad, pool.count);
+            rlDisableShader();
+        }
+        else
+        {
+            rlSetTexture(rlGetTextureIdDefault());
+            rlBegin(RL_QUADS);
+            for (int i = 0; i < pool.count; ++i)
+            {
+                const ParticleInstance& p = out[i];
+                float hw = p.width * 0.5f;
+                float hh = p.height * 0.5f;
+                rlColor4ub(p.color[0], p.color[1], p.color[2], p.color[3]);
+                rlVertex2f(p.x - hw, p.y - hh);
+                rlVertex2f(p.x - hw, p.y + hh);
+                rlVertex2f(p.x + hw, p.y + hh);
+                rlVertex2f(p.x + hw, p.y - hh);
+            }
+            rlEnd();
+            rlSetTexture(0);
+            rlDrawRenderBatchActive();
+        }
+    }
+
+    ps.lastDrawMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+int GetParticleCount(const ParticleSystem& ps)
+{
+    int total = 0;
+    for (const ParticlePool& pool : ps.pools) total += pool.count;
+    return total;
+}
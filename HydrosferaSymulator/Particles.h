@@ -0,0 +1,91 @@
+#pragma once
+
+#include "raylib.h"
+#include "GpuQuad.h"
+#include <vector>
+
+// One pool and one draw call per material
+enum ParticleMaterial
+{
+    PARTICLE_RAIN = 0,
+    PARTICLE_SPLASH,
+    PARTICLE_SPARK,
+    PARTICLE_MATERIAL_COUNT
+};
+
+// Struct-of-arrays pool allocated once at its fixed capacity; dead particles are swapped
+// with the last live one, so the live range is always [0, count)
+struct ParticlePool
+{
+    int capacity;
+    int count;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> vx;
+    std::vector<float> vy;
+    std::vector<float> life;     // seconds left
+    std::vector<float> invLife;  // 1 / starting life, for the fade
+    float floorY;                // particles below this line die (rain hitting the ground)
+
+    InstancedQuad quad;          // vao 0 when instancing is unavailable
+};
+
+// Per-instance vertex data uploaded for every live particle
+struct ParticleInstance
+{
+    float x;
+    float y;
+    float width;
+    float height;
+    unsigned char color[4];
+};
+
+// Spawns `rate` particles per second somewhere inside the box centred on position
+struct ParticleEmitter
+{
+    ParticleMaterial material;
+    Vector2 position;  // world position, move it every frame to attach the emitter to something
+    Vector2 extent;    // spawn box size
+    Vector2 velocity;
+    Vector2 spread;    // +- random velocity added per particle
+    float life;
+    float rate;
+    float accumulator;
+    bool active;
+};
+
+struct ParticleSystem
+{
+    ParticlePool pools[PARTICLE_MATERIAL_COUNT];
+    std::vector<ParticleEmitter> emitters;
+    std::vector<ParticleInstance> staging;  // upload buffer, sized for the largest pool
+
+    Shader shader;
+    int locMvp;
+    int locRound;
+    bool instanced;
+
+    unsigned int rng;
+    float lastUpdateMs;
+    float lastDrawMs;
+};
+
+// Needs a GL context (call after InitWindow)
+ParticleSystem CreateParticleSystem(void);
+void UnloadParticleSystem(ParticleSystem& ps);
+
+int AddParticleEmitter(ParticleSystem& ps, ParticleMaterial material, Vector2 position, Vector2 extent,
+                       Vector2 velocity, Vector2 spread, float life, float rate);
+
+// Spawn count particles at once (drops silently when the pool is full)
+void EmitParticleBurst(ParticleSystem& ps, ParticleMaterial material, Vector2 position, int count,
+                       Vector2 velocity, Vector2 spread, float life);
+
+void SetParticleFloor(ParticleSystem& ps, ParticleMaterial material, float floorY);
+
+void UpdateParticles(ParticleSystem& ps, float dt);
+
+// Draw inside BeginMode2D; each material is one instanced draw call
+void DrawParticles(ParticleSystem& ps);
+
+int GetParticleCount(const ParticleSystem& ps);
@@ -0,0 +1,79 @@
+#include "PlayerAnimation.h"
+#include <algorithm>
+
+using namespace std;
+
+static PlayerAnimState SelectPlayerState(const PlayerAnimInput& input)
+{
+    if (input.celebrating) return PLAYER_HAPPY;
+    if (input.jumping) return PLAYER_JUMP;
+    if (input.moving) return input.running ? PLAYER_RUN : PLAYER_WALK;
+    return PLAYER_IDLE;
+}
+
+static bool IsGaitState(PlayerAnimState state)
+{
+    return state == PLAYER_IDLE || state == PLAYER_WALK || state == PLAYER_RUN;
+}
+
+PlayerAnimMachine MakePlayerAnimMachine(int animator, float blendDuration)
+{
+    PlayerAnimMachine m;
+    m.state = PLAYER_IDLE;
+    m.previous = PLAYER_IDLE;
+    m.stateTime = 0.0f;
+    m.blendDuration = blendDuration;
+    m.animator = animator;
+    for (int i = 0; i < PLAYER_STATE_COUNT; ++i) m.stateClips[i] = 0;
+    m.blend = { 0, 0, 0.0f };
+    return m;
+}
+
+void UpdatePlayerAnimMachine(PlayerAnimMachine& machine, const PlayerAnimInput& input,
+                             vector<Animator>& animators, const vector<AnimationClip>& clips, float dt)
+{
+    Animator& a = animators[machine.animator];
+
+    machine.stateTime += dt;
+    if (machine.blend.weight > 0.0f)
+    {
+        machine.blend.weight = (machine.blendDuration > 0.0f) ? max(0.0f, machine.blend.weight - dt / machine.blendDuration) : 0.0f;
+    }
+
+    PlayerAnimState next = SelectPlayerState(input);
+    bool restartJump = (next == PLAYER_JUMP && input.jumpStarted);
+
+    if (next != machine.state || restartJump)
+    {
+        int nextClip = machine.stateClips[next];
+
+        // Remember the outgoing pose for the crossfade, unless the pose does not change (walk -> idle)
+        if (machine.blendDuration > 0.0f && a.clip != nextClip)
+        {
+            machine.blend = { a.clip, a.frame, 1.0f };
+        }
+
+        if (IsGaitState(machine.state) && IsGaitState(next))
+        {
+            // Keep the gait phase so walk <-> run does not snap back to the first frame
+            const AnimationClip& from = clips[a.clip];
+            const AnimationClip& to = clips[nextClip];
+            float phase = (from.frameCount > 0) ? (float)a.frame / (float)from.frameCount : 0.0f;
+            a.clip = nextClip;
+            a.frame = min(to.frameCount - 1, (int)(phase * (float)to.frameCount));
+            a.finished = false;
+        }
+        else
+        {
+            a.clip = nextClip;
+            RestartAnimator(a);
+        }
+
+        machine.previous = machine.state;
+        machine.state = next;
+        machine.stateTime = 0.0f;
+    }
+
+    // Idle holds the last gait pose instead of playing
+    a.playing = (machine.state != PLAYER_IDLE);
+}
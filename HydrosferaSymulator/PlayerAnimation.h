@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Animation.h"
+#include <vector>
+
+enum PlayerAnimState
+{
+    PLAYER_IDLE = 0,
+    PLAYER_WALK,
+    PLAYER_RUN,
+    PLAYER_JUMP,
+    PLAYER_HAPPY,
+    PLAYER_STATE_COUNT
+};
+
+// Gameplay facts the state machine derives its state from, gathered once per frame
+struct PlayerAnimInput
+{
+    bool moving;
+    bool running;
+    bool jumping;
+    bool jumpStarted; // a new jump began this frame, restarts the clip even when already jumping
+    bool celebrating;
+};
+
+// Previous pose kept for a short crossfade after each transition
+struct PlayerAnimBlend
+{
+    int clip;
+    int frame;
+    float weight; // 1 right after the transition, fades to 0 over blendDuration
+};
+
+struct PlayerAnimMachine
+{
+    PlayerAnimState state;
+    PlayerAnimState previous;
+    float stateTime;                     // seconds spent in the current state
+    float blendDuration;                 // crossfade length, 0 disables blending
+    int animator;                        // index into the shared animator table
+    int stateClips[PLAYER_STATE_COUNT];  // clip played by each state
+    PlayerAnimBlend blend;
+};
+
+PlayerAnimMachine MakePlayerAnimMachine(int animator, float blendDuration);
+
+// Pick the state for this frame and switch the player's animator clip on transitions.
+// Call before UpdateAnimators so the new clip starts advancing the same frame.
+void UpdatePlayerAnimMachine(PlayerAnimMachine& machine, const PlayerAnimInput& input,
+                             std::vector<Animator>& animators, const std::vector<AnimationClip>& clips, float dt);
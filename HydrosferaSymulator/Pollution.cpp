@@ -0,0 +1,223 @@
+#include "Pollution.h"
+#include "Water.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POLLUTION_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+static const int POLLUTION_PADDING = 4;
+
+PollutionField CreatePollutionField(float originX, float width, float channelDepth, JobSystem* jobs)
+{
+    PollutionField f;
+    f.columns = POLLUTION_COLUMNS;
+    f.rows = POLLUTION_ROWS;
+    f.stride = f.columns + 2 + POLLUTION_PADDING;
+    f.originX = originX;
+    f.cellSize = width / (float)f.columns;
+    f.rowSpacing = channelDepth / (float)f.rows;
+
+    size_t total = (size_t)(f.rows + 2) * f.stride;
+    f.conc.assign(total, 0.0f);
+    f.scratch.assign(total, 0.0f);
+    f.faceVelocity.assign((size_t)f.stride, 0.0f);
+
+    // Slower towards the bed
+    f.rowFactor.assign((size_t)f.rows + 2, 0.0f);
+    for (int y = 1; y <= f.rows; ++y) f.rowFactor[y] = 1.0f - 0.5f * (float)(y - 1) / (float)max(1, f.rows - 1);
+
+    f.jobs = jobs;
+    f.lastStepMs = 0.0f;
+    f.lastSubsteps = 0;
+    return f;
+}
+
+int AddPollutionSource(PollutionField& field, float x0, float x1, float rate, float decay)
+{
+    field.sources.push_back({ x0, x1, rate, decay, true });
+    return (int)field.sources.size() - 1;
+}
+
+static int PollutionColumnAt(const PollutionField& field, float x)
+{
+    int j = (int)floorf((x - field.originX) / field.cellSize) + 1;
+    return max(1, min(j, field.columns));
+}
+
+// Face velocities interpolated from the water faces, zero where the channel is dry
+static float SampleVelocities(PollutionField& field, const ShallowWater& water)
+{
+    float maxU = 0.0f;
+    field.faceVelocity[0] = 0.0f;
+    field.faceVelocity[field.columns] = 0.0f;
+    for (int j = 1; j < field.columns; ++j)
+    {
+        float x = field.originX + (float)j * field.cellSize;
+        // Water face k sits at originX + (k + 1) * cellSize
+        float fk = (x - water.originX) / water.cellSize - 1.0f;
+        int k = (int)floorf(fk);
+        float t = fk - (float)k;
+        float u = GetWaterFaceVelocity(water, k) * (1.0f - t) + GetWaterFaceVelocity(water, k + 1) * t;
+        if (GetWaterDepthAt(water, x) <= WATER_DRY_EPS) u = 0.0f;
+        field.faceVelocity[j] = u;
+        maxU = max(maxU, fabsf(u));
+    }
+    return maxU;
+}
+
+static void ApplySources(PollutionField& field, float dt)
+{
+    for (const PollutionSource& s : field.sources)
+    {
+        if (!s.active) continue;
+        int first = PollutionColumnAt(field, s.x0);
+        int last = PollutionColumnAt(field, s.x1);
+        float keep = (s.decay > 0.0f) ? expf(-s.decay * dt) : 1.0f;
+        for (int y = 1; y <= field.rows; ++y)
+        {
+            float* row = &field.conc[(size_t)y * field.stride];
+            // Outfalls discharge at the surface, the top quarter of the column
+            float add = (y <= max(1, field.rows / 4)) ? s.rate * dt : 0.0f;
+            for (int j = first; j <= last; ++j) row[j] = row[j] * keep + add;
+        }
+    }
+}
+
+// Zero-gradient ghosts make both diffusive and advective boundary fluxes vanish
+static void FillGhosts(PollutionField& field)
+{
+    const int s = field.stride;
+    float* c = field.conc.data();
+    for (int y = 1; y <= field.rows; ++y)
+    {
+        float* row = c + (size_t)y * s;
+        row[0] = row[1];
+        row[field.columns + 1] = row[field.columns];
+    }
+    copy(c + s, c + 2 * s, c);
+    copy(c + (size_t)field.rows * s, c + (size_t)(field.rows + 1) * s, c + (size_t)(field.rows + 1) * s);
+}
+
+// One explicit upwind-advection + diffusion update for columns [j0, j1) of every row
+static void StencilBlock(const PollutionField& field, float* out, int j0, int j1, float k, float dX, float dY)
+{
+    const int s = field.stride;
+    const float* c = field.conc.data();
+    const float* fu = field.faceVelocity.data();
+
+    for (int y = 1; y <= field.rows; ++y)
+    {
+        const float* up = c + (size_t)(y - 1) * s;
+        const float* row = c + (size_t)y * s;
+        const float* down = c + (size_t)(y + 1) * s;
+        float* dst = out + (size_t)y * s;
+        const float rf = field.rowFactor[y];
+
+        int j = j0;
+#ifdef POLLUTION_USE_SSE2
+        const __m128 vZero = _mm_setzero_ps();
+        const __m128 vRf = _mm_set1_ps(rf);
+        const __m128 vK = _mm_set1_ps(k);
+        const __m128 vDX = _mm_set1_ps(dX);
+        const __m128 vDY = _mm_set1_ps(dY);
+        const __m128 vTwo = _mm_set1_ps(2.0f);
+        for (; j + 4 <= j1; j += 4)
+        {
+            __m128 cl = _mm_loadu_ps(row + j - 1);
+            __m128 cc = _mm_loadu_ps(row + j);
+            __m128 cr = _mm_loadu_ps(row + j + 1);
+            __m128 ul = _mm_mul_ps(_mm_loadu_ps(fu + j - 1), vRf);
+            __m128 ur = _mm_mul_ps(_mm_loadu_ps(fu + j), vRf);
+
+            __m128 pl = _mm_cmpgt_ps(ul, vZero);
+            __m128 pr = _mm_cmpgt_ps(ur, vZero);
+            __m128 fl = _mm_mul_ps(ul, _mm_or_ps(_mm_and_ps(pl, cl), _mm_andnot_ps(pl, cc)));
+            __m128 fr = _mm_mul_ps(ur, _mm_or_ps(_mm_and_ps(pr, cc), _mm_andnot_ps(pr, cr)));
+
+            __m128 twoC = _mm_mul_ps(vTwo, cc);
+            __m128 lapX = _mm_sub_ps(_mm_add_ps(cl, cr), twoC);
+            __m128 lapY = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(up + j), _mm_loadu_ps(down + j)), twoC);
+
+            __m128 v = _mm_sub_ps(cc, _mm_mul_ps(vK, _mm_sub_ps(fr, fl)));
+            v = _mm_add_ps(v, _mm_mul_ps(vDX, lapX));
+            v = _mm_add_ps(v, _mm_mul_ps(vDY, lapY));
+            _mm_storeu_ps(dst + j, v);
+        }
+#endif
+        for (; j < j1; ++j)
+        {
+            float cl = row[j - 1], cc = row[j], cr = row[j + 1];
+            float ul = fu[j - 1] * rf;
+            float ur = fu[j] * rf;
+            float fl = ul * (ul > 0.0f ? cl : cc);
+            float fr = ur * (ur > 0.0f ? cc : cr);
+            float twoC = 2.0f * cc;
+            float v = cc - k * (fr - fl);
+            v = v + dX * ((cl + cr) - twoC);
+            v = v + dY * ((up[j] + down[j]) - twoC);
+            dst[j] = v;
+        }
+    }
+}
+
+void StepPollution(PollutionField& field, const ShallowWater& water, float dt)
+{
+    auto start = chrono::high_resolution_clock::now();
+
+    float maxU = SampleVelocities(field, water);
+    ApplySources(field, dt);
+
+    int substeps = max(1, (int)ceilf(maxU * dt / field.cellSize / POLLUTION_MAX_CFL));
+    float h = dt / (float)substeps;
+    float k = h / field.cellSize;
+    float dX = POLLUTION_DIFFUSIVITY * h / (field.cellSize * field.cellSize);
+    float dY = POLLUTION_DIFFUSIVITY * h / (field.rowSpacing * field.rowSpacing);
+
+    const int blocks = (field.columns + POLLUTION_BLOCK_COLUMNS - 1) / POLLUTION_BLOCK_COLUMNS;
+    for (int step = 0; step < substeps; ++step)
+    {
+        FillGhosts(field);
+        float* out = field.scratch.data();
+        // Each block walks all rows of a column range small enough to stay in cache
+        ParallelFor(field.jobs, blocks, [&](int b) {
+            int j0 = 1 + b * POLLUTION_BLOCK_COLUMNS;
+            int j1 = min(field.columns + 1, j0 + POLLUTION_BLOCK_COLUMNS);
+            StencilBlock(field, out, j0, j1, k, dX, dY);
+        });
+        field.conc.swap(field.scratch);
+    }
+
+    field.lastSubsteps = substeps;
+    field.lastStepMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+float GetPollutionAt(const PollutionField& field, float x0, float x1)
+{
+    int first = PollutionColumnAt(field, x0);
+    int last = PollutionColumnAt(field, x1);
+    double sum = 0.0;
+    for (int y = 1; y <= field.rows; ++y)
+    {
+        const float* row = &field.conc[(size_t)y * field.stride];
+        for (int j = first; j <= last; ++j) sum += row[j];
+    }
+    return (float)(sum / ((double)field.rows * (last - first + 1)));
+}
+
+double GetPollutionTotal(const PollutionField& field)
+{
+    double sum = 0.0;
+    for (int y = 1; y <= field.rows; ++y)
+    {
+        const float* row = &field.conc[(size_t)y * field.stride];
+        for (int j = 1; j <= field.columns; ++j) sum += row[j];
+    }
+    return sum;
+}
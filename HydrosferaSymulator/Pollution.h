@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+struct JobSystem;
+struct ShallowWater;
+
+// Pollutant concentration carried by the shallow-water layer. The field is 2D: columns along
+// the world, rows spread through the water column from the surface (row 0) to the bed.
+const int POLLUTION_COLUMNS = 4096;
+const int POLLUTION_ROWS = 16;
+const int POLLUTION_BLOCK_COLUMNS = 512;     // columns per cache block / job
+const float POLLUTION_DIFFUSIVITY = 20.0f;   // px^2/s
+const float POLLUTION_MAX_CFL = 0.5f;        // advection substeps keep |u| dt / dx under this
+
+// Emits concentration into the top rows (rate > 0) and/or removes a fraction per second (decay > 0)
+struct PollutionSource
+{
+    float x0;
+    float x1;
+    float rate;
+    float decay;
+    bool active;
+};
+
+struct PollutionField
+{
+    int columns;
+    int rows;
+    int stride;                 // floats per row, one ghost column each side plus SIMD padding
+    float originX;
+    float cellSize;
+    float rowSpacing;
+
+    std::vector<float> conc;    // (rows + 2) x stride, ghost rows top and bottom
+    std::vector<float> scratch;
+    std::vector<float> faceVelocity;  // faceVelocity[j] between columns j and j + 1 (ghost indexed), walls at 0 and columns
+    std::vector<float> rowFactor;     // flow speed relative to the surface for each row
+
+    std::vector<PollutionSource> sources;
+    JobSystem* jobs;
+    float lastStepMs;
+    int lastSubsteps;
+};
+
+PollutionField CreatePollutionField(float originX, float width, float channelDepth, JobSystem* jobs = nullptr);
+int AddPollutionSource(PollutionField& field, float x0, float x1, float rate, float decay);
+
+// Advect by the current water velocity and diffuse over dt (call once per water tick)
+void StepPollution(PollutionField& field, const ShallowWater& water, float dt);
+
+// Mean concentration over all rows of the columns covering [x0, x1]
+float GetPollutionAt(const PollutionField& field, float x0, float x1);
+double GetPollutionTotal(const PollutionField& field);
@@ -0,0 +1,215 @@
+#include "ResolutionScaler.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// Runs on raylib's default vertex shader. Four-tap sharpen of the bilinear upscale, clamped to the
+// range of the taps so edges get crisper without ringing; taps stay inside the rendered corner.
+static const char* SHARPEN_FS = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform vec2 texel;
+uniform vec2 uvMax;
+uniform float sharpness;
+out vec4 finalColor;
+
+vec3 Tap(vec2 uv)
+{
+    return texture(texture0, clamp(uv, texel * 0.5, uvMax - texel * 0.5)).rgb;
+}
+
+void main()
+{
+    vec3 c = Tap(fragTexCoord);
+    vec3 n = Tap(fragTexCoord + vec2(0.0, texel.y));
+    vec3 s = Tap(fragTexCoord - vec2(0.0, texel.y));
+    vec3 e = Tap(fragTexCoord + vec2(texel.x, 0.0));
+    vec3 w = Tap(fragTexCoord - vec2(texel.x, 0.0));
+    vec3 lo = min(c, min(min(n, s), min(e, w)));
+    vec3 hi = max(c, max(max(n, s), max(e, w)));
+    vec3 sharp = c + (4.0 * c - n - s - e - w) * 0.25 * sharpness;
+    finalColor = vec4(clamp(sharp, lo, hi), 1.0) * colDiffuse * fragColor;
+}
+)";
+
+static const float FRAME_SMOOTHING = 0.1f;   // weight of the newest frame
+static const float OVER_BUDGET = 1.05f;
+static const float UNDER_BUDGET = 1.01f;
+static const float MIN_RENDER_SHARE = 0.25f;  // of the frame, below it a lower resolution cannot help
+
+static void FitOutput(ResolutionScaler& rs, int displayWidth, int displayHeight)
+{
+    float scale = fminf((float)displayWidth / rs.virtualWidth, (float)displayHeight / rs.virtualHeight);
+    float w = floorf(rs.virtualWidth * scale);
+    float h = floorf(rs.virtualHeight * scale);
+    rs.output = { floorf((displayWidth - w) * 0.5f), floorf((displayHeight - h) * 0.5f), w, h };
+
+    // Mouse positions come back in virtual coordinates like everything else
+    SetMouseOffset(-(int)rs.output.x, -(int)rs.output.y);
+    SetMouseScale(rs.virtualWidth / rs.output.width, rs.virtualHeight / rs.output.height);
+}
+
+static void ApplyLevel(ResolutionScaler& rs)
+{
+    rs.width = max(1, (int)lroundf(rs.target.texture.width * RESOLUTION_LEVELS[rs.level]));
+    rs.height = max(1, (int)lroundf(rs.target.texture.height * RESOLUTION_LEVELS[rs.level]));
+}
+
+static void LoadTarget(ResolutionScaler& rs)
+{
+    rs.target = LoadRenderTexture(max(1, (int)rs.output.width), max(1, (int)rs.output.height));
+    SetTextureFilter(rs.target.texture, TEXTURE_FILTER_BILINEAR);
+    ApplyLevel(rs);
+    TraceLog(LOG_INFO, "SCALER: World target %dx%d, output at %.0f,%.0f", rs.target.texture.width, rs.target.texture.height, rs.output.x, rs.output.y);
+}
+
+ResolutionScaler CreateResolutionScaler(int virtualWidth, int virtualHeight, int displayWidth, int displayHeight)
+{
+    ResolutionScaler rs;
+    rs.virtualWidth = virtualWidth;
+    rs.virtualHeight = virtualHeight;
+    rs.level = 0;
+    rs.smoothedFrame = RESOLUTION_FRAME_BUDGET;
+    rs.smoothedUpdate = 0.0f;
+    rs.overTime = 0.0f;
+    rs.underTime = 0.0f;
+    for (int i = 0; i < RESOLUTION_LEVEL_COUNT; ++i) rs.backoff[i] = 0.0f;
+    rs.retryTimer = 0.0f;
+    rs.changes = 0;
+    FitOutput(rs, displayWidth, displayHeight);
+    LoadTarget(rs);
+
+    rs.locTexel = rs.locUvMax = rs.locSharpness = -1;
+    rs.sharpen = LoadShaderFromMemory(nullptr, SHARPEN_FS);
+    rs.hasShader = (rs.sharpen.id != 0 && rs.sharpen.id != rlGetShaderIdDefault());
+    if (!rs.hasShader)
+    {
+        TraceLog(LOG_WARNING, "SCALER: sharpen shader unavailable, the world is upscaled with plain bilinear filtering");
+        return rs;
+    }
+    rs.locTexel = GetShaderLocation(rs.sharpen, "texel");
+    rs.locUvMax = GetShaderLocation(rs.sharpen, "uvMax");
+    rs.locSharpness = GetShaderLocation(rs.sharpen, "sharpness");
+    return rs;
+}
+
+void UnloadResolutionScaler(ResolutionScaler& rs)
+{
+    if (rs.target.id != 0) UnloadRenderTexture(rs.target);
+    rs.target = {};
+    if (rs.hasShader) UnloadShader(rs.sharpen);
+    rs.hasShader = false;
+}
+
+void ResizeResolutionScaler(ResolutionScaler& rs, int displayWidth, int displayHeight)
+{
+    Rectangle previous = rs.output;
+    FitOutput(rs, displayWidth, displayHeight);
+    if (rs.output.width == previous.width && rs.output.height == previous.height) return;
+
+    UnloadRenderTexture(rs.target);
+    LoadTarget(rs);
+}
+
+bool UpdateResolutionScaler(ResolutionScaler& rs, float frameTime, float updateTime)
+{
+    // A single hitch (loading, window drag) should not count for seconds
+    frameTime = fminf(frameTime, 4.0f * RESOLUTION_FRAME_BUDGET);
+    updateTime = fminf(updateTime, frameTime);
+    rs.smoothedFrame += (frameTime - rs.smoothedFrame) * FRAME_SMOOTHING;
+    rs.smoothedUpdate += (updateTime - rs.smoothedUpdate) * FRAME_SMOOTHING;
+    rs.retryTimer = fmaxf(0.0f, rs.retryTimer - frameTime);
+
+    // The whole frame has to fit the budget, but when the update takes nearly all of it there is
+    // nothing to win by rendering fewer pixels
+    float renderShare = 1.0f - rs.smoothedUpdate / fmaxf(rs.smoothedFrame, 1e-6f);
+    if (rs.smoothedFrame > RESOLUTION_FRAME_BUDGET * OVER_BUDGET && renderShare < MIN_RENDER_SHARE)
+    {
+        rs.overTime = 0.0f;
+        rs.underTime = 0.0f;
+    }
+    else if (rs.smoothedFrame > RESOLUTION_FRAME_BUDGET * OVER_BUDGET)
+    {
+        rs.overTime += frameTime;
+        rs.underTime = 0.0f;
+    }
+    else if (rs.smoothedFrame <= RESOLUTION_FRAME_BUDGET * UNDER_BUDGET)
+    {
+        rs.underTime += frameTime;
+        rs.overTime = 0.0f;
+    }
+    else
+    {
+        rs.overTime = 0.0f;
+    }
+
+    int next = rs.level;
+    if (rs.overTime >= RESOLUTION_DROP_AFTER && rs.level + 1 < RESOLUTION_LEVEL_COUNT)
+    {
+        // This level cannot hold the budget: wait longer before trying it again each time
+        float& backoff = rs.backoff[rs.level];
+        backoff = fminf(RESOLUTION_BACKOFF_MAX, fmaxf(RESOLUTION_RAISE_AFTER, 2.0f * backoff));
+        rs.retryTimer = backoff;
+        next = rs.level + 1;
+    }
+    else if (rs.underTime >= RESOLUTION_RAISE_AFTER)
+    {
+        // Held the budget for a while, so this level is good again
+        rs.backoff[rs.level] = 0.0f;
+        if (rs.level > 0 && rs.retryTimer <= 0.0f) next = rs.level - 1;
+        rs.underTime = 0.0f;
+    }
+    if (next == rs.level) return false;
+
+    rs.level = next;
+    rs.overTime = 0.0f;
+    rs.underTime = 0.0f;
+    rs.changes++;
+    ApplyLevel(rs);
+    return true;
+}
+
+void BeginScaledWorld(const ResolutionScaler& rs)
+{
+    BeginTextureMode(rs.target);
+
+    // Draw into the corner the current level uses, in virtual coordinates
+    rlViewport(0, 0, rs.width, rs.height);
+    rlMatrixMode(RL_PROJECTION);
+    rlLoadIdentity();
+    rlOrtho(0.0, (double)rs.virtualWidth, (double)rs.virtualHeight, 0.0, 0.0, 1.0);
+    rlMatrixMode(RL_MODELVIEW);
+    rlLoadIdentity();
+}
+
+void EndScaledWorld(void)
+{
+    EndTextureMode();
+}
+
+void DrawScaledWorld(const ResolutionScaler& rs)
+{
+    // The viewport corner sits at the bottom of the texture, so flip it on the way out
+    Rectangle src = { 0.0f, 0.0f, (float)rs.width, -(float)rs.height };
+    if (!rs.hasShader)
+    {
+        DrawTexturePro(rs.target.texture, src, rs.output, { 0.0f, 0.0f }, 0.0f, WHITE);
+        return;
+    }
+
+    float texel[2] = { 1.0f / rs.target.texture.width, 1.0f / rs.target.texture.height };
+    float uvMax[2] = { (float)rs.width / rs.target.texture.width, (float)rs.height / rs.target.texture.height };
+    float lowest = RESOLUTION_LEVELS[RESOLUTION_LEVEL_COUNT - 1];
+    float sharpness = RESOLUTION_SHARPNESS * (1.0f - RESOLUTION_LEVELS[rs.level]) / (1.0f - lowest);
+    SetShaderValue(rs.sharpen, rs.locTexel, texel, SHADER_UNIFORM_VEC2);
+    SetShaderValue(rs.sharpen, rs.locUvMax, uvMax, SHADER_UNIFORM_VEC2);
+    SetShaderValue(rs.sharpen, rs.locSharpness, &sharpness, SHADER_UNIFORM_FLOAT);
+
+    BeginShaderMode(rs.sharpen);
+    DrawTexturePro(rs.target.texture, src, rs.output, { 0.0f, 0.0f }, 0.0f, WHITE);
+    EndShaderMode();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "raylib.h"
+
+// The world is drawn in virtual coordinates into an offscreen target and upscaled, with a light
+// sharpening filter, into the largest rectangle of the virtual aspect ratio that fits the display.
+// The share of the native resolution the world is rendered at steps down when frames run over
+// budget and back up when they have had headroom for a while; a level that failed is retried
+// after a back-off that doubles every time it fails again.
+const int RESOLUTION_LEVEL_COUNT = 5;
+const float RESOLUTION_LEVELS[RESOLUTION_LEVEL_COUNT] = { 1.0f, 0.875f, 0.75f, 0.625f, 0.5f };
+const float RESOLUTION_FRAME_BUDGET = 1.0f / 60.0f;
+const float RESOLUTION_DROP_AFTER = 0.5f;     // s over budget before stepping down
+const float RESOLUTION_RAISE_AFTER = 3.0f;    // s within budget before stepping up
+const float RESOLUTION_BACKOFF_MAX = 60.0f;   // s
+const float RESOLUTION_SHARPNESS = 0.6f;      // at the lowest level, none at native resolution
+
+struct ResolutionScaler
+{
+    int virtualWidth;
+    int virtualHeight;
+    RenderTexture2D target;   // sized for level 0, lower levels use its top-left corner
+    Rectangle output;         // letterboxed area of the display
+    int level;
+    int width;                // world resolution at the current level
+    int height;
+
+    float smoothedFrame;      // s, exponential average of the frame time
+    float smoothedUpdate;     // s, same for the part of it the main thread spent updating
+    float overTime;
+    float underTime;
+    float backoff[RESOLUTION_LEVEL_COUNT];   // s before stepping up to this level again
+    float retryTimer;
+    int changes;
+
+    Shader sharpen;
+    int locTexel;
+    int locUvMax;
+    int locSharpness;
+    bool hasShader;
+};
+
+// Needs a GL context (call after InitWindow). Also maps the mouse onto virtual coordinates.
+ResolutionScaler CreateResolutionScaler(int virtualWidth, int virtualHeight, int displayWidth, int displayHeight);
+void UnloadResolutionScaler(ResolutionScaler& rs);
+
+// Reallocate the target for a new display size (window resized or moved to another monitor)
+void ResizeResolutionScaler(ResolutionScaler& rs, int displayWidth, int displayHeight);
+
+// Feed the measured frame time once per frame, with the part of it the main thread spent updating
+// the game: a frame over budget only steps the resolution down when the rest of it is a real share.
+// Returns true when the level changed.
+bool UpdateResolutionScaler(ResolutionScaler& rs, float frameTime, float updateTime);
+
+// Everything between these draws into the target in virtual coordinates; nothing in between may
+// switch to another render texture
+void BeginScaledWorld(const ResolutionScaler& rs);
+void EndScaledWorld(void);
+
+// Upscale the world onto the display (inside BeginDrawing)
+void DrawScaledWorld(const ResolutionScaler& rs);
@@ -0,0 +1,170 @@
+#include "Rewind.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+static const int LITERAL_BREAK_ZEROS = 3;     // a zero run this long ends a literal run
+
+static void PutVarint(vector<unsigned char>& out, size_t v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back((unsigned char)((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back((unsigned char)v);
+}
+
+static size_t GetVarint(const unsigned char*& p, const unsigned char* end)
+{
+    size_t v = 0;
+    for (int shift = 0; p < end; shift += 7)
+    {
+        unsigned char b = *p++;
+        v |= (size_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) break;
+    }
+    return v;
+}
+
+// XOR of 'state' against 'key', run-length coded
+static void EncodeDelta(const unsigned char* key, const unsigned char* state, size_t size, vector<unsigned char>& out)
+{
+    out.clear();
+    size_t i = 0;
+    while (i < size)
+    {
+        size_t zeroStart = i;
+        while (i < size && key[i] == state[i]) ++i;
+        if (i == size) break;
+        size_t literalStart = i;
+        size_t zeros = 0;
+        while (i < size && zeros < LITERAL_BREAK_ZEROS)
+        {
+            zeros = (key[i] == state[i]) ? zeros + 1 : 0;
+            ++i;
+        }
+        size_t literalEnd = i - zeros;
+        i = literalEnd;
+
+        PutVarint(out, literalStart - zeroStart);
+        PutVarint(out, literalEnd - literalStart);
+        for (size_t k = literalStart; k < literalEnd; ++k) out.push_back(key[k] ^ state[k]);
+    }
+}
+
+// XOR the coded delta into 'state', which holds a copy of the keyframe
+static void ApplyDelta(const vector<unsigned char>& delta, unsigned char* state, size_t size)
+{
+    const unsigned char* p = delta.data();
+    const unsigned char* end = p + delta.size();
+    size_t i = 0;
+    while (p < end)
+    {
+        i += GetVarint(p, end);
+        size_t count = GetVarint(p, end);
+        count = min(count, min((size_t)(end - p), size - min(i, size)));
+        for (size_t k = 0; k < count; ++k) state[i + k] ^= p[k];
+        p += count;
+        i += count;
+    }
+}
+
+RewindBuffer CreateRewindBuffer(int capacity, int keyInterval)
+{
+    RewindBuffer rb;
+    rb.keyInterval = max(1, keyInterval);
+    rb.capacity = max(capacity, rb.keyInterval + 1);
+    rb.frames.resize(rb.capacity);
+    for (RewindFrame& f : rb.frames) f.keyFrame = -1;
+    rb.scratch.resize(sizeof(GameState));
+    rb.oldest = rb.newest = rb.lastKeyFrame = -1;
+    rb.storedBytes = 0;
+    rb.lastRecordMs = 0.0f;
+    rb.lastRestoreMs = 0.0f;
+    return rb;
+}
+
+static RewindFrame& FrameSlot(RewindBuffer& rb, long long frame)
+{
+    return rb.frames[(size_t)(frame % rb.capacity)];
+}
+
+void RecordRewindFrame(RewindBuffer& rb, const GameState& state)
+{
+    auto start = chrono::high_resolution_clock::now();
+
+    long long frame = rb.newest + 1;
+    bool keyframe = (rb.lastKeyFrame < 0 || frame - rb.lastKeyFrame >= rb.keyInterval);
+
+    // The slot being reused held frame - capacity; frames coded against a dropped keyframe go with it
+    if (rb.oldest >= 0 && frame - rb.capacity >= rb.oldest)
+    {
+        rb.oldest = frame - rb.capacity + 1;
+        while (rb.oldest < frame && FrameSlot(rb, rb.oldest).keyFrame != rb.oldest) rb.oldest++;
+    }
+
+    RewindFrame& slot = FrameSlot(rb, frame);
+    rb.storedBytes -= slot.data.size();
+    const unsigned char* bytes = (const unsigned char*)&state;
+    if (keyframe)
+    {
+        slot.data.assign(bytes, bytes + sizeof(GameState));
+        slot.keyFrame = frame;
+        rb.lastKeyFrame = frame;
+    }
+    else
+    {
+        EncodeDelta(FrameSlot(rb, rb.lastKeyFrame).data.data(), bytes, sizeof(GameState), slot.data);
+        slot.keyFrame = rb.lastKeyFrame;
+    }
+    rb.storedBytes += slot.data.size();
+
+    rb.newest = frame;
+    if (rb.oldest < 0 || rb.oldest > frame) rb.oldest = frame;
+
+    rb.lastRecordMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+bool RestoreRewindFrame(RewindBuffer& rb, long long frame, GameState& state)
+{
+    if (rb.newest < 0) return false;
+    auto start = chrono::high_resolution_clock::now();
+
+    frame = max(rb.oldest, min(frame, rb.newest));
+    const RewindFrame& slot = FrameSlot(rb, frame);
+    const RewindFrame& key = FrameSlot(rb, slot.keyFrame);
+    memcpy(rb.scratch.data(), key.data.data(), sizeof(GameState));
+    if (slot.keyFrame != frame) ApplyDelta(slot.data, rb.scratch.data(), sizeof(GameState));
+    memcpy(&state, rb.scratch.data(), sizeof(GameState));
+
+    rb.lastRestoreMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+    return true;
+}
+
+void TruncateRewindBuffer(RewindBuffer& rb, long long frame)
+{
+    if (rb.newest < 0) return;
+    frame = max(rb.oldest, min(frame, rb.newest));
+    rb.newest = frame;
+    rb.lastKeyFrame = FrameSlot(rb, frame).keyFrame;
+}
+
+void ClearRewindBuffer(RewindBuffer& rb)
+{
+    for (RewindFrame& f : rb.frames)
+    {
+        f.keyFrame = -1;
+        f.data.clear();
+    }
+    rb.oldest = rb.newest = rb.lastKeyFrame = -1;
+    rb.storedBytes = 0;
+}
+
+float GetRewindSeconds(const RewindBuffer& rb)
+{
+    if (rb.newest < 0) return 0.0f;
+    return (float)(rb.newest - rb.oldest + 1) / 60.0f;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "GameState.h"
+#include <vector>
+
+// Ring of recorded GameStates for rewinding. Every REWIND_KEYFRAME_INTERVAL-th frame is stored
+// whole; the frames between hold the XOR against their keyframe, run-length coded as
+// (zero run, literal count, literal bytes) varint groups. Most fields do not change from frame to
+// frame, so a delta is a few dozen bytes and restoring one is a copy plus a single decode pass.
+const int REWIND_FRAMES = 30 * 60;            // 30 s at the target frame rate
+const int REWIND_KEYFRAME_INTERVAL = 60;
+const int REWIND_SPEED = 2;                   // recorded frames stepped back per frame while rewinding
+
+struct RewindFrame
+{
+    long long keyFrame;                       // frame number of the keyframe this frame decodes against
+    std::vector<unsigned char> data;          // whole state for a keyframe, coded XOR otherwise
+};
+
+struct RewindBuffer
+{
+    int capacity;
+    int keyInterval;
+    std::vector<RewindFrame> frames;          // slot = frame number % capacity
+    long long oldest;                         // oldest frame that can still be restored, -1 when empty
+    long long newest;
+    long long lastKeyFrame;
+    std::vector<unsigned char> scratch;
+    size_t storedBytes;
+
+    float lastRecordMs;
+    float lastRestoreMs;
+};
+
+RewindBuffer CreateRewindBuffer(int capacity = REWIND_FRAMES, int keyInterval = REWIND_KEYFRAME_INTERVAL);
+
+// Append the state as the frame after the newest one
+void RecordRewindFrame(RewindBuffer& rb, const GameState& state);
+
+// Decode a recorded frame (clamped to the range held) into state; false when the buffer is empty
+bool RestoreRewindFrame(RewindBuffer& rb, long long frame, GameState& state);
+
+// Forget the frames after 'frame' so recording continues from it once a rewind ends
+void TruncateRewindBuffer(RewindBuffer& rb, long long frame);
+
+void ClearRewindBuffer(RewindBuffer& rb);
+
+// Seconds of history held at the target frame rate
+float GetRewindSeconds(const RewindBuffer& rb);
@@ -0,0 +1,119 @@
+#include "SimThread.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+struct SimThread
+{
+    thread worker;
+    mutex lock;
+    condition_variable wake;
+    condition_variable done;
+    function<void()> step;     // guarded by lock, set while a step is queued or running
+    bool busy;
+    bool stopping;
+    bool threaded;
+
+    float lastStepMs;          // written by whoever ran the step, read after WaitSimStep
+    float lastWaitMs;
+};
+
+static void RunStep(SimThread* sim, const function<void()>& step)
+{
+    auto start = chrono::high_resolution_clock::now();
+    step();
+    sim->lastStepMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+static void WaitIdle(SimThread* sim)
+{
+    unique_lock<mutex> guard(sim->lock);
+    sim->done.wait(guard, [sim] { return !sim->busy; });
+}
+
+static void WorkerLoop(SimThread* sim)
+{
+    unique_lock<mutex> guard(sim->lock);
+    while (true)
+    {
+        sim->wake.wait(guard, [sim] { return sim->stopping || sim->busy; });
+        if (!sim->busy) break;
+
+        function<void()> step = sim->step;
+        guard.unlock();
+        RunStep(sim, step);
+        guard.lock();
+
+        sim->step = nullptr;
+        sim->busy = false;
+        sim->done.notify_all();
+    }
+}
+
+SimThread* CreateSimThread(bool threaded)
+{
+    SimThread* sim = new SimThread();
+    sim->busy = false;
+    sim->stopping = false;
+    sim->threaded = threaded;
+    sim->lastStepMs = 0.0f;
+    sim->lastWaitMs = 0.0f;
+    if (threaded) sim->worker = thread(WorkerLoop, sim);
+    return sim;
+}
+
+void DestroySimThread(SimThread* sim)
+{
+    if (sim == nullptr) return;
+    WaitIdle(sim);
+    {
+        lock_guard<mutex> guard(sim->lock);
+        sim->stopping = true;
+    }
+    sim->wake.notify_one();
+    if (sim->worker.joinable()) sim->worker.join();
+    delete sim;
+}
+
+void KickSimStep(SimThread* sim, const function<void()>& step)
+{
+    if (!sim->threaded)
+    {
+        RunStep(sim, step);
+        return;
+    }
+
+    // One step in flight at a time; a second kick waits for the first
+    WaitIdle(sim);
+    {
+        lock_guard<mutex> guard(sim->lock);
+        sim->step = step;
+        sim->busy = true;
+    }
+    sim->wake.notify_one();
+}
+
+void WaitSimStep(SimThread* sim)
+{
+    auto start = chrono::high_resolution_clock::now();
+    WaitIdle(sim);
+    sim->lastWaitMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+bool IsSimThreaded(const SimThread* sim)
+{
+    return sim->threaded;
+}
+
+float GetSimStepMs(const SimThread* sim)
+{
+    return sim->lastStepMs;
+}
+
+float GetSimWaitMs(const SimThread* sim)
+{
+    return sim->lastWaitMs;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <functional>
+
+// Runs the environment step of a frame on a background thread while the main thread hands that
+// frame to the GPU (EndDrawing blocks on vsync and the driver). The main thread kicks the step
+// after its last read of the simulation for the frame and waits for it before touching the
+// simulation again, so the two threads never work on the same data at the same time.
+struct SimThread;
+
+// threaded = false runs every step inline in KickSimStep
+SimThread* CreateSimThread(bool threaded = true);
+
+// Waits for a step still running
+void DestroySimThread(SimThread* sim);
+
+void KickSimStep(SimThread* sim, const std::function<void()>& step);
+void WaitSimStep(SimThread* sim);
+
+bool IsSimThreaded(const SimThread* sim);
+float GetSimStepMs(const SimThread* sim);   // last step, wherever it ran
+float GetSimWaitMs(const SimThread* sim);   // how long the last WaitSimStep blocked
@@ -0,0 +1,248 @@
+#include "SpriteBatch.h"
+#include "GpuQuad.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+using namespace std;
+
+static const char* SPRITE_VS =
+    "#version 330\n"
+    "layout(location = 0) in vec2 position;\n"
+    "layout(location = 1) in vec2 texcoord;\n"
+    "layout(location = 2) in vec4 color;\n"
+    "uniform mat4 mvp;\n"
+    "out vec2 uv;\n"
+    "out vec4 tint;\n"
+    "void main()\n"
+    "{\n"
+    "    uv = texcoord;\n"
+    "    tint = color;\n"
+    "    gl_Position = mvp*vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* SPRITE_FS =
+    "#version 330\n"
+    "in vec2 uv;\n"
+    "in vec4 tint;\n"
+    "uniform sampler2D texture0;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    finalColor = texture(texture0, uv)*tint;\n"
+    "}\n";
+
+static const int LAYER_SHIFT = 56;
+static const int TEXTURE_SHIFT = 32;
+
+SpriteBatch CreateSpriteBatch(void)
+{
+    SpriteBatch sb;
+    sb.flushed = 0;
+    sb.sorted = true;
+    sb.vertices.resize(4 * SPRITE_BATCH_MAX_QUADS);
+    sb.vao = sb.vbo = sb.ebo = 0;
+    sb.locMvp = sb.locTexture = -1;
+    sb.sprites = sb.drawCalls = 0;
+    sb.flushMs = 0.0f;
+    sb.lastSprites = sb.lastDrawCalls = 0;
+    sb.lastFlushMs = 0.0f;
+
+    sb.shader = LoadShaderFromMemory(SPRITE_VS, SPRITE_FS);
+    sb.hasShader = (sb.shader.id != 0 && sb.shader.id != rlGetShaderIdDefault());
+    if (!sb.hasShader)
+    {
+        TraceLog(LOG_WARNING, "SPRITES: shader unavailable, sprites go through the immediate-mode batch");
+        return sb;
+    }
+    sb.locMvp = GetShaderLocation(sb.shader, "mvp");
+    sb.locTexture = GetShaderLocation(sb.shader, "texture0");
+
+    // Quad k owns vertices 4k..4k + 3 (top-left, bottom-left, bottom-right, top-right), the same
+    // winding raylib uses, so back-face culling keeps them
+    vector<unsigned short> indices(6 * SPRITE_BATCH_MAX_QUADS);
+    for (int k = 0; k < SPRITE_BATCH_MAX_QUADS; ++k)
+    {
+        unsigned short v = (unsigned short)(4 * k);
+        unsigned short* tri = &indices[6 * k];
+        tri[0] = v;
+        tri[1] = (unsigned short)(v + 1);
+        tri[2] = (unsigned short)(v + 2);
+        tri[3] = v;
+        tri[4] = (unsigned short)(v + 2);
+        tri[5] = (unsigned short)(v + 3);
+    }
+
+    sb.vao = rlLoadVertexArray();
+    rlEnableVertexArray(sb.vao);
+    sb.vbo = rlLoadVertexBuffer(nullptr, (int)(sb.vertices.size() * sizeof(SpriteVertex)), true);
+    rlSetVertexAttribute(0, 2, RL_FLOAT, false, sizeof(SpriteVertex), 0);
+    rlEnableVertexAttribute(0);
+    rlSetVertexAttribute(1, 2, RL_FLOAT, false, sizeof(SpriteVertex), (int)offsetof(SpriteVertex, u));
+    rlEnableVertexAttribute(1);
+    rlSetVertexAttribute(2, 4, RL_UNSIGNED_BYTE, true, sizeof(SpriteVertex), (int)offsetof(SpriteVertex, color));
+    rlEnableVertexAttribute(2);
+    sb.ebo = rlLoadVertexBufferElement(indices.data(), (int)(indices.size() * sizeof(unsigned short)), false);
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+    rlDisableVertexBufferElement();
+    return sb;
+}
+
+void UnloadSpriteBatch(SpriteBatch& sb)
+{
+    if (sb.vao != 0) rlUnloadVertexArray(sb.vao);
+    if (sb.vbo != 0) rlUnloadVertexBuffer(sb.vbo);
+    if (sb.ebo != 0) rlUnloadVertexBuffer(sb.ebo);
+    sb.vao = sb.vbo = sb.ebo = 0;
+    if (sb.hasShader) UnloadShader(sb.shader);
+    sb.hasShader = false;
+    sb.commands.clear();
+    sb.keys.clear();
+    sb.flushed = 0;
+}
+
+static void Push(SpriteBatch& sb, const SpriteCommand& c, int layer)
+{
+    // Sprites submitted after a partial flush sort among the ones still waiting
+    uint64_t key = ((uint64_t)min(max(layer, 0), 255) << LAYER_SHIFT)
+                 | ((uint64_t)(c.texture & 0xFFFFFF) << TEXTURE_SHIFT)
+                 | (uint64_t)sb.commands.size();
+    sb.commands.push_back(c);
+    sb.keys.push_back(key);
+    sb.sorted = false;
+}
+
+void SubmitSprite(SpriteBatch& sb, Texture2D texture, Rectangle src, Rectangle dst, Color tint, int layer)
+{
+    if (texture.id == 0 || texture.width <= 0 || texture.height <= 0) return;
+
+    float invW = 1.0f / (float)texture.width;
+    float invH = 1.0f / (float)texture.height;
+    SpriteCommand c;
+    c.texture = texture.id;
+    c.u0 = src.x * invW;
+    c.u1 = (src.x + fabsf(src.width)) * invW;
+    c.v0 = src.y * invH;
+    c.v1 = (src.y + fabsf(src.height)) * invH;
+    if (src.width < 0.0f) swap(c.u0, c.u1);
+    if (src.height < 0.0f) swap(c.v0, c.v1);
+    c.dst = dst;
+    c.tint = tint;
+    Push(sb, c, layer);
+}
+
+void SubmitSpriteRect(SpriteBatch& sb, Rectangle dst, Color color, int layer)
+{
+    SpriteCommand c = { rlGetTextureIdDefault(), 0.0f, 0.0f, 1.0f, 1.0f, dst, color };
+    Push(sb, c, layer);
+}
+
+static void WriteQuad(SpriteVertex* v, const SpriteCommand& c)
+{
+    float x0 = c.dst.x;
+    float y0 = c.dst.y;
+    float x1 = c.dst.x + c.dst.width;
+    float y1 = c.dst.y + c.dst.height;
+    v[0] = { x0, y0, c.u0, c.v0, { c.tint.r, c.tint.g, c.tint.b, c.tint.a } };
+    v[1] = { x0, y1, c.u0, c.v1, { c.tint.r, c.tint.g, c.tint.b, c.tint.a } };
+    v[2] = { x1, y1, c.u1, c.v1, { c.tint.r, c.tint.g, c.tint.b, c.tint.a } };
+    v[3] = { x1, y0, c.u1, c.v0, { c.tint.r, c.tint.g, c.tint.b, c.tint.a } };
+}
+
+// Upload up to SPRITE_BATCH_MAX_QUADS sprites and draw each texture run with one call
+static void DrawChunk(SpriteBatch& sb, int first, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const SpriteCommand& c = sb.commands[(size_t)(sb.keys[first + i] & 0xFFFFFFFFu)];
+        WriteQuad(&sb.vertices[4 * i], c);
+    }
+    rlUpdateVertexBuffer(sb.vbo, sb.vertices.data(), 4 * count * (int)sizeof(SpriteVertex), 0);
+
+    rlEnableVertexArray(sb.vao);
+    int run = 0;
+    while (run < count)
+    {
+        unsigned int texture = sb.commands[(size_t)(sb.keys[first + run] & 0xFFFFFFFFu)].texture;
+        int end = run + 1;
+        while (end < count && sb.commands[(size_t)(sb.keys[first + end] & 0xFFFFFFFFu)].texture == texture) ++end;
+
+        rlEnableTexture(texture);
+        rlDrawVertexArrayElements(6 * run, 6 * (end - run), 0);
+        sb.drawCalls++;
+        run = end;
+    }
+    rlDisableVertexArray();
+}
+
+void FlushSpriteBatch(SpriteBatch& sb, int lastLayer)
+{
+    auto start = chrono::high_resolution_clock::now();
+
+    int total = (int)sb.keys.size();
+    if (!sb.sorted)
+    {
+        sort(sb.keys.begin() + sb.flushed, sb.keys.end());
+        sb.sorted = true;
+    }
+    int end = sb.flushed;
+    while (end < total && (int)(sb.keys[end] >> LAYER_SHIFT) <= lastLayer) ++end;
+
+    if (end > sb.flushed)
+    {
+        if (sb.vao != 0)
+        {
+            int slot = 0;
+            BeginCustomDraw(sb.shader, sb.locMvp);
+            rlSetUniform(sb.locTexture, &slot, RL_SHADER_UNIFORM_INT, 1);
+            rlActiveTextureSlot(0);
+            for (int first = sb.flushed; first < end; first += SPRITE_BATCH_MAX_QUADS)
+            {
+                DrawChunk(sb, first, min(end - first, SPRITE_BATCH_MAX_QUADS));
+            }
+            rlDisableTexture();
+            rlDisableShader();
+        }
+        else
+        {
+            // Same quads through the batch; it only splits its draw calls when the texture changes
+            rlBegin(RL_QUADS);
+            for (int i = sb.flushed; i < end; ++i)
+            {
+                const SpriteCommand& c = sb.commands[(size_t)(sb.keys[i] & 0xFFFFFFFFu)];
+                SpriteVertex v[4];
+                WriteQuad(v, c);
+                rlSetTexture(c.texture);
+                rlColor4ub(c.tint.r, c.tint.g, c.tint.b, c.tint.a);
+                for (const SpriteVertex& p : v)
+                {
+                    rlTexCoord2f(p.u, p.v);
+                    rlVertex2f(p.x, p.y);
+                }
+            }
+            rlEnd();
+            rlSetTexture(0);
+            rlDrawRenderBatchActive();
+            sb.drawCalls++;
+        }
+        sb.sprites += end - sb.flushed;
+    }
+    sb.flushed = end;
+    sb.flushMs += chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+
+    // Only the last flush of the frame empties the batch and publishes the totals
+    if (lastLayer >= SPRITE_LAYER_COUNT - 1)
+    {
+        sb.commands.clear();
+        sb.keys.clear();
+        sb.flushed = 0;
+        sb.lastSprites = sb.sprites;
+        sb.lastDrawCalls = sb.drawCalls;
+        sb.lastFlushMs = sb.flushMs;
+        sb.sprites = sb.drawCalls = 0;
+        sb.flushMs = 0.0f;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "raylib.h"
+#include <cstdint>
+#include <vector>
+
+// Draw order of the sprite batch. Inside a layer sprites are grouped by texture, not by submission
+// order, so sprites that have to stack in a fixed order go on different layers.
+enum SpriteLayer
+{
+    SPRITE_LAYER_PROPS = 0,       // secret room cat, wells, dams: behind the river
+    SPRITE_LAYER_PICKUPS,         // coins
+    SPRITE_LAYER_CHARACTERS,      // NPCs
+    SPRITE_LAYER_PLAYER,
+    SPRITE_LAYER_PLAYER_BLEND,    // previous pose fading out over the current one
+    SPRITE_LAYER_COUNT
+};
+
+const int SPRITE_BATCH_MAX_QUADS = 16384;   // per upload, 16-bit indices
+
+struct SpriteVertex
+{
+    float x;
+    float y;
+    float u;
+    float v;
+    unsigned char color[4];
+};
+
+// A sprite as submitted, texture coordinates already normalised
+struct SpriteCommand
+{
+    unsigned int texture;
+    float u0;
+    float v0;
+    float u1;
+    float v1;
+    Rectangle dst;
+    Color tint;
+};
+
+struct SpriteBatch
+{
+    std::vector<SpriteCommand> commands;   // this frame's submissions
+    std::vector<uint64_t> keys;            // layer, texture, submission index; sorted on the first flush
+    std::vector<SpriteVertex> vertices;    // staging for one upload
+    int flushed;                           // keys [0, flushed) are drawn
+    bool sorted;
+
+    unsigned int vao;     // 0 when the shader is unavailable and the immediate-mode batch is used
+    unsigned int vbo;
+    unsigned int ebo;
+    Shader shader;
+    int locMvp;
+    int locTexture;
+    bool hasShader;
+
+    // Totals of the last frame, published when the batch empties
+    int sprites;
+    int drawCalls;
+    float flushMs;
+    int lastSprites;
+    int lastDrawCalls;
+    float lastFlushMs;
+};
+
+// Needs a GL context (call after InitWindow)
+SpriteBatch CreateSpriteBatch(void);
+void UnloadSpriteBatch(SpriteBatch& sb);
+
+// Queue a textured quad; src follows DrawTexturePro (negative width or height flips)
+void SubmitSprite(SpriteBatch& sb, Texture2D texture, Rectangle src, Rectangle dst, Color tint, int layer);
+
+// Queue a flat coloured rectangle, drawn with the default white texture
+void SubmitSpriteRect(SpriteBatch& sb, Rectangle dst, Color color, int layer);
+
+// Draw the queued sprites of layers up to lastLayer inside BeginMode2D, sorted by layer and then
+// texture, with one draw call per texture run. Sprites of later layers wait for the next flush,
+// so other geometry (the river) can be drawn between layers; the batch is empty once all are drawn.
+void FlushSpriteBatch(SpriteBatch& sb, int lastLayer = SPRITE_LAYER_COUNT - 1);
@@ -0,0 +1,143 @@
+#include "UiLayer.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+using namespace std;
+
+static void LoadUiFont(UiLayer& ui)
+{
+    if (ui.ownsFont) UnloadFont(ui.font);
+    int pixels = max(1, (int)lroundf(ui.baseFontSize * ui.scale));
+    ui.font = LoadFontEx(ui.fontPath.c_str(), pixels, ui.codepoints.data(), (int)ui.codepoints.size());
+    ui.ownsFont = (ui.font.texture.id != 0);
+    if (!ui.ownsFont)
+    {
+        ui.font = GetFontDefault();
+        TraceLog(LOG_WARNING, "UI: could not load %s, falling back to the default font", ui.fontPath.c_str());
+        return;
+    }
+    TraceLog(LOG_INFO, "UI: Font rasterised at %d px for a %.2fx layout", pixels, ui.scale);
+}
+
+UiLayer CreateUiLayer(float width, float height, Rectangle output, const char* fontPath, const char* characters, int baseFontSize)
+{
+    UiLayer ui;
+    ui.width = width;
+    ui.height = height;
+    ui.output = output;
+    ui.scale = output.height / height;
+    ui.baseFontSize = baseFontSize;
+    ui.fontPath = fontPath;
+    ui.ownsFont = false;
+    ui.generation = 0;
+
+    int count = 0;
+    int* codepoints = LoadCodepoints(characters, &count);
+    ui.codepoints.assign(codepoints, codepoints + count);
+    UnloadCodepoints(codepoints);
+
+    LoadUiFont(ui);
+    return ui;
+}
+
+void UnloadUiLayer(UiLayer& ui)
+{
+    if (ui.ownsFont) UnloadFont(ui.font);
+    ui.ownsFont = false;
+}
+
+bool SetUiOutput(UiLayer& ui, Rectangle output)
+{
+    bool resized = (output.width != ui.output.width || output.height != ui.output.height);
+    ui.output = output;
+    if (!resized) return false;
+
+    ui.scale = output.height / ui.height;
+    LoadUiFont(ui);
+    ui.generation++;
+    return true;
+}
+
+void BeginUi(const UiLayer& ui)
+{
+    rlDrawRenderBatchActive();
+    rlPushMatrix();
+    rlTranslatef(ui.output.x, ui.output.y, 0.0f);
+    rlScalef(ui.output.width / ui.width, ui.output.height / ui.height, 1.0f);
+}
+
+void EndUi(void)
+{
+    rlDrawRenderBatchActive();
+    rlPopMatrix();
+}
+
+UiText MakeUiText(float maxWidth, float fontSize, float spacing)
+{
+    UiText text;
+    text.maxWidth = maxWidth;
+    text.fontSize = fontSize;
+    text.spacing = spacing;
+    text.generation = -1;
+    return text;
+}
+
+// Greedy word wrap; widths are measured with the font as rasterised for this layout
+static string WordWrapText(const string& text, float maxWidth, const Font& font, float fontSize, float charSpacing)
+{
+    if (text.empty()) return "";
+
+    string wrappedText;
+    string currentLine;
+
+    stringstream ss(text);
+    string word;
+
+    while (ss >> word)
+    {
+        string testLine = currentLine.empty() ? word : currentLine + " " + word;
+
+        Vector2 size = MeasureTextEx(font, testLine.c_str(), fontSize, charSpacing);
+        if (size.x > maxWidth)
+        {
+            if (!currentLine.empty())
+            {
+                wrappedText += currentLine + "\n";
+                currentLine = word;
+            }
+            else
+            {
+                // single too-long word
+                wrappedText += word + "\n";
+                currentLine.clear();
+            }
+        }
+        else
+        {
+            currentLine = testLine;
+        }
+    }
+
+    if (!currentLine.empty())
+    {
+        wrappedText += currentLine;
+    }
+
+    return wrappedText;
+}
+
+void SetUiText(UiText& text, const string& source, const UiLayer& ui)
+{
+    text.source = source;
+    text.wrapped = WordWrapText(source, text.maxWidth, ui.font, text.fontSize, text.spacing);
+    text.generation = ui.generation;
+}
+
+bool UpdateUiText(UiText& text, const UiLayer& ui)
+{
+    if (text.generation == ui.generation) return false;
+    SetUiText(text, text.source, ui);
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "raylib.h"
+#include <string>
+#include <vector>
+
+// The HUD is laid out in virtual units (the 1280x720 the game was designed for) and drawn straight
+// onto the display through a transform onto the output rectangle, so shapes are rasterised at the
+// display's resolution. The font is rasterised at the size it ends up on screen; it is reloaded,
+// and wrapped text laid out again, only when the output rectangle changes size.
+struct UiLayer
+{
+    float width;          // virtual units
+    float height;
+    Rectangle output;     // pixels
+    float scale;          // pixels per virtual unit
+
+    Font font;            // glyphs rasterised at baseFontSize * scale pixels
+    int baseFontSize;     // virtual units
+    std::string fontPath;
+    std::vector<int> codepoints;
+    bool ownsFont;        // false when falling back to raylib's default font
+
+    int generation;       // bumped on every relayout
+};
+
+// Text wrapped to a width in virtual units, laid out for one generation of the layer
+struct UiText
+{
+    std::string source;
+    std::string wrapped;  // source with the line breaks; same length whenever words fit
+    float maxWidth;
+    float fontSize;
+    float spacing;
+    int generation;
+};
+
+// Needs a GL context (call after InitWindow)
+UiLayer CreateUiLayer(float width, float height, Rectangle output, const char* fontPath, const char* characters, int baseFontSize);
+void UnloadUiLayer(UiLayer& ui);
+
+// Returns true when the output changed size and text has to be laid out again
+bool SetUiOutput(UiLayer& ui, Rectangle output);
+
+// Everything between these is drawn in virtual units
+void BeginUi(const UiLayer& ui);
+void EndUi(void);
+
+UiText MakeUiText(float maxWidth, float fontSize, float spacing);
+
+// Lays the text out right away
+void SetUiText(UiText& text, const std::string& source, const UiLayer& ui);
+
+// Lays the text out again when the layer changed since; returns true when it did
+bool UpdateUiText(UiText& text, const UiLayer& ui);
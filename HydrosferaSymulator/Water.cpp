@@ -0,0 +1,751 @@
+#include "Water.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WATER_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Extra floats at the end of every array so SIMD loads may run one vector past the last cell
+static const int WATER_PADDING = 4;
+
+ShallowWater CreateShallowWater(float originX, float width, float cellSize, JobSystem* jobs)
+{
+    ShallowWater w;
+    w.cellCount = max(2, (int)ceilf(width / cellSize));
+    w.originX = originX;
+    w.cellSize = cellSize;
+    w.jobs = jobs;
+
+    for (int first = 0; first < w.cellCount; first += WATER_TILE_CELLS)
+    {
+        WaterTile t;
+        t.firstCell = first;
+        t.cellCount = min(WATER_TILE_CELLS, w.cellCount - first);
+        size_t padded = (size_t)t.cellCount + 2 + WATER_PADDING;
+        t.bed.assign(padded, 0.0f);
+        t.depth.assign(padded, 0.0f);
+        t.eta.assign(padded, 0.0f);
+        t.flow.assign(padded, 0.0f);
+        t.flux.assign(padded, 0.0f);
+        t.coarse = false;
+        t.leftRegister = 0.0f;
+        t.rightRegister = 0.0f;
+        w.tiles.push_back(t);
+    }
+
+    w.focusX0 = originX;
+    w.focusX1 = originX + width;
+    w.coarseTiles = 0;
+    w.accumulator = 0.0f;
+    w.simTime = 0.0;
+    w.tickCount = 0;
+    w.lastUpdateMs = 0.0f;
+    return w;
+}
+
+static inline WaterTile& TileOf(ShallowWater& water, int cell, int& local)
+{
+    WaterTile& t = water.tiles[cell / WATER_TILE_CELLS];
+    local = cell - t.firstCell + 1;
+    return t;
+}
+
+static inline const WaterTile& TileOf(const ShallowWater& water, int cell, int& local)
+{
+    const WaterTile& t = water.tiles[cell / WATER_TILE_CELLS];
+    local = cell - t.firstCell + 1;
+    return t;
+}
+
+// Depth of a fine cell; a coarse tile spreads its coarse cell's depth evenly over the fine bed
+static inline float CellDepth(const WaterTile& t, int local)
+{
+    return t.coarse ? t.cdepth[(local - 1) / WATER_LOD_FACTOR + 1] : t.depth[local];
+}
+
+void InitShallowWaterBed(ShallowWater& water, float (*bedAt)(float x), float level)
+{
+    for (WaterTile& t : water.tiles)
+    {
+        for (int j = 1; j <= t.cellCount; ++j)
+        {
+            float x = water.originX + ((float)(t.firstCell + j - 1) + 0.5f) * water.cellSize;
+            t.bed[j] = bedAt(x);
+            t.depth[j] = max(0.0f, level - t.bed[j]);
+            t.eta[j] = t.bed[j] + t.depth[j];
+        }
+        fill(t.flow.begin(), t.flow.end(), 0.0f);
+        fill(t.flux.begin(), t.flux.end(), 0.0f);
+    }
+}
+
+int AddWaterRegion(ShallowWater& water, float x0, float x1, float rate, float targetLevel)
+{
+    water.regions.push_back({ x0, x1, rate, targetLevel, true });
+    return (int)water.regions.size() - 1;
+}
+
+// Stage-storage tables of every dam: a pool reaches upstream until the bed rises above its level
+// or another dam stands in the way. Rebuilt whenever a dam is added or removed.
+static void BuildDamTables(ShallowWater& water)
+{
+    for (WaterDam& d : water.dams)
+    {
+        int stop = -1;
+        for (const WaterDam& other : water.dams)
+        {
+            if (other.face < d.face) stop = max(stop, other.face);
+        }
+
+        int rows = (int)ceilf((d.crest + WATER_DAM_TABLE_HEADROOM) / WATER_DAM_TABLE_STEP) + 1;
+        d.storageTable.assign(rows, 0.0f);
+        for (int k = 1; k < rows; ++k)
+        {
+            float level = k * WATER_DAM_TABLE_STEP;
+            double volume = 0.0;
+            for (int c = d.face; c > stop; --c)
+            {
+                float bed = GetWaterCellBed(water, c);
+                if (bed >= level) break;
+                volume += level - bed;
+            }
+            d.storageTable[k] = (float)(volume * water.cellSize);
+        }
+        d.poolStorage = GetWaterDamStorage(d, d.poolLevel);
+    }
+}
+
+int AddWaterDam(ShallowWater& water, float x, float crest, float intakeLevel, float turbineCapacity)
+{
+    int face = WaterCellAt(water, x);
+    if ((int)water.dams.size() >= WATER_MAX_DAMS) return -1;
+    if (face < 1 || face + WATER_DAM_SCOUR_CELLS >= water.cellCount - 1) return -1;
+
+    WaterDam d;
+    d.face = face;
+    d.crest = crest;
+    d.intakeLevel = min(intakeLevel, crest);
+    d.turbineCapacity = turbineCapacity;
+    for (int k = 1; k <= WATER_DAM_SCOUR_CELLS; ++k) d.tailBed.push_back(GetWaterCellBed(water, face + k));
+    d.poolLevel = GetWaterCellSurface(water, face);
+    d.poolStorage = 0.0f;
+    d.inflow = 0.0f;
+    d.turbineFlow = 0.0f;
+    d.spillFlow = 0.0f;
+    d.power = 0.0f;
+    d.trapEfficiency = 0.0f;
+    d.trappedSediment = 0.0;
+    d.scouredSediment = 0.0;
+    water.dams.push_back(d);
+    BuildDamTables(water);
+    return (int)water.dams.size() - 1;
+}
+
+void RemoveWaterDam(ShallowWater& water, int index)
+{
+    if (index < 0 || index >= (int)water.dams.size()) return;
+    water.dams.erase(water.dams.begin() + index);
+    BuildDamTables(water);
+}
+
+float GetWaterDamX(const ShallowWater& water, int index)
+{
+    return water.originX + (float)(water.dams[index].face + 1) * water.cellSize;
+}
+
+float GetWaterDamStorage(const WaterDam& dam, float level)
+{
+    const vector<float>& table = dam.storageTable;
+    if (table.size() < 2) return 0.0f;
+    float k = max(0.0f, level / WATER_DAM_TABLE_STEP);
+    int i = min((int)k, (int)table.size() - 2);
+    return table[i] + (table[i + 1] - table[i]) * (k - (float)i);
+}
+
+int WaterCellAt(const ShallowWater& water, float x)
+{
+    int i = (int)floorf((x - water.originX) / water.cellSize);
+    return max(0, min(i, water.cellCount - 1));
+}
+
+// eta = bed + depth
+static void SurfaceKernel(const float* bed, const float* depth, float* eta, int n)
+{
+    int i = 0;
+#ifdef WATER_USE_SSE2
+    for (; i + 4 <= n; i += 4)
+    {
+        _mm_storeu_ps(eta + i, _mm_add_ps(_mm_loadu_ps(bed + i), _mm_loadu_ps(depth + i)));
+    }
+#endif
+    for (; i < n; ++i) eta[i] = bed[i] + depth[i];
+}
+
+// u[i] is the face between cells i and i + 1: accelerate by the surface slope, damp,
+// clamp to the CFL limit, zero on dry faces
+static void FlowKernel(const float* eta, const float* depth, float* u, int faces, float gradCoeff, float damping, float maxU)
+{
+    int i = 0;
+#ifdef WATER_USE_SSE2
+    const __m128 vCoeff = _mm_set1_ps(gradCoeff);
+    const __m128 vDamp = _mm_set1_ps(damping);
+    const __m128 vMax = _mm_set1_ps(maxU);
+    const __m128 vMin = _mm_set1_ps(-maxU);
+    const __m128 vEps = _mm_set1_ps(WATER_DRY_EPS);
+    for (; i + 4 <= faces; i += 4)
+    {
+        __m128 grad = _mm_sub_ps(_mm_loadu_ps(eta + i + 1), _mm_loadu_ps(eta + i));
+        __m128 v = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(u + i), _mm_mul_ps(vCoeff, grad)), vDamp);
+        v = _mm_min_ps(_mm_max_ps(v, vMin), vMax);
+        __m128 wet = _mm_cmpgt_ps(_mm_add_ps(_mm_loadu_ps(depth + i), _mm_loadu_ps(depth + i + 1)), vEps);
+        _mm_storeu_ps(u + i, _mm_and_ps(v, wet));
+    }
+#endif
+    for (; i < faces; ++i)
+    {
+        float v = (u[i] - gradCoeff * (eta[i + 1] - eta[i])) * damping;
+        v = max(-maxU, min(v, maxU));
+        u[i] = (depth[i] + depth[i + 1] > WATER_DRY_EPS) ? v : 0.0f;
+    }
+}
+
+// Upwind volume flux: flux[i] = u[i] * depth of the cell the flow leaves
+static void FluxKernel(const float* depth, const float* u, float* flux, int faces)
+{
+    int i = 0;
+#ifdef WATER_USE_SSE2
+    const __m128 vZero = _mm_setzero_ps();
+    for (; i + 4 <= faces; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(u + i);
+        __m128 pos = _mm_cmpgt_ps(v, vZero);
+        __m128 h = _mm_or_ps(_mm_and_ps(pos, _mm_loadu_ps(depth + i)), _mm_andnot_ps(pos, _mm_loadu_ps(depth + i + 1)));
+        _mm_storeu_ps(flux + i, _mm_mul_ps(v, h));
+    }
+#endif
+    for (; i < faces; ++i)
+    {
+        flux[i] = u[i] * (u[i] > 0.0f ? depth[i] : depth[i + 1]);
+    }
+}
+
+// Conservative depth update, cell i lies between faces i and i + 1
+static void DepthKernel(float* depth, const float* flux, int n, float k)
+{
+    int i = 0;
+#ifdef WATER_USE_SSE2
+    const __m128 vK = _mm_set1_ps(k);
+    const __m128 vZero = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 div = _mm_sub_ps(_mm_loadu_ps(flux + i + 1), _mm_loadu_ps(flux + i));
+        __m128 h = _mm_sub_ps(_mm_loadu_ps(depth + i), _mm_mul_ps(vK, div));
+        _mm_storeu_ps(depth + i, _mm_max_ps(h, vZero));
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        depth[i] = max(0.0f, depth[i] - k * (flux[i + 1] - flux[i]));
+    }
+}
+
+static void ApplyRegions(const ShallowWater& water, WaterTile& t, float dt)
+{
+    const int lod = t.coarse ? WATER_LOD_FACTOR : 1;
+    vector<float>& bed = t.coarse ? t.cbed : t.bed;
+    vector<float>& depth = t.coarse ? t.cdepth : t.depth;
+    for (const WaterRegion& r : water.regions)
+    {
+        if (!r.active) continue;
+        int first = max(WaterCellAt(water, r.x0), t.firstCell) - t.firstCell;
+        int last = min(WaterCellAt(water, r.x1), t.firstCell + t.cellCount - 1) - t.firstCell;
+        if (last < first) continue;
+        for (int j = first / lod + 1; j <= last / lod + 1; ++j)
+        {
+            float& h = depth[j];
+            if (r.targetLevel >= 0.0f)
+            {
+                float target = max(0.0f, r.targetLevel - bed[j]);
+                h += (target - h) * min(1.0f, dt * 2.0f);
+            }
+            else
+            {
+                h = max(0.0f, h + r.rate * dt);
+            }
+        }
+    }
+}
+
+// Phase 1: sources and the free surface of owned cells; coarse tiles only on their step
+static void TileSources(ShallowWater& water, int index, bool coarseStep)
+{
+    WaterTile& t = water.tiles[index];
+    if (!t.coarse)
+    {
+        ApplyRegions(water, t, WATER_TICK);
+        SurfaceKernel(&t.bed[1], &t.depth[1], &t.eta[1], t.cellCount);
+    }
+    else if (coarseStep)
+    {
+        ApplyRegions(water, t, WATER_TICK * WATER_LOD_FACTOR);
+        SurfaceKernel(&t.cbed[1], &t.cdepth[1], &t.ceta[1], t.cellCount / WATER_LOD_FACTOR);
+    }
+}
+
+// Halo cell from a neighbour of the same resolution, 'edge' is the neighbour's local index
+static inline void CopyHalo(vector<float>& bed, vector<float>& depth, vector<float>& eta, int to,
+                            const vector<float>& nBed, const vector<float>& nDepth, const vector<float>& nEta, int edge)
+{
+    bed[to] = nBed[edge];
+    depth[to] = nDepth[edge];
+    eta[to] = nEta[edge];
+}
+
+// Phase 2: halo exchange of cell state, then velocity and flux on the owned faces. A face
+// shared with a tile of the other resolution is left to StepLodInterfaces.
+static void TileFlow(ShallowWater& water, int index, bool coarseStep)
+{
+    WaterTile& t = water.tiles[index];
+    if (t.coarse && !coarseStep) return;
+
+    const int tiles = (int)water.tiles.size();
+    const WaterTile* left = (index > 0) ? &water.tiles[index - 1] : nullptr;
+    const WaterTile* right = (index + 1 < tiles) ? &water.tiles[index + 1] : nullptr;
+    const int lod = t.coarse ? WATER_LOD_FACTOR : 1;
+    const int n = t.cellCount / lod;
+    const float dx = water.cellSize * lod;
+    const float dt = WATER_TICK * lod;
+    vector<float>& bed = t.coarse ? t.cbed : t.bed;
+    vector<float>& depth = t.coarse ? t.cdepth : t.depth;
+    vector<float>& eta = t.coarse ? t.ceta : t.eta;
+    vector<float>& flow = t.coarse ? t.cflow : t.flow;
+    vector<float>& flux = t.coarse ? t.cflux : t.flux;
+
+    if (left != nullptr && left->coarse == t.coarse)
+    {
+        int edge = left->coarse ? left->cellCount / WATER_LOD_FACTOR : left->cellCount;
+        if (t.coarse) CopyHalo(bed, depth, eta, 0, left->cbed, left->cdepth, left->ceta, edge);
+        else CopyHalo(bed, depth, eta, 0, left->bed, left->depth, left->eta, edge);
+    }
+    if (right != nullptr && right->coarse == t.coarse)
+    {
+        if (t.coarse) CopyHalo(bed, depth, eta, n + 1, right->cbed, right->cdepth, right->ceta, 1);
+        else CopyHalo(bed, depth, eta, n + 1, right->bed, right->depth, right->eta, 1);
+    }
+    else
+    {
+        // World edge: mirror the last cell so the wall face sees no slope
+        CopyHalo(bed, depth, eta, n + 1, bed, depth, eta, n);
+    }
+
+    // Half a cell per tick at most through each face keeps depth non-negative
+    const float maxU = 0.5f * dx / dt;
+    int faces = (right != nullptr && right->coarse != t.coarse) ? n - 1 : n;
+    FlowKernel(&eta[1], &depth[1], &flow[1], faces, dt * WATER_GRAVITY / dx, WATER_DAMPING, maxU);
+    if (right == nullptr) flow[n] = 0.0f;
+    FluxKernel(&depth[1], &flow[1], &flux[1], faces);
+}
+
+// Serial, every tick: faces between a fine and a coarse tile advance at the fine rate with the
+// coarse cell as the ghost on its side. The fine tile applies the flux at once, the coarse tile
+// banks the volume and applies it at its own step.
+static void StepLodInterfaces(ShallowWater& water)
+{
+    const float dt = WATER_TICK;
+    const float dist = 0.5f * water.cellSize * (1 + WATER_LOD_FACTOR);
+    const float maxU = 0.5f * water.cellSize / dt;
+    for (int i = 0; i + 1 < (int)water.tiles.size(); ++i)
+    {
+        WaterTile& a = water.tiles[i];
+        WaterTile& b = water.tiles[i + 1];
+        if (a.coarse == b.coarse) continue;
+
+        int na = a.coarse ? a.cellCount / WATER_LOD_FACTOR : a.cellCount;
+        float etaL = a.coarse ? a.ceta[na] : a.eta[na];
+        float hL = a.coarse ? a.cdepth[na] : a.depth[na];
+        float etaR = b.coarse ? b.ceta[1] : b.eta[1];
+        float hR = b.coarse ? b.cdepth[1] : b.depth[1];
+
+        // The fine side stores the face: its last face, or the right tile's face 0
+        float& u = a.coarse ? b.flow[0] : a.flow[na];
+        float& q = a.coarse ? b.flux[0] : a.flux[na];
+        float v = (u - dt * WATER_GRAVITY * (etaR - etaL) / dist) * WATER_DAMPING;
+        v = max(-maxU, min(v, maxU));
+        u = (hL + hR > WATER_DRY_EPS) ? v : 0.0f;
+        q = u * (u > 0.0f ? hL : hR);
+
+        if (a.coarse) a.rightRegister += q * dt;
+        else b.leftRegister += q * dt;
+    }
+}
+
+// Between phases 2 and 3, serial: dam faces get their release as flux, the pool and sediment
+// balances advance, and the bed below each dam scours. Cost is a table lookup per dam plus the
+// fixed scour reach.
+static void StepDams(ShallowWater& water, float dt)
+{
+    for (WaterDam& d : water.dams)
+    {
+        int local, tailLocal;
+        WaterTile& t = TileOf(water, d.face, local);
+        // A dam's tiles are refined at the next coarse step boundary after it is built
+        if (t.coarse || TileOf(water, d.face + 1 + WATER_DAM_SCOUR_CELLS, tailLocal).coarse) continue;
+        const float forebay = t.eta[local];
+        const float depth = t.depth[local];
+        const float tail = GetWaterCellSurface(water, d.face + 1);
+
+        // Turbines open up as the pool rises from the intake level to the crest, the spillway
+        // passes whatever tops the crest. The solver's face limit caps the total.
+        float open = (forebay - d.intakeLevel) / max(1e-3f, d.crest - d.intakeLevel);
+        d.turbineFlow = d.turbineCapacity * max(0.0f, min(open, 1.0f));
+        float over = max(0.0f, forebay - d.crest);
+        d.spillFlow = WATER_DAM_SPILLWAY_COEFF * over * sqrtf(over);
+        float release = d.turbineFlow + d.spillFlow;
+        float maxRelease = 0.5f * depth * water.cellSize / dt;
+        if (release > maxRelease)
+        {
+            float scale = maxRelease / release;
+            d.turbineFlow *= scale;
+            d.spillFlow *= scale;
+            release = maxRelease;
+        }
+        t.flux[local] = release;
+        t.flow[local] = (depth > WATER_DRY_EPS) ? release / depth : 0.0f;
+        d.power = WATER_DAM_TURBINE_EFFICIENCY * d.turbineFlow * max(0.0f, forebay - tail);
+
+        // Level pool: storage off the table at the wave-averaged level, inflow from continuity
+        float smoothing = min(1.0f, dt / WATER_DAM_POOL_SMOOTHING);
+        d.poolLevel += (forebay - d.poolLevel) * smoothing;
+        float storage = GetWaterDamStorage(d, d.poolLevel);
+        float inflow = release + (storage - d.poolStorage) / dt;
+        d.inflow += (inflow - d.inflow) * smoothing;
+        d.poolStorage = storage;
+
+        // Sediment settles in proportion to the residence time; the water leaving the dam picks
+        // up the missing load from the bed below it until the scour limit is reached
+        float residence = d.poolStorage / max(1.0f, release);
+        d.trapEfficiency = residence / (residence + WATER_DAM_SETTLING_TIME);
+        float load = WATER_SEDIMENT_CONCENTRATION * max(0.0f, d.inflow);
+        d.trappedSediment += load * d.trapEfficiency * dt;
+        float hunger = WATER_SEDIMENT_CONCENTRATION * release - load * (1.0f - d.trapEfficiency);
+        if (hunger <= 0.0f) continue;
+
+        float drop = hunger * dt / (WATER_DAM_SCOUR_CELLS * water.cellSize);
+        for (int k = 0; k < WATER_DAM_SCOUR_CELLS; ++k)
+        {
+            int cellLocal;
+            WaterTile& ct = TileOf(water, d.face + 1 + k, cellLocal);
+            float floorBed = max(0.0f, d.tailBed[k] - WATER_DAM_MAX_SCOUR);
+            float cut = min(drop, ct.bed[cellLocal] - floorBed);
+            if (cut <= 0.0f) continue;
+            ct.bed[cellLocal] -= cut;
+            d.scouredSediment += cut * water.cellSize;
+        }
+    }
+}
+
+// Phase 3: take the shared left face from the neighbour, then update depth. Coarse tiles take
+// the banked volume of faces shared with fine neighbours.
+static void TileDepth(ShallowWater& water, int index, bool coarseStep)
+{
+    WaterTile& t = water.tiles[index];
+    const WaterTile* left = (index > 0) ? &water.tiles[index - 1] : nullptr;
+    const WaterTile* right = (index + 1 < (int)water.tiles.size()) ? &water.tiles[index + 1] : nullptr;
+
+    if (!t.coarse)
+    {
+        if (left == nullptr)
+        {
+            t.flow[0] = 0.0f;
+            t.flux[0] = 0.0f;
+        }
+        else if (!left->coarse)
+        {
+            t.flow[0] = left->flow[left->cellCount];
+            t.flux[0] = left->flux[left->cellCount];
+        }
+        DepthKernel(&t.depth[1], &t.flux[0], t.cellCount, WATER_TICK / water.cellSize);
+        SurfaceKernel(&t.bed[1], &t.depth[1], &t.eta[1], t.cellCount);
+        return;
+    }
+    if (!coarseStep) return;
+
+    const int n = t.cellCount / WATER_LOD_FACTOR;
+    const float dt = WATER_TICK * WATER_LOD_FACTOR;
+    if (left == nullptr)
+    {
+        t.cflow[0] = 0.0f;
+        t.cflux[0] = 0.0f;
+    }
+    else if (left->coarse)
+    {
+        t.cflow[0] = left->cflow[left->cellCount / WATER_LOD_FACTOR];
+        t.cflux[0] = left->cflux[left->cellCount / WATER_LOD_FACTOR];
+    }
+    else
+    {
+        t.cflow[0] = left->flow[left->cellCount];
+        t.cflux[0] = t.leftRegister / dt;
+    }
+    if (right != nullptr && !right->coarse)
+    {
+        t.cflow[n] = right->flow[0];
+        t.cflux[n] = t.rightRegister / dt;
+    }
+    t.leftRegister = 0.0f;
+    t.rightRegister = 0.0f;
+    DepthKernel(&t.cdepth[1], &t.cflux[0], n, dt / (water.cellSize * WATER_LOD_FACTOR));
+    SurfaceKernel(&t.cbed[1], &t.cdepth[1], &t.ceta[1], n);
+}
+
+// Fine to coarse: mean bed and depth per coarse cell (volume is kept exactly), velocity sampled
+// on the faces the two grids share
+static void CoarsenTile(WaterTile& t)
+{
+    const int n = t.cellCount / WATER_LOD_FACTOR;
+    size_t padded = (size_t)n + 2 + WATER_PADDING;
+    t.cbed.assign(padded, 0.0f);
+    t.cdepth.assign(padded, 0.0f);
+    t.ceta.assign(padded, 0.0f);
+    t.cflow.assign(padded, 0.0f);
+    t.cflux.assign(padded, 0.0f);
+    for (int k = 1; k <= n; ++k)
+    {
+        float bed = 0.0f;
+        float depth = 0.0f;
+        for (int m = 1; m <= WATER_LOD_FACTOR; ++m)
+        {
+            bed += t.bed[(k - 1) * WATER_LOD_FACTOR + m];
+            depth += t.depth[(k - 1) * WATER_LOD_FACTOR + m];
+        }
+        t.cbed[k] = bed / WATER_LOD_FACTOR;
+        t.cdepth[k] = depth / WATER_LOD_FACTOR;
+        t.ceta[k] = t.cbed[k] + t.cdepth[k];
+        t.cflow[k] = t.flow[k * WATER_LOD_FACTOR];
+    }
+    t.cflow[0] = t.flow[0];
+    t.coarse = true;
+}
+
+// Coarse to fine: a flat surface over the fine bed, rescaled so each coarse cell's volume is kept
+// exactly, and velocity interpolated between the coarse faces
+static void RefineTile(WaterTile& t)
+{
+    const int n = t.cellCount / WATER_LOD_FACTOR;
+    for (int k = 1; k <= n; ++k)
+    {
+        int base = (k - 1) * WATER_LOD_FACTOR;
+        float sum = 0.0f;
+        for (int m = 1; m <= WATER_LOD_FACTOR; ++m)
+        {
+            float h = max(0.0f, t.ceta[k] - t.bed[base + m]);
+            t.depth[base + m] = h;
+            sum += h;
+        }
+        float scale = (sum > 0.0f) ? t.cdepth[k] * WATER_LOD_FACTOR / sum : 0.0f;
+        for (int m = 1; m <= WATER_LOD_FACTOR; ++m)
+        {
+            t.depth[base + m] *= scale;
+            t.eta[base + m] = t.bed[base + m] + t.depth[base + m];
+            float f = (float)m / WATER_LOD_FACTOR;
+            t.flow[base + m] = t.cflow[k - 1] + (t.cflow[k] - t.cflow[k - 1]) * f;
+        }
+    }
+    t.flow[0] = t.cflow[0];
+    t.coarse = false;
+    t.cbed.clear();
+    t.cdepth.clear();
+    t.ceta.clear();
+    t.cflow.clear();
+    t.cflux.clear();
+}
+
+void SetShallowWaterFocus(ShallowWater& water, float x0, float x1)
+{
+    water.focusX0 = x0;
+    water.focusX1 = x1;
+}
+
+// Between coarse steps only, when no banked volume is pending: refine tiles near the focus or
+// holding a dam and its scour reach, coarsen tiles that moved well away from it
+static void UpdateTileLod(ShallowWater& water)
+{
+    water.coarseTiles = 0;
+    for (WaterTile& t : water.tiles)
+    {
+        float x0 = water.originX + (float)t.firstCell * water.cellSize;
+        float x1 = x0 + (float)t.cellCount * water.cellSize;
+        float distance = max(0.0f, max(water.focusX0 - x1, x0 - water.focusX1));
+        bool pinned = (t.cellCount % WATER_LOD_FACTOR) != 0;
+        for (const WaterDam& d : water.dams)
+        {
+            pinned = pinned || (d.face + 1 + WATER_DAM_SCOUR_CELLS >= t.firstCell && d.face < t.firstCell + t.cellCount);
+        }
+
+        if (t.coarse && (pinned || distance <= WATER_LOD_MARGIN)) RefineTile(t);
+        else if (!t.coarse && !pinned && distance > 2.0f * WATER_LOD_MARGIN) CoarsenTile(t);
+        if (t.coarse) water.coarseTiles++;
+    }
+}
+
+void StepShallowWater(ShallowWater& water)
+{
+    const int tiles = (int)water.tiles.size();
+    JobSystem* jobs = (water.cellCount >= WATER_PARALLEL_MIN_CELLS) ? water.jobs : nullptr;
+    if (water.tickCount % WATER_LOD_FACTOR == 0) UpdateTileLod(water);
+    const bool coarseStep = (water.tickCount % WATER_LOD_FACTOR) == WATER_LOD_FACTOR - 1;
+
+    ParallelFor(jobs, tiles, [&](int i) { TileSources(water, i, coarseStep); });
+    ParallelFor(jobs, tiles, [&](int i) { TileFlow(water, i, coarseStep); });
+    if (water.coarseTiles > 0) StepLodInterfaces(water);
+    if (!water.dams.empty()) StepDams(water, WATER_TICK);
+    ParallelFor(jobs, tiles, [&](int i) { TileDepth(water, i, coarseStep); });
+    water.simTime += WATER_TICK;
+    water.tickCount++;
+}
+
+int AdvanceShallowWater(ShallowWater& water, float frameDt)
+{
+    auto start = chrono::high_resolution_clock::now();
+
+    water.accumulator += frameDt;
+    int ticks = 0;
+    while (water.accumulator >= WATER_TICK && ticks < WATER_MAX_TICKS_PER_FRAME)
+    {
+        StepShallowWater(water);
+        water.accumulator -= WATER_TICK;
+        ticks++;
+    }
+    // Drop time we could not catch up on instead of spiralling
+    if (ticks == WATER_MAX_TICKS_PER_FRAME) water.accumulator = min(water.accumulator, WATER_TICK);
+
+    water.lastUpdateMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+    return ticks;
+}
+
+// Face velocity is stored by the tile owning the face's left cell; none while that tile is coarse
+static float* FaceVelocity(ShallowWater& water, int face)
+{
+    if (face < 0 || face >= water.cellCount - 1) return nullptr;
+    int local;
+    WaterTile& t = TileOf(water, face, local);
+    return t.coarse ? nullptr : &t.flow[local];
+}
+
+void SplashShallowWater(ShallowWater& water, float x, float radius, float strength)
+{
+    int center = WaterCellAt(water, x);
+    int reach = max(1, (int)(radius / water.cellSize));
+    const float maxU = 0.5f * water.cellSize / WATER_TICK;
+
+    // Outward velocity on the faces either side of the impact, fading with distance
+    for (int k = 0; k < reach; ++k)
+    {
+        float falloff = 1.0f - (float)k / (float)reach;
+        float* right = FaceVelocity(water, center + k);
+        float* left = FaceVelocity(water, center - 1 - k);
+        if (right != nullptr) *right = min(maxU, *right + strength * falloff);
+        if (left != nullptr) *left = max(-maxU, *left - strength * falloff);
+    }
+}
+
+double ExchangeShallowWater(ShallowWater& water, float x0, float x1, float depth)
+{
+    int first = WaterCellAt(water, x0);
+    int last = WaterCellAt(water, x1);
+    double exchanged = 0.0;
+    for (int c = first; c <= last; ++c)
+    {
+        int local;
+        WaterTile& t = TileOf(water, c, local);
+        if (t.coarse)
+        {
+            // The fine cell's share of its coarse cell
+            int k = (local - 1) / WATER_LOD_FACTOR + 1;
+            float h = max(0.0f, t.cdepth[k] + depth / WATER_LOD_FACTOR);
+            exchanged += (h - t.cdepth[k]) * WATER_LOD_FACTOR;
+            t.cdepth[k] = h;
+            t.ceta[k] = t.cbed[k] + h;
+            continue;
+        }
+        float h = max(0.0f, t.depth[local] + depth);
+        exchanged += h - t.depth[local];
+        t.depth[local] = h;
+        t.eta[local] = t.bed[local] + h;
+    }
+    return exchanged * water.cellSize;
+}
+
+float GetWaterCellDepth(const ShallowWater& water, int cell)
+{
+    int local;
+    const WaterTile& t = TileOf(water, cell, local);
+    return CellDepth(t, local);
+}
+
+float GetWaterCellSurface(const ShallowWater& water, int cell)
+{
+    int local;
+    const WaterTile& t = TileOf(water, cell, local);
+    return t.coarse ? t.bed[local] + CellDepth(t, local) : t.eta[local];
+}
+
+float GetWaterCellBed(const ShallowWater& water, int cell)
+{
+    int local;
+    const WaterTile& t = TileOf(water, cell, local);
+    return t.bed[local];
+}
+
+float GetWaterFaceVelocity(const ShallowWater& water, int face)
+{
+    if (face < 0 || face >= water.cellCount - 1) return 0.0f;
+    int local;
+    const WaterTile& t = TileOf(water, face, local);
+    if (!t.coarse) return t.flow[local];
+
+    // Interpolated between the coarse faces either side of the fine face
+    int k = (local - 1) / WATER_LOD_FACTOR + 1;
+    float f = (float)((local - 1) % WATER_LOD_FACTOR + 1) / WATER_LOD_FACTOR;
+    return t.cflow[k - 1] + (t.cflow[k] - t.cflow[k - 1]) * f;
+}
+
+float GetWaterSurfaceAt(const ShallowWater& water, float x)
+{
+    return GetWaterCellSurface(water, WaterCellAt(water, x));
+}
+
+float GetWaterDepthAt(const ShallowWater& water, float x)
+{
+    return GetWaterCellDepth(water, WaterCellAt(water, x));
+}
+
+double GetWaterVolume(const ShallowWater& water, float x0, float x1)
+{
+    int first = WaterCellAt(water, x0);
+    int last = WaterCellAt(water, x1);
+    double v = 0.0;
+    for (int c = first; c <= last; ++c) v += GetWaterCellDepth(water, c);
+    return v * water.cellSize;
+}
+
+float GetWaterMeanLevel(const ShallowWater& water, float x0, float x1)
+{
+    int first = WaterCellAt(water, x0);
+    int last = WaterCellAt(water, x1);
+    double sum = 0.0;
+    int wet = 0;
+    for (int c = first; c <= last; ++c)
+    {
+        if (GetWaterCellDepth(water, c) <= WATER_DRY_EPS) continue;
+        sum += GetWaterCellSurface(water, c);
+        wet++;
+    }
+    return wet > 0 ? (float)(sum / wet) : 0.0f;
+}
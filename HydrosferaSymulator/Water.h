@@ -0,0 +1,165 @@
+#pragma once
+
+#include <vector>
+
+struct JobSystem;
+
+// 1D shallow-water layer running along the ground strip. Heights are in pixels above
+// the channel datum (WATER_CHANNEL_DEPTH below the ground line), x in world pixels.
+const float WATER_CELL_SIZE = 4.0f;
+const float WATER_TICK = 1.0f / 120.0f;
+const int WATER_MAX_TICKS_PER_FRAME = 4;
+const float WATER_GRAVITY = 980.0f;       // px/s^2, wave speed sqrt(g*h) ~ 200 px/s at 40 px depth
+const float WATER_DAMPING = 0.998f;       // per-tick velocity damping
+const float WATER_DRY_EPS = 0.01f;        // depth below which a face carries no flow
+const float WATER_CHANNEL_DEPTH = 48.0f;  // datum depth below the ground line
+const int WATER_TILE_CELLS = 128;         // fixed tile size, independent of the thread count
+const int WATER_PARALLEL_MIN_CELLS = 8192; // smaller grids step inline, the pool would only add overhead
+const int WATER_LOD_FACTOR = 4;           // coarse cells are this many fine cells wide and step this many times less often
+const float WATER_LOD_MARGIN = 512.0f;    // px around the focus kept at full resolution; tiles coarsen at twice that
+
+// Source / sink acting on a range of cells. rate is depth change in px/s (negative drains);
+// targetLevel >= 0 instead relaxes the surface towards that level (open sea boundary).
+struct WaterRegion
+{
+    float x0;
+    float x1;
+    float rate;
+    float targetLevel;
+    bool active;
+};
+
+// Dam on the face between cell 'face' and the next one. The momentum update treats the face as
+// a wall; its flux is set instead by the turbines and the spillway from the forebay level. The
+// reservoir behind it is handled as a level pool: storage comes from a stage-storage table built
+// when dams change, inflow from the continuity balance, so nothing loops over the pool's cells.
+const int WATER_MAX_DAMS = 4;
+const float WATER_DAM_TABLE_STEP = 1.0f;        // px between stage-storage rows
+const float WATER_DAM_TABLE_HEADROOM = 16.0f;   // table rows above the crest
+const float WATER_DAM_SPILLWAY_COEFF = 17.7f;   // (2/3) Cd sqrt(2g), broad-crested weir per unit width
+const float WATER_DAM_POOL_SMOOTHING = 1.0f;    // s, pool level averaged over surface waves
+const float WATER_DAM_TURBINE_EFFICIENCY = 0.9f;
+const float WATER_SEDIMENT_CONCENTRATION = 0.02f; // suspended load of the natural river, volume fraction
+const float WATER_DAM_SETTLING_TIME = 30.0f;    // s of residence that trap half of the load
+const int WATER_DAM_SCOUR_CELLS = 32;           // reach below the dam eroded by sediment-starved water
+const float WATER_DAM_MAX_SCOUR = 8.0f;         // px the bed may drop below its original height
+
+struct WaterDam
+{
+    int face;
+    float crest;            // spillway crest, surface height above the datum
+    float intakeLevel;      // turbines start below this level and reach full flow at the crest
+    float turbineCapacity;  // px^2/s
+
+    std::vector<float> storageTable;  // pool volume per WATER_DAM_TABLE_STEP of level from the datum
+    std::vector<float> tailBed;       // original bed of the scour reach
+
+    float poolLevel;
+    float poolStorage;
+    float inflow;           // px^2/s, from the pool's storage change plus the release
+    float turbineFlow;
+    float spillFlow;
+    float power;            // Q * head * efficiency, px^4/s; the caller picks a display unit
+    float trapEfficiency;   // share of the incoming sediment settling in the pool
+    double trappedSediment; // volume settled in the pool since the dam was built
+    double scouredSediment; // volume eroded from the bed below the dam
+};
+
+// A contiguous run of cells updated by one job. Cell arrays hold one halo cell on each side:
+// index 0 mirrors the left neighbour's last cell, cellCount + 1 the right neighbour's first.
+// Face f sits between local cells f and f + 1; the tile owns faces 1..cellCount and copies
+// face 0 from its left neighbour.
+struct WaterTile
+{
+    int firstCell;
+    int cellCount;
+    std::vector<float> bed;
+    std::vector<float> depth;
+    std::vector<float> eta;   // free surface = bed + depth
+    std::vector<float> flow;  // face velocity, px/s
+    std::vector<float> flux;  // face volume flux
+
+    // Level of detail. A coarse tile steps the c* arrays (same layout, WATER_LOD_FACTOR fine
+    // cells per coarse cell) once every WATER_LOD_FACTOR ticks. The fine bed stays as reference,
+    // fine depth, surface and velocity are read through the coarse cells. Faces shared with a
+    // fine neighbour run at the fine rate and their volume is banked in the registers until the
+    // coarse step takes it, so nothing is lost across the boundary.
+    bool coarse;
+    std::vector<float> cbed;
+    std::vector<float> cdepth;
+    std::vector<float> ceta;
+    std::vector<float> cflow;
+    std::vector<float> cflux;
+    float leftRegister;
+    float rightRegister;
+};
+
+struct ShallowWater
+{
+    int cellCount;
+    float originX;
+    float cellSize;
+    std::vector<WaterTile> tiles;
+    std::vector<WaterRegion> regions;
+    std::vector<WaterDam> dams;
+
+    // Optional pool, tiles run inline when null. Every tile writes only its own cells and reads
+    // its neighbours through the halo copy after a barrier, so the result is bit-identical
+    // regardless of thread count or scheduling.
+    JobSystem* jobs;
+
+    // Full resolution around [focusX0, focusX1], coarse elsewhere
+    float focusX0;
+    float focusX1;
+    int coarseTiles;
+
+    float accumulator;
+    double simTime;
+    long long tickCount;
+    float lastUpdateMs;       // wall time spent in the last AdvanceShallowWater call
+};
+
+ShallowWater CreateShallowWater(float originX, float width, float cellSize, JobSystem* jobs = nullptr);
+
+// Set the bed from a height profile callback and fill every cell up to 'level'
+void InitShallowWaterBed(ShallowWater& water, float (*bedAt)(float x), float level);
+
+int AddWaterRegion(ShallowWater& water, float x0, float x1, float rate, float targetLevel = -1.0f);
+
+// Build a dam at x; returns its index, or -1 when x is too close to the world edge or
+// WATER_MAX_DAMS already stand
+int AddWaterDam(ShallowWater& water, float x, float crest, float intakeLevel, float turbineCapacity);
+void RemoveWaterDam(ShallowWater& water, int index);
+float GetWaterDamX(const ShallowWater& water, int index);
+
+// Pool volume of a dam at a given level, from its stage-storage table
+float GetWaterDamStorage(const WaterDam& dam, float level);
+
+// Keep the solver at full resolution around [x0, x1] (the view) and coarsen tiles far from it.
+// Changes take effect at the next coarse step boundary.
+void SetShallowWaterFocus(ShallowWater& water, float x0, float x1);
+
+// One fixed WATER_TICK step
+void StepShallowWater(ShallowWater& water);
+
+// Run as many fixed ticks as frameDt covers (capped), returns the number of ticks taken
+int AdvanceShallowWater(ShallowWater& water, float frameDt);
+
+// Push water away from x, e.g. when the cat lands in it. Volume is unchanged.
+void SplashShallowWater(ShallowWater& water, float x, float radius, float strength);
+
+// Add depth (px, negative removes) to every cell in [x0, x1]; removal stops at dry cells.
+// Returns the volume actually exchanged.
+double ExchangeShallowWater(ShallowWater& water, float x0, float x1, float depth);
+
+// Global cell access (cell index in [0, cellCount))
+int WaterCellAt(const ShallowWater& water, float x);
+float GetWaterCellDepth(const ShallowWater& water, int cell);
+float GetWaterCellSurface(const ShallowWater& water, int cell);
+float GetWaterCellBed(const ShallowWater& water, int cell);
+float GetWaterFaceVelocity(const ShallowWater& water, int face); // face between cell and cell + 1
+
+float GetWaterSurfaceAt(const ShallowWater& water, float x);
+float GetWaterDepthAt(const ShallowWater& water, float x);
+double GetWaterVolume(const ShallowWater& water, float x0, float x1);
+float GetWaterMeanLevel(const ShallowWater& water, float x0, float x1);
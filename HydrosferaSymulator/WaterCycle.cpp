@@ -0,0 +1,256 @@
+#include "WaterCycle.h"
+#include "Water.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+static const float PI_F = 3.14159265f;
+
+static void ResizeState(WaterCycleState& s, int columns)
+{
+    s.vapor.assign(columns, 0.0f);
+    s.cloud.assign(columns, 0.0f);
+    s.soil.assign(columns, 0.0f);
+    s.surface.assign(columns, 0.0f);
+}
+
+WaterCycle CreateWaterCycle(float originX, float width, float segmentWidth, const vector<WaterCycleClimate>& climates)
+{
+    WaterCycle c;
+    c.columns = max(1, (int)ceilf(width / WATER_CYCLE_COLUMN_WIDTH));
+    c.originX = originX;
+    c.columnWidth = WATER_CYCLE_COLUMN_WIDTH;
+    c.climates = climates;
+    if (c.climates.empty()) c.climates.push_back({ 15.0f, 10.0f, 0.15f, 0.5f, 0.1f, 2.0f, 100.0f, 0.05f });
+
+    const int biomes = (int)c.climates.size();
+    c.columnBiome.resize(c.columns);
+    c.biomeColumns.assign(biomes, 0);
+    for (int i = 0; i < c.columns; ++i)
+    {
+        int b = (int)((float)i * c.columnWidth / segmentWidth);
+        c.columnBiome[i] = max(0, min(b, biomes - 1));
+        c.biomeColumns[c.columnBiome[i]]++;
+    }
+
+    ResizeState(c.current, c.columns);
+    ResizeState(c.next, c.columns);
+    for (int i = 0; i < c.columns; ++i)
+    {
+        const WaterCycleClimate& k = c.climates[c.columnBiome[i]];
+        c.current.vapor[i] = WATER_CYCLE_OCEAN_VAPOR * 0.5f;
+        c.current.soil[i] = k.soilCapacity * 0.5f;
+    }
+
+    c.sampledSurface.assign(c.columns, 0.0f);
+    c.stepPrecipitation.assign(c.columns, 0.0f);
+    c.stepEvaporation.assign(c.columns, 0.0f);
+    c.stepRunoff.assign(c.columns, 0.0f);
+    c.precipitationRate.assign(c.columns, 0.0f);
+    c.totals.resize(biomes);
+    ResetWaterCycleTotals(c);
+
+    c.sweepColumn = 0;
+    c.columnBudget = 0.0f;
+    c.hours = 0.0;
+    c.discharge = 0.0;
+    c.lastUpdateMs = 0.0f;
+    return c;
+}
+
+void ResetWaterCycleTotals(WaterCycle& cycle)
+{
+    for (WaterCycleTotals& t : cycle.totals) t = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+}
+
+// Vapour the air column holds before condensing, roughly doubling every 12 deg C
+static inline float SaturationVapor(float temperature)
+{
+    return 20.0f * expf(0.06f * (temperature - 15.0f));
+}
+
+// Semi-Lagrangian upwind sample of an air quantity; air from outside the world is ocean air
+static inline float Advect(const vector<float>& q, int columns, float departure, float inflow)
+{
+    if (departure < 0.0f || departure > (float)(columns - 1)) return inflow;
+    int i0 = (int)departure;
+    int i1 = min(i0 + 1, columns - 1);
+    float f = departure - (float)i0;
+    return q[i0] + (q[i1] - q[i0]) * f;
+}
+
+static void StepColumns(WaterCycle& c, int first, int count, bool routing)
+{
+    const float dt = WATER_CYCLE_STEP_HOURS;
+    const float season = sinf(2.0f * PI_F * (float)fmod(c.hours / WATER_CYCLE_HOURS_PER_YEAR, 1.0));
+    const WaterCycleState& cur = c.current;
+    WaterCycleState& nxt = c.next;
+
+    for (int i = first; i < first + count; ++i)
+    {
+        const WaterCycleClimate& k = c.climates[c.columnBiome[i]];
+        const float temperature = k.temperature + 0.5f * k.seasonalRange * season;
+
+        // Wind carries vapour and clouds
+        float departure = (float)i - k.wind * dt;
+        float vapor = Advect(cur.vapor, c.columns, departure, WATER_CYCLE_OCEAN_VAPOR);
+        float cloud = Advect(cur.cloud, c.columns, departure, 0.0f);
+        float soil = cur.soil[i];
+        float surface = cur.surface[i];
+
+        // Surface water flows downstream (+x) towards the sea; the last column drains off the edge
+        if (routing)
+        {
+            float share = min(1.0f, k.routing * dt);
+            float out = surface * share;
+            surface -= out;
+            if (i > 0) surface += cur.surface[i - 1] * min(1.0f, c.climates[c.columnBiome[i - 1]].routing * dt);
+            if (i == c.columns - 1) c.discharge += out;
+        }
+
+        // Evaporation from open water first, then transpiration from the soil
+        float demand = k.evaporation * expf(0.06f * (temperature - 20.0f)) * dt;
+        float fromSurface = min(surface, demand);
+        float fromSoil = min(soil, (demand - fromSurface) * 0.5f * soil / max(1.0f, k.soilCapacity));
+        surface -= fromSurface;
+        soil -= fromSoil;
+        vapor += fromSurface + fromSoil;
+
+        // Condensation above saturation, rain once the cloud is heavy enough
+        float excessVapor = vapor - SaturationVapor(temperature);
+        if (excessVapor > 0.0f)
+        {
+            float condensed = excessVapor * min(1.0f, 0.5f * dt);
+            vapor -= condensed;
+            cloud += condensed;
+        }
+        float rain = 0.0f;
+        if (cloud > k.cloudThreshold) rain = min(cloud, (cloud - k.cloudThreshold) * k.precipitation * dt);
+        cloud -= rain;
+
+        // Rain soaks into the soil, the excess runs off into the rivers
+        soil += rain;
+        float runoff = max(0.0f, soil - k.soilCapacity);
+        soil -= runoff;
+        surface += runoff;
+
+        nxt.vapor[i] = vapor;
+        nxt.cloud[i] = cloud;
+        nxt.soil[i] = soil;
+        nxt.surface[i] = surface;
+        c.stepPrecipitation[i] = rain;
+        c.stepEvaporation[i] = fromSurface + fromSoil;
+        c.stepRunoff[i] = runoff;
+    }
+}
+
+static void BeginSweep(WaterCycle& c, const ShallowWater* water)
+{
+    c.discharge = 0.0;
+    if (water == nullptr) return;
+
+    // The water layer is the surface store while attached
+    for (int i = 0; i < c.columns; ++i)
+    {
+        float x0 = c.originX + (float)i * c.columnWidth;
+        double volume = GetWaterVolume(*water, x0, x0 + c.columnWidth - water->cellSize);
+        float depth = (float)(volume / c.columnWidth);
+        c.sampledSurface[i] = depth * WATER_CYCLE_MM_PER_PX;
+        c.current.surface[i] = c.sampledSurface[i];
+    }
+}
+
+static void CommitSweep(WaterCycle& c, ShallowWater* water)
+{
+    for (int i = 0; i < c.columns; ++i)
+    {
+        WaterCycleTotals& t = c.totals[c.columnBiome[i]];
+        t.precipitation += c.stepPrecipitation[i];
+        t.evaporation += c.stepEvaporation[i];
+        t.runoff += c.stepRunoff[i];
+        c.precipitationRate[i] = c.stepPrecipitation[i] / WATER_CYCLE_STEP_HOURS;
+
+        if (water != nullptr)
+        {
+            float delta = c.next.surface[i] - c.sampledSurface[i];
+            float x0 = c.originX + (float)i * c.columnWidth;
+            if (delta != 0.0f) ExchangeShallowWater(*water, x0, x0 + c.columnWidth - water->cellSize, delta / WATER_CYCLE_MM_PER_PX);
+        }
+    }
+    c.totals[c.columnBiome[c.columns - 1]].discharge += c.discharge;
+    for (WaterCycleTotals& t : c.totals) t.hours += WATER_CYCLE_STEP_HOURS;
+
+    swap(c.current, c.next);
+    c.hours += WATER_CYCLE_STEP_HOURS;
+}
+
+void UpdateWaterCycle(WaterCycle& cycle, float dt, ShallowWater* water)
+{
+    auto start = chrono::high_resolution_clock::now();
+
+    // Owed columns beyond one slice are dropped, a long frame slows the cycle instead of hitching
+    cycle.columnBudget += dt * WATER_CYCLE_STEPS_PER_SECOND * (float)cycle.columns;
+    cycle.columnBudget = min(cycle.columnBudget, (float)WATER_CYCLE_MAX_COLUMNS_PER_FRAME);
+
+    while (cycle.columnBudget >= 1.0f)
+    {
+        if (cycle.sweepColumn == 0) BeginSweep(cycle, water);
+
+        int n = min(cycle.columns - cycle.sweepColumn, (int)cycle.columnBudget);
+        StepColumns(cycle, cycle.sweepColumn, n, water == nullptr);
+        cycle.sweepColumn += n;
+        cycle.columnBudget -= (float)n;
+
+        if (cycle.sweepColumn == cycle.columns)
+        {
+            CommitSweep(cycle, water);
+            cycle.sweepColumn = 0;
+        }
+    }
+
+    cycle.lastUpdateMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+void FastForwardWaterCycle(WaterCycle& cycle, double hours)
+{
+    // Finish a sweep left half done by the interactive pace first
+    if (cycle.sweepColumn != 0)
+    {
+        StepColumns(cycle, cycle.sweepColumn, cycle.columns - cycle.sweepColumn, true);
+        CommitSweep(cycle, nullptr);
+        cycle.sweepColumn = 0;
+    }
+
+    double end = cycle.hours + hours;
+    while (cycle.hours < end)
+    {
+        BeginSweep(cycle, nullptr);
+        StepColumns(cycle, 0, cycle.columns, true);
+        CommitSweep(cycle, nullptr);
+    }
+}
+
+float GetWaterCyclePrecipitation(const WaterCycle& cycle, float x0, float x1)
+{
+    int first = max(0, (int)floorf((x0 - cycle.originX) / cycle.columnWidth));
+    int last = min(cycle.columns - 1, (int)floorf((x1 - cycle.originX) / cycle.columnWidth));
+    if (last < first) return 0.0f;
+
+    float sum = 0.0f;
+    for (int i = first; i <= last; ++i) sum += cycle.precipitationRate[i];
+    return sum / (float)(last - first + 1);
+}
+
+float GetWaterCycleStorage(const WaterCycle& cycle, int biome)
+{
+    if (biome < 0 || biome >= (int)cycle.biomeColumns.size() || cycle.biomeColumns[biome] == 0) return 0.0f;
+
+    float sum = 0.0f;
+    for (int i = 0; i < cycle.columns; ++i)
+    {
+        if (cycle.columnBiome[i] == biome) sum += cycle.current.soil[i] + cycle.current.surface[i];
+    }
+    return sum / (float)cycle.biomeColumns[biome];
+}
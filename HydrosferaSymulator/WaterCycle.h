@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+
+struct ShallowWater;
+
+// Coarse water-cycle model over the biome segments: one column of air and soil per
+// WATER_CYCLE_COLUMN_WIDTH px. Water amounts are in mm, time in simulated hours.
+const float WATER_CYCLE_COLUMN_WIDTH = 64.0f;
+const float WATER_CYCLE_STEP_HOURS = 1.0f;          // simulated time covered by one full sweep
+const float WATER_CYCLE_STEPS_PER_SECOND = 6.0f;    // interactive pace, a simulated day every 4 s
+const int WATER_CYCLE_MAX_COLUMNS_PER_FRAME = 32;   // slice bound, keeps the per-frame cost flat
+const float WATER_CYCLE_MM_PER_PX = 40.0f;          // shallow-water depth conversion, 1 px of river = 40 mm over its column
+const float WATER_CYCLE_OCEAN_VAPOR = 22.0f;        // moist air blown in across both world edges
+const float WATER_CYCLE_HOURS_PER_YEAR = 8760.0f;
+
+struct WaterCycleClimate
+{
+    float temperature;     // mean deg C, scales evaporation and how much vapour the air holds
+    float seasonalRange;   // deg C between the coldest and warmest day of the year
+    float evaporation;     // open-water evaporation at 20 deg C, mm/h
+    float wind;            // columns per hour, positive blows towards +x
+    float precipitation;   // fraction of cloud water above the threshold falling per hour
+    float cloudThreshold;  // mm of cloud water before it rains
+    float soilCapacity;    // mm the soil holds before excess runs off
+    float routing;         // fraction of surface water flowing to the next column per hour (standalone)
+};
+
+// Per-column state, struct of arrays
+struct WaterCycleState
+{
+    std::vector<float> vapor;
+    std::vector<float> cloud;
+    std::vector<float> soil;
+    std::vector<float> surface;  // rivers and lakes; mirrors the shallow-water layer when one is attached
+};
+
+// Fluxes accumulated per biome since the last reset, mm summed over the biome's columns
+struct WaterCycleTotals
+{
+    double precipitation;
+    double evaporation;
+    double runoff;
+    double discharge;  // surface water leaving the world at the edges (standalone routing)
+    double hours;
+};
+
+struct WaterCycle
+{
+    int columns;
+    float originX;
+    float columnWidth;
+    std::vector<int> columnBiome;
+    std::vector<int> biomeColumns;              // column count per biome, for averages
+    std::vector<WaterCycleClimate> climates;    // one per biome
+
+    // A sweep reads 'current' and writes 'next' column by column, so it can be split over
+    // frames; the two swap once the last column is done
+    WaterCycleState current;
+    WaterCycleState next;
+    std::vector<float> sampledSurface;          // shallow-water surface read at the sweep start
+    std::vector<float> stepPrecipitation;       // mm fallen per column in the sweep in progress
+    std::vector<float> stepEvaporation;
+    std::vector<float> stepRunoff;
+    std::vector<float> precipitationRate;       // mm/h per column from the last completed sweep
+    std::vector<WaterCycleTotals> totals;       // per biome
+
+    int sweepColumn;    // next column of the sweep in progress
+    float columnBudget; // columns owed to the interactive pace
+    double hours;       // simulated time of the last completed sweep
+    double discharge;   // edge outflow of the sweep in progress
+    float lastUpdateMs;
+};
+
+// Columns take the climate of the biome segment (segmentWidth px each) they start in
+WaterCycle CreateWaterCycle(float originX, float width, float segmentWidth, const std::vector<WaterCycleClimate>& climates);
+
+// Advance at the interactive pace, at most WATER_CYCLE_MAX_COLUMNS_PER_FRAME columns per call.
+// With a water layer attached, evaporation and runoff are exchanged with it and its own flow
+// replaces the model's routing.
+void UpdateWaterCycle(WaterCycle& cycle, float dt, ShallowWater* water);
+
+// Run whole sweeps back to back without a water layer (headless fast-forward)
+void FastForwardWaterCycle(WaterCycle& cycle, double hours);
+
+void ResetWaterCycleTotals(WaterCycle& cycle);
+
+// Mean precipitation rate over [x0, x1], mm/h
+float GetWaterCyclePrecipitation(const WaterCycle& cycle, float x0, float x1);
+
+// Mean stored water (soil + surface) of a biome, mm
+float GetWaterCycleStorage(const WaterCycle& cycle, int biome);
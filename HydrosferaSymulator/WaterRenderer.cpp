@@ -0,0 +1,211 @@
+#include "WaterRenderer.h"
+#include "Water.h"
+#include "Pollution.h"
+#include "GpuQuad.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+using namespace std;
+
+static const char* WATER_VS =
+    "#version 330\n"
+    "layout(location = 0) in vec2 position;\n"
+    "layout(location = 1) in vec3 params;\n"
+    "uniform mat4 mvp;\n"
+    "out vec2 worldPos;\n"
+    "out float below;\n"
+    "out float surfaceY;\n"
+    "out float pollution;\n"
+    "void main()\n"
+    "{\n"
+    "    worldPos = position;\n"
+    "    below = params.x;\n"
+    "    surfaceY = params.y;\n"
+    "    pollution = params.z;\n"
+    "    gl_Position = mvp*vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+// Light is absorbed with depth (Beer-Lambert tint from the shallow to the deep colour); near the
+// surface the backdrop mirrored about the surface line shows through, rippled a little
+static const char* WATER_FS =
+    "#version 330\n"
+    "in vec2 worldPos;\n"
+    "in float below;\n"
+    "in float surfaceY;\n"
+    "in float pollution;\n"
+    "uniform mat4 mvp;\n"
+    "uniform sampler2D sky;\n"
+    "uniform float skyScroll;\n"
+    "uniform float skyScale;\n"
+    "uniform float reflectivity;\n"
+    "uniform float time;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    float absorbed = 1.0 - exp(-below/18.0);\n"
+    "    vec3 color = mix(vec3(0.35, 0.65, 0.95), vec3(0.05, 0.20, 0.45), absorbed);\n"
+    "    float alpha = mix(0.45, 0.85, absorbed);\n"
+    "    vec2 mirrored = vec2(worldPos.x + sin(worldPos.y*0.35 + time*3.0)*1.5, 2.0*surfaceY - worldPos.y);\n"
+    "    vec4 clip = mvp*vec4(mirrored, 0.0, 1.0);\n"
+    "    vec2 screen = vec2(clip.x/clip.w*0.5 + 0.5, 0.5 - clip.y/clip.w*0.5);\n"
+    "    vec3 reflected = texture(sky, vec2(screen.x*skyScale + skyScroll, 1.0 - screen.y)).rgb;\n"
+    "    color = mix(color, reflected, reflectivity*exp(-below/10.0));\n"
+    "    color = mix(color, vec3(0.43, 0.31, 0.12), clamp(pollution, 0.0, 1.0)*0.7);\n"
+    "    if (below < 1.0) { color = mix(color, vec3(1.0), 0.5); alpha = 0.9; }\n"
+    "    finalColor = vec4(color, alpha);\n"
+    "}\n";
+
+static const float WATER_REFLECTIVITY = 0.45f;
+
+WaterRenderer CreateWaterRenderer(int maxEdges)
+{
+    WaterRenderer wr;
+    wr.maxEdges = max(2, min(maxEdges, WATER_RENDER_MAX_EDGES));
+    wr.vertices.resize(2 * wr.maxEdges);
+    wr.edgeCount = 0;
+    wr.vao = wr.vbo = wr.ebo = 0;
+    wr.locMvp = wr.locSky = wr.locSkyScroll = wr.locSkyScale = wr.locReflectivity = wr.locTime = -1;
+    wr.lastUploadMs = 0.0f;
+    wr.lastDrawMs = 0.0f;
+
+    wr.shader = LoadShaderFromMemory(WATER_VS, WATER_FS);
+    wr.hasShader = (wr.shader.id != 0 && wr.shader.id != rlGetShaderIdDefault());
+    if (!wr.hasShader)
+    {
+        TraceLog(LOG_WARNING, "WATER: shader unavailable, the water mesh falls back to the immediate-mode batch");
+        return wr;
+    }
+    wr.locMvp = GetShaderLocation(wr.shader, "mvp");
+    wr.locSky = GetShaderLocation(wr.shader, "sky");
+    wr.locSkyScroll = GetShaderLocation(wr.shader, "skyScroll");
+    wr.locSkyScale = GetShaderLocation(wr.shader, "skyScale");
+    wr.locReflectivity = GetShaderLocation(wr.shader, "reflectivity");
+    wr.locTime = GetShaderLocation(wr.shader, "time");
+
+    // Edge k owns vertices 2k (surface) and 2k + 1 (bed); each segment is two triangles
+    vector<unsigned short> indices(6 * (wr.maxEdges - 1));
+    for (int k = 0; k + 1 < wr.maxEdges; ++k)
+    {
+        unsigned short v = (unsigned short)(2 * k);
+        unsigned short* tri = &indices[6 * k];
+        tri[0] = v;
+        tri[1] = (unsigned short)(v + 1);
+        tri[2] = (unsigned short)(v + 2);
+        tri[3] = (unsigned short)(v + 2);
+        tri[4] = (unsigned short)(v + 1);
+        tri[5] = (unsigned short)(v + 3);
+    }
+
+    wr.vao = rlLoadVertexArray();
+    rlEnableVertexArray(wr.vao);
+    wr.vbo = rlLoadVertexBuffer(nullptr, (int)(wr.vertices.size() * sizeof(WaterVertex)), true);
+    rlSetVertexAttribute(0, 2, RL_FLOAT, false, sizeof(WaterVertex), 0);
+    rlEnableVertexAttribute(0);
+    rlSetVertexAttribute(1, 3, RL_FLOAT, false, sizeof(WaterVertex), (int)offsetof(WaterVertex, below));
+    rlEnableVertexAttribute(1);
+    wr.ebo = rlLoadVertexBufferElement(indices.data(), (int)(indices.size() * sizeof(unsigned short)), false);
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+    rlDisableVertexBufferElement();
+    return wr;
+}
+
+void UnloadWaterRenderer(WaterRenderer& wr)
+{
+    if (wr.vao != 0) rlUnloadVertexArray(wr.vao);
+    if (wr.vbo != 0) rlUnloadVertexBuffer(wr.vbo);
+    if (wr.ebo != 0) rlUnloadVertexBuffer(wr.ebo);
+    wr.vao = wr.vbo = wr.ebo = 0;
+    if (wr.hasShader) UnloadShader(wr.shader);
+    wr.hasShader = false;
+    wr.edgeCount = 0;
+}
+
+void UpdateWaterRenderer(WaterRenderer& wr, const ShallowWater& water, const PollutionField* pollution,
+                         float x0, float x1, float datumY)
+{
+    auto start = chrono::high_resolution_clock::now();
+
+    int first = WaterCellAt(water, x0);
+    int last = min(WaterCellAt(water, x1), first + wr.maxEdges - 2);
+
+    // Edge k sits on the left side of cell k; its height averages the two cells it separates
+    wr.edgeCount = 0;
+    for (int k = first; k <= last + 1; ++k)
+    {
+        int l = max(k - 1, first);
+        int r = min(k, last);
+        float bed = 0.5f * (GetWaterCellBed(water, l) + GetWaterCellBed(water, r));
+        float depth = 0.5f * (GetWaterCellDepth(water, l) + GetWaterCellDepth(water, r));
+        if (depth <= WATER_DRY_EPS) depth = 0.0f;
+        float x = water.originX + (float)k * water.cellSize;
+        float surfaceY = datumY - bed - depth;
+        float tint = (pollution != nullptr) ? GetPollutionAt(*pollution, x - water.cellSize * 0.5f, x + water.cellSize * 0.5f) : 0.0f;
+
+        WaterVertex* v = &wr.vertices[2 * wr.edgeCount];
+        v[0] = { x, surfaceY, 0.0f, surfaceY, tint };
+        v[1] = { x, datumY - bed, depth, surfaceY, tint };
+        wr.edgeCount++;
+    }
+
+    if (wr.vao != 0 && wr.edgeCount > 0)
+    {
+        rlUpdateVertexBuffer(wr.vbo, wr.vertices.data(), 2 * wr.edgeCount * (int)sizeof(WaterVertex), 0);
+    }
+
+    wr.lastUploadMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+void DrawWaterRenderer(WaterRenderer& wr, Texture2D sky, float skyScroll, float skyScale)
+{
+    if (wr.edgeCount < 2) return;
+    auto start = chrono::high_resolution_clock::now();
+
+    if (wr.vao != 0)
+    {
+        float reflectivity = (sky.id != 0) ? WATER_REFLECTIVITY : 0.0f;
+        float time = (float)GetTime();
+        int slot = 0;
+        BeginCustomDraw(wr.shader, wr.locMvp);
+        rlSetUniform(wr.locSkyScroll, &skyScroll, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(wr.locSkyScale, &skyScale, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(wr.locReflectivity, &reflectivity, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlSetUniform(wr.locTime, &time, RL_SHADER_UNIFORM_FLOAT, 1);
+        rlActiveTextureSlot(0);
+        rlEnableTexture(sky.id != 0 ? sky.id : rlGetTextureIdDefault());
+        rlSetUniform(wr.locSky, &slot, RL_SHADER_UNIFORM_INT, 1);
+
+        rlEnableVertexArray(wr.vao);
+        rlDrawVertexArrayElements(0, 6 * (wr.edgeCount - 1), 0);
+        rlDisableVertexArray();
+        rlDisableTexture();
+        rlDisableShader();
+    }
+    else
+    {
+        // Same strip through the batch, flat colours: deeper water darker, pollution browner
+        rlSetTexture(rlGetTextureIdDefault());
+        rlBegin(RL_TRIANGLES);
+        for (int k = 0; k + 1 < wr.edgeCount; ++k)
+        {
+            const WaterVertex* v = &wr.vertices[2 * k];
+            const int order[6] = { 0, 1, 2, 2, 1, 3 };
+            for (int i : order)
+            {
+                const WaterVertex& p = v[i];
+                Color c = ColorLerp(CLITERAL(Color){ 40, 110, 200, 170 }, CLITERAL(Color){ 110, 80, 30, 200 }, fminf(1.0f, p.pollution) * 0.7f);
+                if (i & 1) c = ColorBrightness(c, -0.3f);
+                rlColor4ub(c.r, c.g, c.b, c.a);
+                rlVertex2f(p.x, p.y);
+            }
+        }
+        rlEnd();
+        rlSetTexture(0);
+        rlDrawRenderBatchActive();
+    }
+
+    wr.lastDrawMs = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "raylib.h"
+#include <vector>
+
+struct ShallowWater;
+struct PollutionField;
+
+// Water surface drawn as one mesh: two vertices per cell edge in view (surface and bed), the
+// strip between them indexed as triangles, refilled into a dynamic buffer every frame
+const int WATER_RENDER_MAX_EDGES = 32767;   // 16-bit indices, two vertices per edge
+
+struct WaterVertex
+{
+    float x;
+    float y;
+    float below;      // depth under the surface at this vertex, 0 on the surface line
+    float surfaceY;   // world y of the surface above, the reflection mirrors about it
+    float pollution;
+};
+
+struct WaterRenderer
+{
+    int maxEdges;
+    std::vector<WaterVertex> vertices;
+    int edgeCount;
+
+    unsigned int vao;     // 0 when the shader is unavailable and the immediate-mode batch is used
+    unsigned int vbo;
+    unsigned int ebo;
+    Shader shader;
+    int locMvp;
+    int locSky;
+    int locSkyScroll;
+    int locSkyScale;
+    int locReflectivity;
+    int locTime;
+    bool hasShader;
+
+    float lastUploadMs;
+    float lastDrawMs;
+};
+
+// maxEdges bounds the cell edges visible at once. Needs a GL context (call after InitWindow).
+WaterRenderer CreateWaterRenderer(int maxEdges);
+void UnloadWaterRenderer(WaterRenderer& wr);
+
+// Rebuild the mesh for the cells in [x0, x1] and upload it; datumY is the world y of the channel
+// datum. Pollution tints the water when a field is given.
+void UpdateWaterRenderer(WaterRenderer& wr, const ShallowWater& water, const PollutionField* pollution,
+                         float x0, float x1, float datumY);
+
+// Draw inside BeginMode2D in one draw call. sky is the backdrop mirrored in the surface, with its
+// horizontal scroll and the screen width in texture widths (see GetParallaxSky); pass a texture
+// with id 0 for none.
+void DrawWaterRenderer(WaterRenderer& wr, Texture2D sky, float skyScroll, float skyScale);
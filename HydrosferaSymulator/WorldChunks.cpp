@@ -0,0 +1,143 @@
+#include "WorldChunks.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+StaticWorld CreateStaticWorld(float originX, float endX, int chunkWidth)
+{
+    StaticWorld world;
+    world.originX = originX;
+    world.chunkWidth = chunkWidth;
+    int count = max(1, (int)ceilf((endX - originX) / (float)chunkWidth));
+    world.chunks.resize(count);
+    for (WorldChunk& chunk : world.chunks)
+    {
+        chunk.target = { 0 };
+        chunk.bandY = 0.0f;
+        chunk.bandH = 0.0f;
+        chunk.dirty = true;
+        chunk.empty = true;
+    }
+    return world;
+}
+
+static void ReleaseChunk(WorldChunk& chunk)
+{
+    if (chunk.target.id != 0) UnloadRenderTexture(chunk.target);
+    chunk.target = { 0 };
+}
+
+void UnloadStaticWorld(StaticWorld& world)
+{
+    for (WorldChunk& chunk : world.chunks) ReleaseChunk(chunk);
+    world.props.clear();
+}
+
+static void ChunkRange(const StaticWorld& world, float minX, float maxX, int& first, int& last)
+{
+    first = max(0, (int)floorf((minX - world.originX) / (float)world.chunkWidth));
+    last = min((int)world.chunks.size() - 1, (int)floorf((maxX - world.originX) / (float)world.chunkWidth));
+}
+
+void AddStaticProp(StaticWorld& world, const Texture2D* texture, Rectangle dst, Color fallback)
+{
+    world.props.push_back({ texture, dst, fallback });
+
+    int first, last;
+    ChunkRange(world, dst.x, dst.x + dst.width, first, last);
+    for (int i = first; i <= last; ++i) world.chunks[i].dirty = true;
+}
+
+void InvalidateStaticWorld(StaticWorld& world)
+{
+    for (WorldChunk& chunk : world.chunks) chunk.dirty = true;
+}
+
+static void BakeChunk(StaticWorld& world, int index)
+{
+    WorldChunk& chunk = world.chunks[index];
+    float chunkX = world.originX + (float)(index * world.chunkWidth);
+    float chunkEnd = chunkX + (float)world.chunkWidth;
+
+    // Vertical extent of everything touching this chunk, the render texture only covers that band
+    float top = 0.0f, bottom = 0.0f;
+    bool any = false;
+    for (const StaticProp& p : world.props)
+    {
+        if (p.dst.x >= chunkEnd || p.dst.x + p.dst.width <= chunkX) continue;
+        top = any ? fminf(top, p.dst.y) : p.dst.y;
+        bottom = any ? fmaxf(bottom, p.dst.y + p.dst.height) : p.dst.y + p.dst.height;
+        any = true;
+    }
+
+    chunk.dirty = false;
+    chunk.empty = !any;
+    if (!any)
+    {
+        ReleaseChunk(chunk);
+        return;
+    }
+
+    top = floorf(top);
+    int h = (int)ceilf(bottom - top);
+    if (chunk.target.id == 0 || chunk.target.texture.height != h)
+    {
+        ReleaseChunk(chunk);
+        chunk.target = LoadRenderTexture(world.chunkWidth, h);
+    }
+    chunk.bandY = top;
+    chunk.bandH = (float)h;
+
+    // Straight-alpha props composited into a transparent target end up premultiplied:
+    // rgb uses src alpha, alpha accumulates as a + dst*(1-a)
+    BeginTextureMode(chunk.target);
+    ClearBackground(BLANK);
+    rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+    for (const StaticProp& p : world.props)
+    {
+        if (p.dst.x >= chunkEnd || p.dst.x + p.dst.width <= chunkX) continue;
+        Rectangle local = { p.dst.x - chunkX, p.dst.y - top, p.dst.width, p.dst.height };
+        if (p.texture != nullptr && p.texture->id != 0)
+        {
+            Rectangle src = { 0.0f, 0.0f, (float)p.texture->width, (float)p.texture->height };
+            DrawTexturePro(*p.texture, src, local, { 0, 0 }, 0.0f, WHITE);
+        }
+        else
+        {
+            DrawRectangleRec(local, p.fallback);
+        }
+    }
+    EndBlendMode();
+    EndTextureMode();
+}
+
+void UpdateStaticWorld(StaticWorld& world, float viewMinX, float viewMaxX)
+{
+    int first, last;
+    ChunkRange(world, viewMinX, viewMaxX, first, last);
+    for (int i = first; i <= last; ++i)
+    {
+        if (world.chunks[i].dirty) BakeChunk(world, i);
+    }
+}
+
+void DrawStaticWorld(const StaticWorld& world, float viewMinX, float viewMaxX)
+{
+    int first, last;
+    ChunkRange(world, viewMinX, viewMaxX, first, last);
+
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    for (int i = first; i <= last; ++i)
+    {
+        const WorldChunk& chunk = world.chunks[i];
+        if (chunk.empty || chunk.target.id == 0) continue;
+        float chunkX = world.originX + (float)(i * world.chunkWidth);
+        Rectangle src = { 0.0f, 0.0f, (float)chunk.target.texture.width, -(float)chunk.target.texture.height };
+        Rectangle dst = { chunkX, chunk.bandY, (float)world.chunkWidth, chunk.bandH };
+        DrawTexturePro(chunk.target.texture, src, dst, { 0, 0 }, 0.0f, WHITE);
+    }
+    EndBlendMode();
+}
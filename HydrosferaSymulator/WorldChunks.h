@@ -0,0 +1,43 @@
+#pragma once
+
+#include "raylib.h"
+#include <vector>
+
+// A piece of static world decoration: textured quad, or a flat rectangle when the texture is missing
+struct StaticProp
+{
+    const Texture2D* texture; // owned by the caller, nullptr for a plain colored rectangle
+    Rectangle dst;            // world-space destination
+    Color fallback;
+};
+
+// Screen-sized slice of the world whose static props are baked into one render texture
+struct WorldChunk
+{
+    RenderTexture2D target;
+    float bandY;  // world-space top of the baked content
+    float bandH;
+    bool dirty;
+    bool empty;
+};
+
+struct StaticWorld
+{
+    std::vector<StaticProp> props;
+    std::vector<WorldChunk> chunks;
+    float originX; // world x of the left edge of chunk 0
+    int chunkWidth;
+};
+
+StaticWorld CreateStaticWorld(float originX, float endX, int chunkWidth);
+void UnloadStaticWorld(StaticWorld& world);
+
+// Adding a prop only invalidates the chunks it overlaps
+void AddStaticProp(StaticWorld& world, const Texture2D* texture, Rectangle dst, Color fallback);
+void InvalidateStaticWorld(StaticWorld& world);
+
+// Re-bake dirty chunks overlapping the visible range (call outside BeginMode2D)
+void UpdateStaticWorld(StaticWorld& world, float viewMinX, float viewMaxX);
+
+// Draw visible chunks as one quad each (call inside BeginMode2D)
+void DrawStaticWorld(const StaticWorld& world, float viewMinX, float viewMaxX);
@@ -1,10 +1,35 @@
 #include "raylib.h"
+#include "Animation.h"
+#include "PlayerAnimation.h"
+#include "Background.h"
+#include "WorldChunks.h"
+#include "Water.h"
+#include "JobSystem.h"
+#include "Pollution.h"
+#include "Particles.h"
+#include "WaterCycle.h"
+#include "Groundwater.h"
+#include "AralScenario.h"
+#include "WaterRenderer.h"
+#include "GameState.h"
+#include "Rewind.h"
+#include "HotReload.h"
+#include "AssetCache.h"
+#include "SpriteBatch.h"
+#include "InstancedSprites.h"
+#include "AnimatedSprites.h"
+#include "SimThread.h"
+#include "ResolutionScaler.h"
+#include "UiLayer.h"
 #include <iostream>
 #include <string>
 #include <vector>
 #include <cmath>
 #include <algorithm>
 #include <sstream>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
 
 using namespace std;
 
@@ -22,65 +47,26 @@ const float PLAYER_SPEED = 5.0f;
 const float PLAYER_WIDTH = 226.0f;
 const float PLAYER_HEIGHT = 182.0f;
 
-const int FRAME_COUNT = 16;
 const int FRAME_WIDTH = 539;
 const int FRAME_HEIGHT = 439;
-const int FRAME_SPEED = 10;
+const float PLAYER_BLEND_TIME = 0.08f;
 
-const int RUN_FRAME_COUNT = 8;
-const int RUN_FRAME_SPEED = 12;
-
-const int JUMP_FRAME_COUNT = 11;
 const float JUMP_DURATION = 1.0f;
 const float JUMP_HEIGHT = (float)WORLD_HEIGHT / 2.0f;
 
-// NPC sprites
-const int NPC_FRAME_COUNT = 2;
-const int NPC_FRAME_WIDTH = 316;
-const int NPC_FRAME_HEIGHT = 362;
-
-const int CATPOP_FRAME_COUNT = 2;
-const int CATPOP_FRAME_WIDTH = 81;
-const int CATPOP_FRAME_HEIGHT = 84;
-
-const int CATCRUNCH_FRAME_COUNT = 24;
-const int CATCRUNCH_FRAME_WIDTH = 113;
-const int CATCRUNCH_FRAME_HEIGHT = 200;
-const int CATCRUNCH_FRAME_SPEED = 12;
-
-const int CATCRY_FRAME_COUNT = 60;
-const int CATCRY_FRAME_WIDTH = 100;
-const int CATCRY_FRAME_HEIGHT = 125;
-const int CATCRY_FRAME_SPEED = 12;
-
-const int CATSPINNING_FRAME_COUNT = 24;
-const int CATSPINNING_FRAME_WIDTH = 200;
-const int CATSPINNING_FRAME_HEIGHT = 134;
-const int CATSPINNING_FRAME_SPEED = 24;
-
 const int COINS_REQUIRED = 10;
-
-struct Coin {
-    Vector2 position;
-    bool active;
-    float bobOffset;
-};
-
-struct NPCState {
-    bool paid;
-};
-
-vector<NPCState> npcStates;
-vector<Coin> activeCoins;
-int collectedCoins = 0;
+const char* const DIALOGUE_THANKS = "Dziękuję! Te monety pomogą mi w badaniach. Teraz mogę przekazać ci moją wiedzę:";
+const char* const DIALOGUE_COIN_REQUEST = "Witaj! Abyś mógł iść dalej, musisz zebrać %d monet rozrzuconych w powietrzu.";
 
 struct NPC
 {
     Rectangle bounds;
     Rectangle interactionArea;
     vector<string> lines;
-    int spriteId; // 0=npc,1=cat-pop,2=cat-crunch,3=cat-cry
-    Sound* speech; // pointer to loaded Sound or nullptr
+    int spriteId; // ClipId: CLIP_NPC, CLIP_CAT_POP, CLIP_CAT_CRUNCH, CLIP_CAT_CRY
+    int animator; // index into the animator table
+    int animatedSprite; // GPU-animated instance for looping clips, -1 when drawn from the animator
+    Sound* speech; // cached Sound, replaced in place on reload, or nullptr
     bool hasSpeech;
 };
 
@@ -88,7 +74,7 @@ struct NPCDefinition
 {
     float x;
     vector<string> lines;
-    int spriteId = 0;
+    int spriteId = CLIP_NPC;
     Sound* speech = nullptr;
 };
 
@@ -102,48 +88,110 @@ const int TEXT_PADDING = 20;
 const int GROUND_HEIGHT = 64;
 const int GRASS_TILE_SIZE = 64;
 
-// Wrap text to fit maxWidth using provided font
-string WordWrapText(const string& text, int maxWidth, const Font& font, int fontSize, float charSpacing)
+// Water layer settings (heights in px above the channel datum)
+const float ARAL_NPC_X = 4480.0f;
+const float ARAL_BASIN_HALF_WIDTH = 480.0f;
+const float RIVER_BED_HEIGHT = 24.0f;
+const float WATER_START_LEVEL = 36.0f;
+const float RIVER_INFLOW_RATE = 2.0f;
+const float ARAL_DRAIN_RATE = -1.5f;
+const float SPLASH_STRENGTH = 200.0f;
+
+// Pollution lesson settings (NPC talking about sewage and chemicals)
+const float POLLUTION_NPC_X = 3200.0f;
+const float FACTORY_OUTFALL_RATE = 0.5f;
+const float TREATMENT_PLANT_DECAY = 1.5f;
+const float SEA_DILUTION_DECAY = 0.5f;
+
+// Water-cycle lesson (NPC talking about how unevenly fresh water is spread). Biome segments are
+// one screen wide; temperature, range, evaporation, wind, precipitation, cloud threshold, soil, routing
+const float WATER_CYCLE_NPC_X = 640.0f;
+const WaterCycleClimate BIOME_CLIMATES[] = {
+    { 12.0f, 14.0f, 0.12f, 0.6f, 0.05f, 1.5f, 150.0f, 0.05f }, // temperate, ~1000 mm/year
+    { 22.0f, 20.0f, 0.35f, 0.6f, 0.03f, 3.0f,  60.0f, 0.05f }, // hot and dry, ~80 mm/year
+    { 16.0f, 16.0f, 0.15f, 0.6f, 0.05f, 2.0f, 120.0f, 0.05f }, // temperate, ~550 mm/year
+    { 20.0f, 30.0f, 0.30f, 0.6f, 0.02f, 4.0f,  80.0f, 0.05f }, // continental steppe around the Aral, ~120 mm/year
+    { 10.0f, 10.0f, 0.10f, 0.6f, 0.05f, 1.0f, 200.0f, 0.05f }  // cool wet coast, ~1500 mm/year
+};
+const int BIOME_CLIMATE_COUNT = sizeof(BIOME_CLIMATES) / sizeof(BIOME_CLIMATES[0]);
+
+// Over-extraction lesson: wells the player places pump the aquifer under the river
+const float EXTRACTION_NPC_X = 1920.0f;
+const float WELL_DEPTH = 200.0f;             // px below the channel datum
+const float WELL_PUMP_RATE = 400.0f;         // px^2/s, about three times the river inflow
+const float WELL_MIN_SPACING = 64.0f;
+const float GROUNDWATER_RECHARGE_PER_MM_H = 0.05f; // px/s of infiltration per mm/h of rain
+const float GROUNDWATER_VIEW_DRAWDOWN = 20.0f;     // drawdown shown as fully depleted in the cross-section
+
+// Dams the player builds on the river (Aswan High Dam lesson); levels in px above the channel datum
+const float DAM_CREST = WATER_START_LEVEL + 20.0f;
+const float DAM_INTAKE_LEVEL = WATER_START_LEVEL + 4.0f;
+const float DAM_TURBINE_CAPACITY = 160.0f;   // px^2/s, a little above the river inflow
+const float DAM_MW_PER_UNIT = 0.75f;         // full turbines at full head give ~2 GW, like Aswan
+const float DAM_MIN_SPACING = 320.0f;
+
+// Particle effects: rain follows the water-cycle precipitation, splashes and coin sparks
+const float RAIN_DROPS_PER_MM_H = 5000.0f; // drops per second across the view for 1 mm/h of rain
+const float RAIN_STRESS_RATE = 100000.0f; // F4 in debug mode, ~100k drops alive at once
+const float RAIN_FALL_SPEED = 700.0f;
+const float RAIN_WIND = 60.0f;
+const int SPLASH_PARTICLES = 60;
+const int COIN_BURST_PARTICLES = 40;
+
+const int SPRITE_STRESS_COUNT = 10000;    // F8 in debug mode, coins tiled over the view
+
+// Coins bob in the vertex shader: 10 px at 3 rad/s, each with its own phase
+const float COIN_SIZE = 40.0f;
+const float COIN_BOB_AMPLITUDE = 10.0f;
+const float COIN_BOB_SPEED = 3.0f;
+const int COIN_STRESS_COUNT = 10000;      // F9 in debug mode, instanced coins along the world
+
+const int ANIMATED_SPRITE_CAPACITY = 256;
+
+// Aral Sea time-lapse (key 5 near the Aral NPC): the basin and the background follow 1960-2020 data
+const char* const ARAL_SCENARIO_PATH = "assets/data/aral.bin";
+const float ARAL_TIMELAPSE_YEARS_PER_SECOND = 2.0f;
+const float ARAL_SCRUB_YEARS_PER_SECOND = 10.0f;   // ',' and '.' held down
+const float ARAL_DRY_LEVEL = 25.0f;                // m above sea level drawn as an empty basin
+
+// Session snapshots: F6/F7 in debug mode write and read a checkpoint, --autosave keeps one up to date
+const char* const CHECKPOINT_PATH = "checkpoint.bin";
+const float SNAPSHOT_AUTOSAVE_INTERVAL = 10.0f;
+
+// River bed along the world: a shallow channel with the Aral basin dug around the Aral NPC
+float WorldBedHeight(float x)
 {
-    if (text.empty()) return "";
-
-    string wrappedText;
-    string currentLine;
+    float d = fabsf(x - ARAL_NPC_X);
+    if (d >= ARAL_BASIN_HALF_WIDTH) return RIVER_BED_HEIGHT;
+    float t = d / ARAL_BASIN_HALF_WIDTH;
+    return RIVER_BED_HEIGHT * 0.5f * (1.0f - cosf(t * PI));
+}
 
-    stringstream ss(text);
-    string word;
+// Headless fast-forward of the water cycle: prints the yearly balance of each biome
+int RunWaterCycleHeadless(int years)
+{
+    WaterCycle cycle = CreateWaterCycle(0.0f, (float)WORLD_WIDTH, (float)SCREEN_WIDTH,
+                                        vector<WaterCycleClimate>(BIOME_CLIMATES, BIOME_CLIMATES + BIOME_CLIMATE_COUNT));
+    auto start = chrono::high_resolution_clock::now();
 
-    while (ss >> word)
+    for (int year = 1; year <= years; ++year)
     {
-        string testLine = currentLine.empty() ? word : currentLine + " " + word;
+        ResetWaterCycleTotals(cycle);
+        FastForwardWaterCycle(cycle, WATER_CYCLE_HOURS_PER_YEAR);
 
-        Vector2 size = MeasureTextEx(font, testLine.c_str(), (float)fontSize, charSpacing);
-        if ((int)size.x > maxWidth)
-        {
-            if (!currentLine.empty())
-            {
-                wrappedText += currentLine + "\n";
-                currentLine = word;
-            }
-            else
-            {
-                // single too-long word
-                wrappedText += word + "\n";
-                currentLine.clear();
-            }
-        }
-        else
+        cout << "Rok " << year << endl;
+        for (int b = 0; b < BIOME_CLIMATE_COUNT; ++b)
         {
-            currentLine = testLine;
+            const WaterCycleTotals& t = cycle.totals[b];
+            double n = (double)cycle.biomeColumns[b];
+            cout << TextFormat("  biom %d: opady %6.0f mm, parowanie %6.0f mm, spływ %6.0f mm, zapas %5.0f mm",
+                               b + 1, t.precipitation / n, t.evaporation / n, t.runoff / n, GetWaterCycleStorage(cycle, b)) << endl;
         }
     }
 
-    if (!currentLine.empty())
-    {
-        wrappedText += currentLine;
-    }
-
-    return wrappedText;
+    double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    cout << TextFormat("%d lat symulacji w %.2f s", years, seconds) << endl;
+    return 0;
 }
 
 // Draw text that may contain newlines
@@ -159,175 +207,98 @@ void DrawWrappedText(const Font& font, const string& text, float x, float y, int
     }
 }
 
-void SpawnCoins(vector<Coin>& coins, float minX, float maxX) {
-    coins.clear();
-    for (int i = 0; i < COINS_REQUIRED; i++) {
-        coins.push_back({
+void SpawnCoins(GameState& game, float minX, float maxX) {
+    game.activeCoinCount = min(COINS_REQUIRED, GAME_STATE_MAX_COINS);
+    for (int i = 0; i < game.activeCoinCount; i++) {
+        game.activeCoins[i] = {
             {(float)GetRandomValue(minX, maxX), (float)GetRandomValue(100, 400)},
             true,
             (float)GetRandomValue(0, 1000) / 100.0f
-            });
+            };
     }
 }
 
-int main(void)
+int main(int argc, char** argv)
 {
+    // --deterministic pins simulation jobs to fixed threads for bit-exact replays
+    // --fast-forward-years N runs the water cycle headless and prints its yearly balance
+    // --encode-aral in.csv out.bin rebuilds the Aral scenario data
+    // --load-snapshot file starts from a saved checkpoint
+    // --autosave file resumes from the file when it exists and rewrites it while playing (kiosks)
+    // --no-sim-thread steps the environment on the main thread instead of during EndDrawing
+    // --windowed keeps the 1280x720 window instead of covering the monitor
+    bool deterministicJobs = false;
+    int fastForwardYears = 0;
+    string loadSnapshotPath;
+    string autosavePath;
+    bool simThread = true;
+    bool windowed = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (string(argv[i]) == "--deterministic") deterministicJobs = true;
+        if (string(argv[i]) == "--fast-forward-years" && i + 1 < argc) fastForwardYears = max(1, atoi(argv[++i]));
+        if (string(argv[i]) == "--encode-aral" && i + 2 < argc) return EncodeAralScenario(argv[i + 1], argv[i + 2]) ? 0 : 1;
+        if (string(argv[i]) == "--load-snapshot" && i + 1 < argc) loadSnapshotPath = argv[++i];
+        if (string(argv[i]) == "--autosave" && i + 1 < argc) autosavePath = argv[++i];
+        if (string(argv[i]) == "--no-sim-thread") simThread = false;
+        if (string(argv[i]) == "--windowed") windowed = true;
+    }
+    if (loadSnapshotPath.empty() && !autosavePath.empty() && FileExists(autosavePath.c_str())) loadSnapshotPath = autosavePath;
+    if (fastForwardYears > 0) return RunWaterCycleHeadless(fastForwardYears);
+
     SetConfigFlags(FLAG_WINDOW_UNDECORATED);
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Wpływ człowieka na hydrosferę");
     InitAudioDevice();
+    if (!windowed)
+    {
+        int monitor = GetCurrentMonitor();
+        Vector2 origin = GetMonitorPosition(monitor);
+        SetWindowSize(GetMonitorWidth(monitor), GetMonitorHeight(monitor));
+        SetWindowPosition((int)origin.x, (int)origin.y);
+    }
 
-    // Assets
-    Texture2D catWalkTexture = LoadTexture("assets/player/walk.png");
-    if (catWalkTexture.id == 0) cerr << "ERROR: Could not load texture 'walk.png'." << endl;
-
-    Texture2D catRunTexture = LoadTexture("assets/player/run.png");
-    if (catRunTexture.id == 0) cerr << "ERROR: Could not load texture 'run.png'." << endl;
-
-    Texture2D catJumpTexture = LoadTexture("assets/player/jump.png");
-    if (catJumpTexture.id == 0) cerr << "ERROR: Could not load texture 'jump.png'." << endl;
-    
-    Texture2D happyTexture = LoadTexture("assets/player/happy.png");
-    if (happyTexture.id == 0) cerr << "WARNING: Could not load texture 'happy.png'." << endl;
-
-    Texture2D npcTexture = LoadTexture("assets/npc/gatito.png");
-    if (npcTexture.id == 0) cerr << "ERROR: Could not load texture 'gatito.png'." << endl;
-
-    Texture2D catPopTexture = LoadTexture("assets/npc/catPop.png");
-    if (catPopTexture.id == 0) cerr << "ERROR: Could not load texture 'catPop.png'." << endl;
-
-    Texture2D catCrunchTexture = LoadTexture("assets/npc/catCrunch.png");
-    if (catCrunchTexture.id == 0) cerr << "ERROR: Could not load texture 'catCrunch.png'." << endl;
-
-    Texture2D catCryTexture = LoadTexture("assets/npc/catCry.png");
-    if (catCryTexture.id == 0) cerr << "ERROR: Could not load texture 'catCry.png'." << endl;
-
-    Texture2D catSpinningTexture = LoadTexture("assets/npc/catSpinning.png");
-    if (catSpinningTexture.id == 0) cerr << "ERROR: Could not load texture 'catSpinning.png'." << endl;
-
-    Texture2D grassTexture = LoadTexture("assets/level/grass.png");
-    if (grassTexture.id == 0) cerr << "WARNING: Could not load texture 'grass.png'." << endl;
-
-    Texture2D coinTexture = LoadTexture("assets/level/coin.png");
-    if (coinTexture.id == 0) cerr << "WARNING: Could not load texture 'coin.png'." << endl;
-
-    Texture2D finishTexture = LoadTexture("assets/level/finish.png");
-    if (finishTexture.id == 0) cerr << "WARNING: Could not load texture 'finish.png'." << endl;
-
-    Texture2D congratsTexture = LoadTexture("assets/level/congratulation.png");
-    if (congratsTexture.id == 0) cerr << "WARNING: Could not load texture 'congratulation.png'." << endl;
-
-    // Biome background textures
+    // The world and HUD keep working in SCREEN_WIDTH x SCREEN_HEIGHT units whatever the display is
+    ResolutionScaler scaler = CreateResolutionScaler(SCREEN_WIDTH, SCREEN_HEIGHT, GetScreenWidth(), GetScreenHeight());
+
+    // Assets live in the cache; the references stay valid until it is destroyed
+    AssetCache* assets = CreateAssetCache();
+    Texture2D& catWalkTexture = GetTexture(assets, AcquireTexture(assets, "assets/player/walk.png"));
+    Texture2D& catRunTexture = GetTexture(assets, AcquireTexture(assets, "assets/player/run.png"));
+    Texture2D& catJumpTexture = GetTexture(assets, AcquireTexture(assets, "assets/player/jump.png"));
+    Texture2D& happyTexture = GetTexture(assets, AcquireTexture(assets, "assets/player/happy.png"));
+    Texture2D& npcTexture = GetTexture(assets, AcquireTexture(assets, "assets/npc/gatito.png"));
+    Texture2D& catPopTexture = GetTexture(assets, AcquireTexture(assets, "assets/npc/catPop.png"));
+    Texture2D& catCrunchTexture = GetTexture(assets, AcquireTexture(assets, "assets/npc/catCrunch.png"));
+    Texture2D& catCryTexture = GetTexture(assets, AcquireTexture(assets, "assets/npc/catCry.png"));
+    Texture2D& catSpinningTexture = GetTexture(assets, AcquireTexture(assets, "assets/npc/catSpinning.png"));
+    Texture2D& grassTexture = GetTexture(assets, AcquireTexture(assets, "assets/level/grass.png"));
+    Texture2D& coinTexture = GetTexture(assets, AcquireTexture(assets, "assets/level/coin.png"));
+    Texture2D& finishTexture = GetTexture(assets, AcquireTexture(assets, "assets/level/finish.png"));
+    Texture2D& congratsTexture = GetTexture(assets, AcquireTexture(assets, "assets/level/congratulation.png"));
+
+    // Biome segments
     const int SEG_W = 1280;
     const int SEG_COUNT = 5;
-    Texture2D biomeTextures[SEG_COUNT];
-    for (int i = 0; i < SEG_COUNT; ++i)
-    {
-        string filename = "assets/level/biome" + to_string(i + 1) + ".png";
-        biomeTextures[i] = LoadTexture(filename.c_str());
-        if (biomeTextures[i].id == 0)
-        {
-            cerr << "WARNING: Could not load texture biome'" << to_string(i + 1) << ".png'." << endl;
-        }
-    }
 
-    // Background crossfade state
-    int displayedBiome = -1;
-    int fadingFrom = -1;
-    int fadingTo = -1;
-    float fadeTimer = 0.0f;
+    // Session state (player, coins, NPC progress, dialogue, background crossfade), saved as one snapshot
+    GameState game = MakeGameState();
     const float FADE_DURATION = 0.6f;
+    BiomeBackground biomeBackground = LoadBiomeBackground();
+    ParallaxBackground parallax = CreateParallaxBackground(assets, "assets/level/biome", SEG_COUNT, SEG_W, SCREEN_WIDTH, SCREEN_HEIGHT);
 
-    // Load font
-    int codepointsCount = 0;
-    int* codepoints = LoadCodepoints(" !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~ąćęłńóśźżĄĆĘŁŃÓŚŹŻ", &codepointsCount);
-    Font uiFont = LoadFontEx("C:/Windows/Fonts/consola.ttf", TEXT_FONT_SIZE, codepoints, codepointsCount);
-    UnloadCodepoints(codepoints);
-    if (uiFont.texture.id == 0)
-    {
-        uiFont = GetFontDefault();
-        cerr << "WARNING: Could not load system font. Falling back to default." << endl;
-    }
+    // HUD layer and its font, rasterised for the size the HUD ends up on the display
+    UiLayer ui = CreateUiLayer((float)SCREEN_WIDTH, (float)SCREEN_HEIGHT, scaler.output, "C:/Windows/Fonts/consola.ttf",
+        " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~ąćęłńóśźżĄĆĘŁŃÓŚŹŻ", TEXT_FONT_SIZE);
 
     // Sounds
-    Sound meow1Sound = { 0 };
-    if (FileExists("assets/sound/meow1.wav"))
-    {
-        meow1Sound = LoadSound("assets/sound/meow1.wav");
-    }
-    else
-    {
-        cerr << "WARNING: 'meow1.wav' not found." << endl;
-    }
-
-    Sound meow2Sound = { 0 };
-    if (FileExists("assets/sound/meow2.wav"))
-    {
-        meow2Sound = LoadSound("assets/sound/meow2.wav");
-    }
-    else
-    {
-        cerr << "WARNING: 'meow2.wav' not found." << endl;
-    }
-
-    Sound popSound = { 0 };
-    if (FileExists("assets/sound/pop.wav"))
-    {
-        popSound = LoadSound("assets/sound/pop.wav");
-    }
-    else
-    {
-        cerr << "WARNING: 'pop.wav' not found." << endl;
-    }
-
-    Sound vanishSound = { 0 };
-    if (FileExists("assets/sound/vanish.wav"))
-    {
-        vanishSound = LoadSound("assets/sound/vanish.wav");
-    }
-    else
-    {
-        cerr << "WARNING: 'vanish.wav' not found." << endl;
-    }
-
-    Sound crunchSound = { 0 };
-    if (FileExists("assets/sound/crunch.wav"))
-    {
-        crunchSound = LoadSound("assets/sound/crunch.wav");
-    }
-    else
-    {
-        cerr << "WARNING: 'crunch.wav' not found." << endl;
-    }
-
-    Sound jumpSound = { 0 };
-    if (FileExists("assets/sound/jump.wav"))
-    {
-        jumpSound = LoadSound("assets/sound/jump.wav");
-    }
-    else
-    {
-        cerr << "WARNING: 'jump.wav' not found." << endl;
-    }
-
-    Sound sprintSound = { 0 };
-    if (FileExists("assets/sound/sprint.wav"))
-    {
-        sprintSound = LoadSound("assets/sound/sprint.wav");
-    }
-    else
-    {
-        cerr << "WARNING: 'sprint.wav' not found." << endl;
-    }
-
-    Sound cheerSound = { 0 };
-    if (FileExists("assets/sound/cheer.wav"))
-    {
-        cheerSound = LoadSound("assets/sound/cheer.wav");
-    }
-    else
-    {
-        cerr << "WARNING: 'cheer.wav' not found." << endl;
-    }
+    Sound& meow1Sound = GetSound(assets, AcquireSound(assets, "assets/sound/meow1.wav"));
+    Sound& meow2Sound = GetSound(assets, AcquireSound(assets, "assets/sound/meow2.wav"));
+    Sound& popSound = GetSound(assets, AcquireSound(assets, "assets/sound/pop.wav"));
+    Sound& vanishSound = GetSound(assets, AcquireSound(assets, "assets/sound/vanish.wav"));
+    Sound& crunchSound = GetSound(assets, AcquireSound(assets, "assets/sound/crunch.wav"));
+    Sound& jumpSound = GetSound(assets, AcquireSound(assets, "assets/sound/jump.wav"));
+    Sound& sprintSound = GetSound(assets, AcquireSound(assets, "assets/sound/sprint.wav"));
+    Sound& cheerSound = GetSound(assets, AcquireSound(assets, "assets/sound/cheer.wav"));
 
     // Background music settings
     vector<string> playlistFiles = { "assets/sound/Investigations.wav", "assets/sound/Fluffing_a_Duck.wav", "assets/sound/Sneaky_Adventure.wav" };
@@ -368,25 +339,44 @@ int main(void)
     if (!musicPlaylist.empty()) PlayRandomTrack();
 
     // initial player rect
-    Rectangle player = { 0.0f, 0.0f, PLAYER_WIDTH, PLAYER_HEIGHT };
+    game.player = { 0.0f, 0.0f, PLAYER_WIDTH, PLAYER_HEIGHT };
 
     // preserve 10px overlap into ground
     const float bottomOffset = (float)GROUND_HEIGHT - 5.0f;
-    player.y = (float)SCREEN_HEIGHT - PLAYER_HEIGHT - bottomOffset;
+    game.player.y = (float)SCREEN_HEIGHT - PLAYER_HEIGHT - bottomOffset;
 
-    float PLAYER_GROUND_Y = player.y;
+    float PLAYER_GROUND_Y = game.player.y;
 
     Camera2D camera = { 0 };
-    camera.target = { player.x + player.width / 2.0f, player.y + player.height / 2.0f };
+    camera.target = { game.player.x + game.player.width / 2.0f, game.player.y + game.player.height / 2.0f };
     camera.offset = { (float)SCREEN_WIDTH / 2.0f, (float)SCREEN_HEIGHT / 2.0f };
     camera.rotation = 0.0f;
     camera.zoom = 1.0f;
 
+    // Animation clip table (sheet, frame grid, fps, loop mode), indexed by ClipId
+    vector<AnimationClip> clips(CLIP_COUNT);
+    clips[CLIP_NPC]          = { &npcTexture,         316, 362,  2, 0,  0.0f, ANIM_MANUAL };
+    clips[CLIP_CAT_POP]      = { &catPopTexture,       81,  84,  2, 0,  0.0f, ANIM_MANUAL };
+    clips[CLIP_CAT_CRUNCH]   = { &catCrunchTexture,   113, 200, 24, 0, 12.0f, ANIM_LOOP };
+    clips[CLIP_CAT_CRY]      = { &catCryTexture,      100, 125, 60, 0, 12.0f, ANIM_LOOP };
+    clips[CLIP_CAT_SPINNING] = { &catSpinningTexture, 200, 134, 24, 0, 24.0f, ANIM_LOOP };
+    clips[CLIP_HAPPY]        = { &happyTexture,       128, 128, 64, 0, 24.0f, ANIM_LOOP };
+    clips[CLIP_CONGRATS]     = { &congratsTexture,    600, 193,  4, 0,  8.0f, ANIM_LOOP };
+    clips[CLIP_PLAYER_WALK]  = { &catWalkTexture, FRAME_WIDTH, FRAME_HEIGHT, 16, 0, 10.0f, ANIM_LOOP };
+    clips[CLIP_PLAYER_RUN]   = { &catRunTexture,  FRAME_WIDTH, FRAME_HEIGHT,  8, 0, 12.0f, ANIM_LOOP };
+    clips[CLIP_PLAYER_JUMP]  = { &catJumpTexture, FRAME_WIDTH, FRAME_HEIGHT, 11, 0, 11.0f / JUMP_DURATION, ANIM_ONCE };
+
+    // All animators live in one table and are advanced together by UpdateAnimators
+    vector<Animator> animators;
+
+    // Looping creatures that nothing in gameplay watches are animated in the shader instead
+    AnimatedSprites animatedSprites = CreateAnimatedSprites(clips, ANIMATED_SPRITE_CAPACITY);
+
     vector<NPC> npcs;
     npcs.reserve(5);
 
     // Helper to create NPCs
-    auto makeNpc = [&](float x, const vector<string>& lines, int spriteId = 0, Sound* speech = nullptr) -> NPC
+    auto makeNpc = [&](float x, const vector<string>& lines, int spriteId = CLIP_NPC, Sound* speech = nullptr) -> NPC
         {
             float w = 64.0f;
             float h = 120.0f;
@@ -399,105 +389,100 @@ int main(void)
             npc.interactionArea = interaction;
             npc.lines = lines;
             npc.spriteId = spriteId;
-            npc.speech = (speech != nullptr && speech->frameCount != 0) ? speech : nullptr;
-            npc.hasSpeech = (npc.speech != nullptr);
+            npc.animator = (int)animators.size();
+            npc.animatedSprite = -1;
+            const AnimationClip& clip = clips[spriteId];
+            if (clip.loopMode == ANIM_LOOP)
+            {
+                float renderH = h * 2.2f;
+                float renderW = clip.frameWidth * renderH / (float)clip.frameHeight;
+                Rectangle dst = { x + w / 2.0f - renderW / 2.0f, y + h - renderH, renderW, renderH };
+                npc.animatedSprite = AddAnimatedSprite(animatedSprites, spriteId, dst, 0.0f, SPRITE_LAYER_CHARACTERS);
+            }
+            animators.push_back(MakeAnimator(spriteId, npc.animatedSprite < 0));
+            npc.speech = speech;
+            npc.hasSpeech = (speech != nullptr && speech->frameCount != 0);
             return npc;
         };
 
     vector<NPCDefinition> npcDefinitions = {
-        { 640.0f, {
+        { WATER_CYCLE_NPC_X, {
             "Zróżnicowanie zasobów wody na świecie: jedne regiony mają dużo wody słodkiej, inne bardzo mało.",
             "Dostępność wody słodkiej zależy od klimatu, geologii i infrastruktury.",
             "Zrozumienie tego zróżnicowania jest kluczowe dla planowania i sprawiedliwego dostępu."
-            }, 0, (meow1Sound.frameCount != 0 ? &meow1Sound : nullptr) },
+            }, CLIP_NPC, &meow1Sound },
 
-        { 1920.0f, {
+        { EXTRACTION_NPC_X, {
             "Niedobory wody dotykają miliardy ludzi. Przyczyny to wzrost populacji, zanieczyszczenia i zmiany klimatu.",
             "Susze i nadmierne pobory zasilają kryzysy wodne, szczególnie w krajach rozwijających się.",
             "Inwestycje w infrastrukturę, zarządzanie zasobami i edukacja są niezbędne, by łagodzić skutki."
-            }, 1, nullptr },
+            }, CLIP_CAT_POP, nullptr },
 
-        { 3200.0f, {
+        { POLLUTION_NPC_X, {
             "Człowiek zagraża hydrosferze poprzez zanieczyszczenia, nadmierne pobory i degradację siedlisk.",
             "Plastiki, chemikalia i ścieki przemysłowe zmniejszają jakość wody i szkodzą organizmom.",
             "Ograniczanie emisji, regulacje i ochrona stref brzegowych to kluczowe działania."
-            }, 3, (meow2Sound.frameCount != 0 ? &meow2Sound : nullptr) },
+            }, CLIP_CAT_CRY, &meow2Sound },
 
-        { 4480.0f, {
+        { ARAL_NPC_X, {
             "Jezioro Aralskie to przykład katastrofy ekologicznej: odpływ rzek do nawadniania zmniejszył jego powierzchnię.",
             "Wysoka Tama na Nilu miała korzyści w hydroenergetyce, ale zmieniła sedymentację i lokalne ekosystemy.",
             "Studium tych przykładów uczy nas o konsekwencjach dużych projektów wodnych i konieczności zrównoważenia."
-            }, 2, nullptr },
+            }, CLIP_CAT_CRUNCH, nullptr },
 
         { 5760.0f, {
             "Jak chronić hydrosferę? Oszczędzanie wody, oczyszczanie ścieków i redukcja zanieczyszczeń są podstawowe.",
             "Inwestycje w odnawialne źródła, zrównoważone rolnictwo i ochrona terenów przybrzeżnych są kluczowe.",
             "Edukacja i współpraca międzynarodowa umożliwiają długotrwałe rozwiązania dla całej hydrosfery."
-            }, 0, (meow1Sound.frameCount != 0 ? &meow1Sound : nullptr) }
+            }, CLIP_NPC, &meow1Sound }
     };
 
+    // The Aral lesson drives the basin drain, remember which NPC gives it
+    int aralNpc = -1;
     for (const auto& def : npcDefinitions)
+    {
+        if (def.x == ARAL_NPC_X) aralNpc = (int)npcs.size();
         npcs.push_back(makeNpc(def.x, def.lines, def.spriteId, def.speech));
-
-    for (size_t i = 0; i < npcs.size(); i++) {
-        npcStates.push_back({ false });
     }
 
+    game.npcCount = min((int)npcs.size(), GAME_STATE_MAX_NPCS);
+
     // Animation / state
-    int frameCounter = 0;
-    int currentFrame = 0;
-    int runFrameCounter = 0;
-    int currentRunFrame = 0;
-    float frameDirection = 1.0f;
     bool isMoving = false;
+    bool jumpStarted = false;
 
-    bool isJumping = false;
-    float jumpTimer = 0.0f;
-    int jumpFrame = 0;
-
-    int catCrunchFrame = 0;
-    float catCrunchTimer = 0.0f;
+    // Player animation state machine drives one animator through the player clips
+    PlayerAnimMachine playerAnim = MakePlayerAnimMachine((int)animators.size(), PLAYER_BLEND_TIME);
+    playerAnim.stateClips[PLAYER_IDLE] = CLIP_PLAYER_WALK;
+    playerAnim.stateClips[PLAYER_WALK] = CLIP_PLAYER_WALK;
+    playerAnim.stateClips[PLAYER_RUN] = CLIP_PLAYER_RUN;
+    playerAnim.stateClips[PLAYER_JUMP] = CLIP_PLAYER_JUMP;
+    playerAnim.stateClips[PLAYER_HAPPY] = CLIP_HAPPY;
+    animators.push_back(MakeAnimator(CLIP_PLAYER_WALK, false));
 
-    int catCryFrame = 0;
-    float catCryTimer = 0.0f;
+    const int spinningCatSprite = AddAnimatedSprite(animatedSprites, CLIP_CAT_SPINNING, { 0, 0, 0, 0 }, 0.0f, SPRITE_LAYER_PROPS);
 
-    int catSpinningFrame = 0;
-    float catSpinningTimer = 0.0f;
-
-    int activeNPC = -1;
-    int currentDialogueLine = 0;
     string rawDialogueText;
-    string wrappedDialogueText;
-    int textDisplayLength = 0;
-    int prevTextDisplayLength = 0;
+    UiText dialogueText = MakeUiText(ui.width * 0.8f - 2.0f * TEXT_PADDING, (float)TEXT_FONT_SIZE, 4.0f);
 
-    bool spinningCatVanished = false;
-    bool spinningCatVanishing = false;
-    float spinningCatVanishTimer = 0.0f;
     const float SPINNING_CAT_VANISH_DURATION = 1.0f;
-    float spinningCatScale = 1.5f;
 
-    float spinningCatDestX = SECRET_X_OFFSET + (SECRET_ROOM_WIDTH / 2.0f) - ((CATSPINNING_FRAME_WIDTH * 1.5f) / 2.0f);
-    float spinningCatDestY = SCREEN_HEIGHT - GROUND_HEIGHT - (CATSPINNING_FRAME_HEIGHT * 1.5f);
+    const AnimationClip& spinningClip = clips[CLIP_CAT_SPINNING];
+    float spinningCatDestX = SECRET_X_OFFSET + (SECRET_ROOM_WIDTH / 2.0f) - ((spinningClip.frameWidth * 1.5f) / 2.0f);
+    float spinningCatDestY = SCREEN_HEIGHT - GROUND_HEIGHT - (spinningClip.frameHeight * 1.5f);
     Rectangle spinningCatInteractionArea = {
         spinningCatDestX,
         spinningCatDestY,
-        CATSPINNING_FRAME_WIDTH * 1.5f,
-        CATSPINNING_FRAME_HEIGHT * 1.5f
+        spinningClip.frameWidth * 1.5f,
+        spinningClip.frameHeight * 1.5f
     };
 
     // Per-character reveal timers
-    float charTimer = 0.0f;
     const float charInterval = (TEXT_SPEED > 0) ? (1.0f / (float)TEXT_SPEED) : 1e6f;
-    float punctuationPauseRemaining = 0.0f;
     const float PUNCTUATION_PAUSE = 0.35f;
 
-    bool mouthOpen = false;
-    float mouthTimer = 0.0f;
     const float mouthToggleInterval = (TEXT_SPEED > 0) ? (2.0f / (float)TEXT_SPEED) : 1e6f;
 
-    const int MAX_TEXT_WIDTH = (int)(SCREEN_WIDTH * 0.8f) - (2 * TEXT_PADDING);
-
     const string PUNCTUATION_CHARS = ".,;:!?";
 
     auto PlayDialogueCharSound = [&](int npcIndex, char ch)
@@ -510,26 +495,15 @@ int main(void)
         };
 
     // Finish/kitty-happy animation settings
-    bool finishTriggered = false;
-    float happyTimer = 0.0f;
-    const int HAPPY_FRAME_COUNT = 64;
-    const int HAPPY_FRAME_W = 128;
-    const int HAPPY_FRAME_H = 128;
-    const float HAPPY_FPS = 24.0f;
-    const float HAPPY_FRAME_TIME = 1.0f / HAPPY_FPS;
     const float HAPPY_RENDER_SIZE = 339.0f;
     const float HAPPY_DRAW_OFFSET_Y = 144.0f;
     const int HAPPY_LOOPS = 2;
 
     // congratulation spritesheet settings
-    const int CONGRATS_FRAMES = 4;
-    const int CONGRATS_W = 600;
-    const int CONGRATS_H = 193;
-    const float CONGRATS_FPS = 8.0f;
-    const float CONGRATS_FRAME_TIME = 1.0f / CONGRATS_FPS;
-    const float CONGRATS_RENDER_W = (float)CONGRATS_W * 1.5f;
-    const float CONGRATS_RENDER_H = (float)CONGRATS_H * 1.5f;
-    float congratsTimer = 0.0f;
+    const int congratsAnimator = (int)animators.size();
+    animators.push_back(MakeAnimator(CLIP_CONGRATS, false));
+    const float CONGRATS_RENDER_W = (float)clips[CLIP_CONGRATS].frameWidth * 1.5f;
+    const float CONGRATS_RENDER_H = (float)clips[CLIP_CONGRATS].frameHeight * 1.5f;
     const float CONGRATS_MARGIN_TOP = 20.0f;
 
     // Finish flag collision bounds
@@ -537,114 +511,243 @@ int main(void)
     const float FINISH_FLAG_H = 92.0f;
     Rectangle finishFlagBounds = { (float)(WORLD_WIDTH - 200), (float)(SCREEN_HEIGHT - GROUND_HEIGHT - FINISH_FLAG_H), FINISH_FLAG_W, FINISH_FLAG_H };
 
-    SetTargetFPS(60);
-    
-    bool isDebugMode = false;
-
-    while (!WindowShouldClose())
+    // Static world content (secret room backdrop, ground strip, finish flag) baked per screen-sized chunk
+    StaticWorld staticWorld = CreateStaticWorld(SECRET_X_OFFSET, (float)WORLD_WIDTH, SCREEN_WIDTH);
+    AddStaticProp(staticWorld, nullptr, { SECRET_X_OFFSET, 0.0f, (float)SECRET_ROOM_WIDTH, (float)SCREEN_HEIGHT }, CLITERAL(Color){ 10, 10, 30, 255 });
     {
-        float dt = GetFrameTime();
-        
-        // Debug mode toggle
-        if (IsKeyPressed(KEY_F3))
+        int tileW = (grassTexture.id != 0) ? grassTexture.width : GRASS_TILE_SIZE;
+        int tileH = (grassTexture.id != 0) ? grassTexture.height : GROUND_HEIGHT;
+        int groundY = SCREEN_HEIGHT - GROUND_HEIGHT;
+        for (int gx = 0; gx < WORLD_WIDTH; gx += tileW)
+            AddStaticProp(staticWorld, &grassTexture, { (float)gx, (float)groundY, (float)tileW, (float)tileH }, DARKGREEN);
+    }
+    AddStaticProp(staticWorld, &finishTexture, finishFlagBounds, RED);
+
+    // Shallow-water layer under the ground line: river fed from the left, open sea on the right
+    JobSystem* jobs = CreateJobSystem();
+    SetJobSystemDeterministic(jobs, deterministicJobs);
+
+    ShallowWater water = CreateShallowWater(0.0f, (float)WORLD_WIDTH, WATER_CELL_SIZE, jobs);
+    InitShallowWaterBed(water, WorldBedHeight, WATER_START_LEVEL);
+    AddWaterRegion(water, 0.0f, 64.0f, RIVER_INFLOW_RATE);
+    AddWaterRegion(water, (float)WORLD_WIDTH - 64.0f, (float)WORLD_WIDTH, 0.0f, WATER_START_LEVEL);
+    const int aralDrainRegion = AddWaterRegion(water, ARAL_NPC_X - ARAL_BASIN_HALF_WIDTH, ARAL_NPC_X + ARAL_BASIN_HALF_WIDTH, ARAL_DRAIN_RATE);
+    water.regions[aralDrainRegion].active = false;
+    const float waterDatumY = (float)(SCREEN_HEIGHT - GROUND_HEIGHT) + WATER_CHANNEL_DEPTH;
+
+    // Pollutant carried by the river: factory outfall upstream of the pollution NPC, treatment plant downstream
+    PollutionField pollution = CreatePollutionField(0.0f, (float)WORLD_WIDTH, WATER_CHANNEL_DEPTH, jobs);
+    const int factoryOutfall = AddPollutionSource(pollution, POLLUTION_NPC_X - 200.0f, POLLUTION_NPC_X - 160.0f, FACTORY_OUTFALL_RATE, 0.0f);
+    const int treatmentPlant = AddPollutionSource(pollution, POLLUTION_NPC_X + 160.0f, POLLUTION_NPC_X + 240.0f, 0.0f, TREATMENT_PLANT_DECAY);
+    pollution.sources[treatmentPlant].active = false;
+    AddPollutionSource(pollution, (float)WORLD_WIDTH - 64.0f, (float)WORLD_WIDTH, 0.0f, SEA_DILUTION_DECAY);
+
+    // Aquifer under the river, in balance with the starting water level
+    Groundwater groundwater = CreateGroundwater(0.0f, (float)WORLD_WIDTH, WATER_START_LEVEL, jobs);
+    vector<Color> groundwaterPixels(groundwater.columns * groundwater.rows, BLANK);
+    Image groundwaterImage = GenImageColor(groundwater.columns, groundwater.rows, BLANK);
+    Texture2D groundwaterTexture = LoadTextureFromImage(groundwaterImage);
+    UnloadImage(groundwaterImage);
+    bool groundwaterTextureDirty = true;
+
+    // Water cycle over the biomes, exchanging evaporation and runoff with the river
+    WaterCycle waterCycle = CreateWaterCycle(0.0f, (float)WORLD_WIDTH, (float)SEG_W,
+                                             vector<WaterCycleClimate>(BIOME_CLIMATES, BIOME_CLIMATES + BIOME_CLIMATE_COUNT));
+
+    // Environment step (river, pollution, water cycle, aquifer) of each frame, run on its own thread
+    // while the frame is handed to the GPU
+    SimThread* sim = CreateSimThread(simThread);
+
+    // Particles: the rain emitter follows the camera, drops die on the ground line
+    ParticleSystem particles = CreateParticleSystem();
+    const int rainEmitter = AddParticleEmitter(particles, PARTICLE_RAIN, { 0.0f, -20.0f }, { (float)SCREEN_WIDTH + 400.0f, 0.0f },
+                                               { RAIN_WIND, RAIN_FALL_SPEED }, { 10.0f, 60.0f }, 3.0f, 0.0f);
+    SetParticleFloor(particles, PARTICLE_RAIN, (float)(SCREEN_HEIGHT - GROUND_HEIGHT));
+    bool rainStress = false;
+
+    // World sprites, queued while drawing and flushed by layer
+    SpriteBatch sprites = CreateSpriteBatch();
+    bool spriteStress = false;
+
+    // Coins, one instanced draw; the instance buffer only changes when a coin spawns or is picked up
+    InstancedSprites coinSprites = CreateInstancedSprites(GAME_STATE_MAX_COINS + COIN_STRESS_COUNT, { COIN_SIZE, COIN_SIZE },
+                                                          COIN_BOB_AMPLITUDE, COIN_BOB_SPEED);
+    vector<SpriteInstance> coinInstances;
+    coinInstances.reserve(coinSprites.capacity);
+    bool coinStress = false;
+
+    // River surface mesh, rebuilt over the cells in view every frame
+    WaterRenderer waterRenderer = CreateWaterRenderer((int)(SCREEN_WIDTH / WATER_CELL_SIZE) + 4);
+
+    // Aral time-lapse, decoded chunk by chunk as the timeline moves
+    AralScenario aral = LoadAralScenario(ARAL_SCENARIO_PATH);
+    const AralSample aralStart = SampleAralScenario(aral, GetAralScenarioFirstYear(aral));
+    const Rectangle aralTimeline = { 40.0f, ui.height - 50.0f, ui.width - 80.0f, 14.0f };
+    bool aralDragging = false;
+    game.aralYear = GetAralScenarioFirstYear(aral);
+    AralSample aralNow = aralStart;
+
+    // Snapshots carry the lesson settings too; the simulations refill their fields from them
+    float autosaveTimer = 0.0f;
+    float lastSnapshotUs = 0.0f;
+
+    auto CaptureLessonSettings = [&]()
         {
-            isDebugMode = !isDebugMode;
-        }
+            game.factoryOutfallActive = pollution.sources[factoryOutfall].active;
+            game.treatmentPlantActive = pollution.sources[treatmentPlant].active;
+            game.wellCount = min((int)groundwater.wells.size(), GROUNDWATER_MAX_WELLS);
+            for (int i = 0; i < game.wellCount; ++i) game.wellX[i] = groundwater.wells[i].x;
+            game.damCount = min((int)water.dams.size(), WATER_MAX_DAMS);
+            for (int i = 0; i < game.damCount; ++i) game.damX[i] = GetWaterDamX(water, i);
+        };
 
-        // Hot Reload Assets
-        if (IsKeyPressed(KEY_F5))
+    auto SaveSnapshot = [&](const string& path) -> bool
         {
-            // Unload existing then reload textures
-            if (catWalkTexture.id != 0) UnloadTexture(catWalkTexture);
-            catWalkTexture = LoadTexture("walk.png");
-
-            if (catRunTexture.id != 0) UnloadTexture(catRunTexture);
-            catRunTexture = LoadTexture("run.png");
-
-            if (catJumpTexture.id != 0) UnloadTexture(catJumpTexture);
-            catJumpTexture = LoadTexture("jump.png");
-
-            if (npcTexture.id != 0) UnloadTexture(npcTexture);
-            npcTexture = LoadTexture("npc.png");
-
-            if (catPopTexture.id != 0) UnloadTexture(catPopTexture);
-            catPopTexture = LoadTexture("cat-pop.png");
-
-            if (catCrunchTexture.id != 0) UnloadTexture(catCrunchTexture);
-            catCrunchTexture = LoadTexture("cat-crunch.png");
-
-            if (catCryTexture.id != 0) UnloadTexture(catCryTexture);
-            catCryTexture = LoadTexture("cat-cry.png");
+            auto start = chrono::high_resolution_clock::now();
+            CaptureLessonSettings();
+            bool saved = SaveGameState(game, path);
+            lastSnapshotUs = chrono::duration<float, micro>(chrono::high_resolution_clock::now() - start).count();
+            return saved;
+        };
 
-            if (catSpinningTexture.id != 0) UnloadTexture(catSpinningTexture);
-            catSpinningTexture = LoadTexture("cat-spinning.png");
+    auto RestoreSnapshot = [&](const GameState& loaded)
+        {
+            if (loaded.npcCount != (int)npcs.size())
+            {
+                TraceLog(LOG_WARNING, "SNAPSHOT: saved with %d NPCs, the level has %d", loaded.npcCount, (int)npcs.size());
+                return;
+            }
+            bool wasFinished = game.finishTriggered;
+            game = loaded;
 
-            if (grassTexture.id != 0) UnloadTexture(grassTexture);
-            grassTexture = LoadTexture("grass.png");
+            // The dialogue text is not stored, rebuild it from the cursor
+            rawDialogueText.clear();
+            SetUiText(dialogueText, "", ui);
+            if (game.activeNPC >= 0 && game.activeNPC < (int)npcs.size())
+            {
+                const NPC& npc = npcs[game.activeNPC];
+                if (game.currentDialogueLine == -1) rawDialogueText = DIALOGUE_THANKS;
+                else if (game.currentDialogueLine == -2) rawDialogueText = TextFormat(DIALOGUE_COIN_REQUEST, COINS_REQUIRED);
+                else if (game.currentDialogueLine >= 0 && game.currentDialogueLine < (int)npc.lines.size()) rawDialogueText = npc.lines[game.currentDialogueLine];
+                SetUiText(dialogueText, rawDialogueText, ui);
+            }
+            else
+            {
+                game.activeNPC = -1;
+            }
+            game.textDisplayLength = min(game.textDisplayLength, (int)dialogueText.wrapped.length());
+            game.prevTextDisplayLength = min(game.prevTextDisplayLength, game.textDisplayLength);
+
+            // Wells and dams are only rebuilt when they differ, a rewind steps through many states
+            pollution.sources[factoryOutfall].active = game.factoryOutfallActive;
+            pollution.sources[treatmentPlant].active = game.treatmentPlantActive;
+            bool wellsMatch = (game.wellCount == (int)groundwater.wells.size());
+            for (int i = 0; wellsMatch && i < game.wellCount; ++i) wellsMatch = (groundwater.wells[i].x == game.wellX[i]);
+            if (!wellsMatch)
+            {
+                while (!groundwater.wells.empty()) RemoveGroundwaterWell(groundwater, (int)groundwater.wells.size() - 1);
+                for (int i = 0; i < game.wellCount; ++i) AddGroundwaterWell(groundwater, game.wellX[i], WELL_DEPTH, WELL_PUMP_RATE);
+            }
+            bool damsMatch = (game.damCount == (int)water.dams.size());
+            for (int i = 0; damsMatch && i < game.damCount; ++i) damsMatch = (GetWaterDamX(water, i) == game.damX[i]);
+            if (!damsMatch)
+            {
+                while (!water.dams.empty()) RemoveWaterDam(water, (int)water.dams.size() - 1);
+                for (int i = 0; i < game.damCount; ++i) AddWaterDam(water, game.damX[i], DAM_CREST, DAM_INTAKE_LEVEL, DAM_TURBINE_CAPACITY);
+            }
+            aralDragging = false;
+            if (game.finishTriggered && !wasFinished) RestartAnimator(animators[congratsAnimator]);
+        };
 
-            if (finishTexture.id != 0) UnloadTexture(finishTexture);
-            finishTexture = LoadTexture("finish.png");
+    // Backspace held rewinds through the last REWIND_FRAMES recorded frames
+    RewindBuffer rewind = CreateRewindBuffer();
+    bool rewinding = false;
+    long long rewindCursor = -1;
 
-            if (happyTexture.id != 0) UnloadTexture(happyTexture);
-            happyTexture = LoadTexture("kitty-happy.png");
+    if (!loadSnapshotPath.empty())
+    {
+        GameState loaded;
+        if (LoadGameState(loaded, loadSnapshotPath)) RestoreSnapshot(loaded);
+    }
 
-            if (congratsTexture.id != 0) UnloadTexture(congratsTexture);
-            congratsTexture = LoadTexture("congratulation.png");
+    // Asset files are watched for changes; caches built from a texture are rebuilt when it reloads
+    HotReloader* hotReloader = CreateHotReloader();
+    WatchAssetCache(assets, hotReloader, [&](const void* asset)
+        {
+            if (asset == &grassTexture || asset == &finishTexture) InvalidateStaticWorld(staticWorld);
+            InvalidateParallaxTexture(parallax, asset);
+            for (NPC& npc : npcs) npc.hasSpeech = (npc.speech != nullptr && npc.speech->frameCount != 0);
+        });
+    StartHotReloader(hotReloader);
 
-            for (int i = 0; i < SEG_COUNT; ++i)
-            {
-                if (biomeTextures[i].id != 0) UnloadTexture(biomeTextures[i]);
-                string filename = "biome" + to_string(i + 1) + ".png";
-                biomeTextures[i] = LoadTexture(filename.c_str());
-            }
+    SetTargetFPS(60);
+    
+    bool isDebugMode = false;
+    float updateSeconds = 0.0f;   // last frame from the top of the loop to BeginDrawing
 
-            // Reload Sounds
-            if (meow1Sound.frameCount != 0) UnloadSound(meow1Sound);
-            if (FileExists("meow1.wav")) meow1Sound = LoadSound("meow1.wav");
+    while (!WindowShouldClose())
+    {
+        float dt = GetFrameTime();
+        auto frameStart = chrono::high_resolution_clock::now();
 
-            if (meow2Sound.frameCount != 0) UnloadSound(meow2Sound);
-            if (FileExists("meow2.wav")) meow2Sound = LoadSound("meow2.wav");
+        // Last frame's environment step must be done before anything below reads or edits it
+        WaitSimStep(sim);
 
-            if (popSound.frameCount != 0) UnloadSound(popSound);
-            if (FileExists("pop.wav")) popSound = LoadSound("pop.wav");
+        if (IsWindowResized())
+        {
+            ResizeResolutionScaler(scaler, GetScreenWidth(), GetScreenHeight());
+            SetUiOutput(ui, scaler.output);
+        }
+        UpdateResolutionScaler(scaler, dt, updateSeconds);
 
-            if (vanishSound.frameCount != 0) UnloadSound(vanishSound);
-            if (FileExists("vanish.wav")) vanishSound = LoadSound("vanish.wav");
+        // Text is only laid out again after the HUD changed size
+        if (UpdateUiText(dialogueText, ui)) game.textDisplayLength = min(game.textDisplayLength, (int)dialogueText.wrapped.length());
+        
+        // Debug mode toggle
+        if (IsKeyPressed(KEY_F3))
+        {
+            isDebugMode = !isDebugMode;
+        }
 
-            if (crunchSound.frameCount != 0) UnloadSound(crunchSound);
-            if (FileExists("crunch.wav")) crunchSound = LoadSound("crunch.wav");
+        if (isDebugMode && IsKeyPressed(KEY_F4))
+        {
+            rainStress = !rainStress;
+        }
 
-            if (jumpSound.frameCount != 0) UnloadSound(jumpSound);
-            if (FileExists("jump.wav")) jumpSound = LoadSound("jump.wav");
+        if (isDebugMode && IsKeyPressed(KEY_F8))
+        {
+            spriteStress = !spriteStress;
+        }
 
-            if (sprintSound.frameCount != 0) UnloadSound(sprintSound);
-            if (FileExists("sprint.wav")) sprintSound = LoadSound("sprint.wav");
+        if (isDebugMode && IsKeyPressed(KEY_F9))
+        {
+            coinStress = !coinStress;
+        }
 
-            if (cheerSound.frameCount != 0) UnloadSound(cheerSound);
-            if (FileExists("cheer.wav")) cheerSound = LoadSound("cheer.wav");
-            
-            // Reassign Speech Pointers for NPCs
-            if (npcs.size() >= 5)
+        if (isDebugMode && IsKeyPressed(KEY_F6)) SaveSnapshot(CHECKPOINT_PATH);
+        if (isDebugMode && IsKeyPressed(KEY_F7))
+        {
+            GameState loaded;
+            if (LoadGameState(loaded, CHECKPOINT_PATH))
             {
-                npcs[0].speech = (meow1Sound.frameCount != 0 ? &meow1Sound : nullptr);
-                npcs[0].hasSpeech = (npcs[0].speech != nullptr);
-                
-                npcs[2].speech = (meow2Sound.frameCount != 0 ? &meow2Sound : nullptr);
-                npcs[2].hasSpeech = (npcs[2].speech != nullptr);
-                
-                npcs[4].speech = (meow1Sound.frameCount != 0 ? &meow1Sound : nullptr);
-                npcs[4].hasSpeech = (npcs[4].speech != nullptr);
+                RestoreSnapshot(loaded);
+                ClearRewindBuffer(rewind);
             }
         }
 
+        // Hot Reload Assets: changed files are picked up by the watcher, F5 queues all of them
+        if (IsKeyPressed(KEY_F5)) ReloadAllAssets(hotReloader);
+        ApplyHotReloads(hotReloader);
+
         isMoving = false;
+        jumpStarted = false;
 
-        if (!finishTriggered && !musicPlaylist.empty() && currentTrackIndex != -1)
+        if (!game.finishTriggered && !musicPlaylist.empty() && currentTrackIndex != -1)
         {
             UpdateMusicStream(musicPlaylist[currentTrackIndex]);
 
             // Mute background music if the player is in the secret room
-            int playerCenterXForMusic = player.x + player.width / 2;
+            int playerCenterXForMusic = game.player.x + game.player.width / 2;
             if (playerCenterXForMusic < 0)
             {
                 SetMusicVolume(musicPlaylist[currentTrackIndex], 0.0f);
@@ -664,88 +767,66 @@ int main(void)
             }
         }
 
-        // cat-crunch animation
-        catCrunchTimer += dt;
-        const float catCrunchFrameTime = 1.0f / (float)CATCRUNCH_FRAME_SPEED;
-        if (catCrunchTimer >= catCrunchFrameTime)
-        {
-            catCrunchTimer -= catCrunchFrameTime;
-            catCrunchFrame = (catCrunchFrame + 1) % CATCRUNCH_FRAME_COUNT;
-        }
-
-        // cat-cry animation
-        catCryTimer += dt;
-        const float catCryFrameTime = 1.0f / (float)CATCRY_FRAME_SPEED;
-        if (catCryTimer >= catCryFrameTime)
+        if (game.spinningCatVanishing)
         {
-            catCryTimer -= catCryFrameTime;
-            catCryFrame = (catCryFrame + 1) % CATCRY_FRAME_COUNT;
-        }
-
-        // cat-spinning animation
-        catSpinningTimer += dt;
-        const float catSpinningFrameTime = 1.0f / (float)CATSPINNING_FRAME_SPEED;
-        if (catSpinningTimer >= catSpinningFrameTime)
-        {
-            catSpinningTimer -= catSpinningFrameTime;
-            catSpinningFrame = (catSpinningFrame + 1) % CATSPINNING_FRAME_COUNT;
-        }
-
-        if (spinningCatVanishing)
-        {
-            spinningCatVanishTimer += dt;
-            if (spinningCatVanishTimer >= SPINNING_CAT_VANISH_DURATION)
+            game.spinningCatVanishTimer += dt;
+            if (game.spinningCatVanishTimer >= SPINNING_CAT_VANISH_DURATION)
             {
-                spinningCatVanished = true;
-                spinningCatVanishing = false;
+                game.spinningCatVanished = true;
+                game.spinningCatVanishing = false;
             }
             else
             {
                 // rapidly increase scale during vanishing
-                spinningCatScale = 1.5f + (spinningCatVanishTimer / SPINNING_CAT_VANISH_DURATION) * 5.0f;
+                game.spinningCatScale = 1.5f + (game.spinningCatVanishTimer / SPINNING_CAT_VANISH_DURATION) * 5.0f;
             }
         }
 
         // Jump update
-        if (isJumping)
+        if (game.isJumping)
         {
-            jumpTimer += dt;
-            int frameIndex = (int)floorf((jumpTimer / JUMP_DURATION) * (float)JUMP_FRAME_COUNT);
-            frameIndex = max(0, min(frameIndex, JUMP_FRAME_COUNT - 1));
-            jumpFrame = frameIndex;
+            game.jumpTimer += dt;
 
-            if (jumpTimer >= JUMP_DURATION)
+            if (game.jumpTimer >= JUMP_DURATION)
             {
-                isJumping = false;
-                jumpTimer = 0.0f;
-                jumpFrame = 0;
-                player.y = PLAYER_GROUND_Y;
+                game.isJumping = false;
+                game.jumpTimer = 0.0f;
+                game.player.y = PLAYER_GROUND_Y;
+
+                // Landing in water splashes it
+                float landX = game.player.x + game.player.width / 2.0f;
+                if (landX >= 0.0f && GetWaterDepthAt(water, landX) > 1.0f)
+                {
+                    SplashShallowWater(water, landX, game.player.width / 2.0f, SPLASH_STRENGTH);
+                    EmitParticleBurst(particles, PARTICLE_SPLASH, { landX, waterDatumY - GetWaterSurfaceAt(water, landX) },
+                                      SPLASH_PARTICLES, { 0.0f, -320.0f }, { 200.0f, 120.0f }, 0.8f);
+                }
             }
             else
             {
-                float t = jumpTimer;
+                float t = game.jumpTimer;
                 float T = JUMP_DURATION;
                 float s = 4.0f * JUMP_HEIGHT * (t / T) * (1.0f - (t / T));
-                player.y = PLAYER_GROUND_Y - s;
-                if (player.y < 0.0f) player.y = 0.0f;
+                game.player.y = PLAYER_GROUND_Y - s;
+                if (game.player.y < 0.0f) game.player.y = 0.0f;
             }
         }
 
         float speedMultiplier = (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) ? (isDebugMode ? 6.0f : 3.0f) : 1.0f;
 
-        // Movement (disabled during dialogue or when finishTriggered)
-        if (!finishTriggered && activeNPC == -1)
+        // Movement (disabled during dialogue, while rewinding or when finishTriggered)
+        if (!game.finishTriggered && game.activeNPC == -1 && !rewinding)
         {
             if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D))
             {
-                player.x += PLAYER_SPEED * speedMultiplier;
-                frameDirection = 1.0f;
+                game.player.x += PLAYER_SPEED * speedMultiplier;
+                game.frameDirection = 1.0f;
                 isMoving = true;
             }
             else if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A))
             {
-                player.x -= PLAYER_SPEED * speedMultiplier;
-                frameDirection = -1.0f;
+                game.player.x -= PLAYER_SPEED * speedMultiplier;
+                game.frameDirection = -1.0f;
                 isMoving = true;
             }
 
@@ -754,87 +835,69 @@ int main(void)
                 PlaySound(sprintSound);
             }
 
-            if (!isJumping && (IsKeyDown(KEY_SPACE) || IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)))
+            if (!game.isJumping && (IsKeyDown(KEY_SPACE) || IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)))
             {
-                isJumping = true;
-                jumpTimer = 0.0f;
-                jumpFrame = 0;
+                game.isJumping = true;
+                jumpStarted = true;
+                game.jumpTimer = 0.0f;
                 if (jumpSound.frameCount != 0) PlaySound(jumpSound);
+
+                // Kicking off from shallow water throws a few droplets
+                float takeoffX = game.player.x + game.player.width / 2.0f;
+                if (takeoffX >= 0.0f && GetWaterDepthAt(water, takeoffX) > 1.0f)
+                {
+                    EmitParticleBurst(particles, PARTICLE_SPLASH, { takeoffX, waterDatumY - GetWaterSurfaceAt(water, takeoffX) },
+                                      SPLASH_PARTICLES / 3, { 0.0f, -200.0f }, { 120.0f, 80.0f }, 0.6f);
+                }
             }
         }
 
-        player.x = max(SECRET_X_OFFSET, min(player.x, (float)(WORLD_WIDTH - (int)player.width)));
+        game.player.x = max(SECRET_X_OFFSET, min(game.player.x, (float)(WORLD_WIDTH - (int)game.player.width)));
 
         // Check collision with finish flag
-        if (!finishTriggered && CheckCollisionRecs(player, finishFlagBounds))
-        {
-            finishTriggered = true;
-            activeNPC = -1;
-            textDisplayLength = 0;
-            prevTextDisplayLength = 0;
-            charTimer = 0.0f;
-            punctuationPauseRemaining = 0.0f;
-            mouthOpen = false;
-            mouthTimer = 0.0f;
-            happyTimer = 0.0f;
-            congratsTimer = 0.0f;
+        if (!game.finishTriggered && CheckCollisionRecs(game.player, finishFlagBounds))
+        {
+            game.finishTriggered = true;
+            game.activeNPC = -1;
+            game.textDisplayLength = 0;
+            game.prevTextDisplayLength = 0;
+            game.charTimer = 0.0f;
+            game.punctuationPauseRemaining = 0.0f;
+            game.mouthOpen = false;
+            game.mouthTimer = 0.0f;
+            RestartAnimator(animators[congratsAnimator]);
             if (!musicPlaylist.empty() && currentTrackIndex != -1) StopMusicStream(musicPlaylist[currentTrackIndex]);
             
             if (cheerSound.frameCount != 0) PlaySound(cheerSound);
+
+            // A finished session starts over next time
+            if (!autosavePath.empty()) remove(autosavePath.c_str());
         }
 
         // Determine current segment and manage fade
-        int playerCenterX = player.x + player.width / 2;
+        int playerCenterX = game.player.x + game.player.width / 2;
         int segIndex = (playerCenterX < 0) ? 0 : (playerCenterX / SEG_W);
         segIndex = max(0, min(segIndex, SEG_COUNT - 1));
 
-        if (displayedBiome == -1)
+        if (game.displayedBiome == -1)
         {
-            displayedBiome = segIndex;
-            fadingFrom = -1;
-            fadingTo = -1;
-            fadeTimer = 0.0f;
+            game.displayedBiome = segIndex;
+            game.fadingFrom = -1;
+            game.fadingTo = -1;
+            game.fadeTimer = 0.0f;
         }
-        else if (segIndex != displayedBiome && segIndex != fadingTo)
+        else if (segIndex != game.displayedBiome && segIndex != game.fadingTo)
         {
-            fadingFrom = displayedBiome;
-            fadingTo = segIndex;
-            fadeTimer = 0.0f;
-        }
-
-        // Walking / Running animation
-        if (!isJumping && !finishTriggered)
-        {
-            if (isMoving)
-            {
-                if (speedMultiplier > 1.0f) // Running
-                {
-                    runFrameCounter++;
-                    int runFrameDelay = max(1, (int)round(60.0f / (float)RUN_FRAME_SPEED));
-                    if (runFrameCounter >= runFrameDelay)
-                    {
-                        runFrameCounter = 0;
-                        currentRunFrame = (currentRunFrame + 1) % RUN_FRAME_COUNT;
-                    }
-                }
-                else // Walking
-                {
-                    frameCounter++;
-                    int frameDelay = max(1, (int)round(60.0f / (float)FRAME_SPEED));
-                    if (frameCounter >= frameDelay)
-                    {
-                        frameCounter = 0;
-                        currentFrame = (currentFrame + 1) % FRAME_COUNT;
-                    }
-                }
-            }
+            game.fadingFrom = game.displayedBiome;
+            game.fadingTo = segIndex;
+            game.fadeTimer = 0.0f;
         }
 
         // Check nearby NPC
         int foundNear = -1;
         for (size_t i = 0; i < npcs.size(); ++i)
         {
-            if (CheckCollisionRecs(player, npcs[i].interactionArea))
+            if (CheckCollisionRecs(game.player, npcs[i].interactionArea))
             {
                 foundNear = (int)i;
                 break;
@@ -842,7 +905,7 @@ int main(void)
         }
 
         bool nearSpinningCat = false;
-        if (!spinningCatVanished && !spinningCatVanishing && CheckCollisionRecs(player, spinningCatInteractionArea))
+        if (!game.spinningCatVanished && !game.spinningCatVanishing && CheckCollisionRecs(game.player, spinningCatInteractionArea))
         {
             nearSpinningCat = true;
         }
@@ -851,236 +914,373 @@ int main(void)
 
         if (nearSpinningCat && IsKeyPressed(KEY_ENTER))
         {
-            spinningCatVanishing = true;
+            game.spinningCatVanishing = true;
             enterConsumedForStart = true;
             if (vanishSound.frameCount != 0) PlaySound(vanishSound);
         }
 
         // Coin collection system
-        for (auto& coin : activeCoins) {
+        for (int i = 0; i < game.activeCoinCount; ++i) {
+            Coin& coin = game.activeCoins[i];
             if (coin.active) {
-                if (CheckCollisionCircleRec(coin.position, 25, player)) {
+                if (CheckCollisionCircleRec(coin.position, 25, game.player)) {
                     coin.active = false;
-                    collectedCoins++;
+                    game.collectedCoins++;
+                    EmitParticleBurst(particles, PARTICLE_SPARK, coin.position, COIN_BURST_PARTICLES, { 0.0f, -120.0f }, { 220.0f, 220.0f }, 0.7f);
                     if (popSound.frameCount != 0) PlaySound(popSound);
                 }
             }
         }
 
         // Start dialogue
-        if (!finishTriggered && foundNear != -1 && activeNPC == -1 && IsKeyPressed(KEY_ENTER) && !enterConsumedForStart)
+        if (!game.finishTriggered && foundNear != -1 && game.activeNPC == -1 && IsKeyPressed(KEY_ENTER) && !enterConsumedForStart)
         {
-            activeNPC = foundNear;
+            game.activeNPC = foundNear;
 
-            if (!npcStates[activeNPC].paid)
+            if (!game.npcStates[game.activeNPC].paid)
             {
-                if (collectedCoins >= COINS_REQUIRED)
+                if (game.collectedCoins >= COINS_REQUIRED)
                 {
                     // Faza: Podziękowanie (stan przejściowy)
-                    npcStates[activeNPC].paid = true;
-                    collectedCoins -= COINS_REQUIRED;
-                    activeCoins.clear();
-                    rawDialogueText = "Dziękuję! Te monety pomogą mi w badaniach. Teraz mogę przekazać ci moją wiedzę:";
-                    currentDialogueLine = -1; // Specjalna wartość: po tym Enterze zaczniemy od linii 0
+                    game.npcStates[game.activeNPC].paid = true;
+                    game.collectedCoins -= COINS_REQUIRED;
+                    game.activeCoinCount = 0;
+                    rawDialogueText = DIALOGUE_THANKS;
+                    game.currentDialogueLine = -1; // Specjalna wartość: po tym Enterze zaczniemy od linii 0
                 }
                 else
                 {
                     // Faza: Prośba o monety
-                    rawDialogueText = TextFormat("Witaj! Abyś mógł iść dalej, musisz zebrać %d monet rozrzuconych w powietrzu.", COINS_REQUIRED);
-                    if (activeCoins.empty()) SpawnCoins(activeCoins, npcs[activeNPC].bounds.x - 600, npcs[activeNPC].bounds.x + 600);
-                    currentDialogueLine = -2; // Specjalna wartość: po tym Enterze po prostu zamkniemy dialog
+                    rawDialogueText = TextFormat(DIALOGUE_COIN_REQUEST, COINS_REQUIRED);
+                    if (game.activeCoinCount == 0) SpawnCoins(game, npcs[game.activeNPC].bounds.x - 600, npcs[game.activeNPC].bounds.x + 600);
+                    game.currentDialogueLine = -2; // Specjalna wartość: po tym Enterze po prostu zamkniemy dialog
                 }
             }
             else
             {
                 // Normalny dialog (NPC już opłacony)
-                currentDialogueLine = 0;
-                rawDialogueText = npcs[activeNPC].lines[currentDialogueLine];
+                game.currentDialogueLine = 0;
+                rawDialogueText = npcs[game.activeNPC].lines[game.currentDialogueLine];
             }
 
-            wrappedDialogueText = WordWrapText(rawDialogueText, MAX_TEXT_WIDTH, uiFont, TEXT_FONT_SIZE, 4.0f);
-            textDisplayLength = 0;
-            prevTextDisplayLength = 0;
-            charTimer = 0.0f;
-            punctuationPauseRemaining = 0.0f;
-            mouthOpen = false;
-            mouthTimer = 0.0f;
+            SetUiText(dialogueText, rawDialogueText, ui);
+            game.textDisplayLength = 0;
+            game.prevTextDisplayLength = 0;
+            game.charTimer = 0.0f;
+            game.punctuationPauseRemaining = 0.0f;
+            game.mouthOpen = false;
+            game.mouthTimer = 0.0f;
             enterConsumedForStart = true;
 
-            int sid = npcs[activeNPC].spriteId;
-            if (sid == 1 && popSound.frameCount != 0) PlaySound(popSound);
-            if (sid == 2 && crunchSound.frameCount != 0) PlaySound(crunchSound);
+            int sid = npcs[game.activeNPC].spriteId;
+            if (sid == CLIP_CAT_POP && popSound.frameCount != 0) PlaySound(popSound);
+            if (sid == CLIP_CAT_CRUNCH && crunchSound.frameCount != 0) PlaySound(crunchSound);
         }
 
         // Leave dialogue if player exits area
-        if (!finishTriggered && foundNear == -1 && activeNPC != -1)
+        if (!game.finishTriggered && foundNear == -1 && game.activeNPC != -1)
         {
-            int sid = npcs[activeNPC].spriteId;
-            if (sid == 1 && popSound.frameCount != 0) StopSound(popSound);
-            if (sid == 2 && crunchSound.frameCount != 0) StopSound(crunchSound);
+            int sid = npcs[game.activeNPC].spriteId;
+            if (sid == CLIP_CAT_POP && popSound.frameCount != 0) StopSound(popSound);
+            if (sid == CLIP_CAT_CRUNCH && crunchSound.frameCount != 0) StopSound(crunchSound);
 
-            activeNPC = -1;
+            game.activeNPC = -1;
             rawDialogueText.clear();
-            wrappedDialogueText.clear();
-            textDisplayLength = 0;
-            prevTextDisplayLength = 0;
-            charTimer = 0.0f;
-            punctuationPauseRemaining = 0.0f;
-            mouthOpen = false;
-            mouthTimer = 0.0f;
+            SetUiText(dialogueText, "", ui);
+            game.textDisplayLength = 0;
+            game.prevTextDisplayLength = 0;
+            game.charTimer = 0.0f;
+            game.punctuationPauseRemaining = 0.0f;
+            game.mouthOpen = false;
+            game.mouthTimer = 0.0f;
         }
 
         // Advance/skip dialogue
-        if (!finishTriggered && activeNPC != -1 && IsKeyPressed(KEY_ENTER) && !enterConsumedForStart)
+        if (!game.finishTriggered && game.activeNPC != -1 && IsKeyPressed(KEY_ENTER) && !enterConsumedForStart)
         {
-            int sid = npcs[activeNPC].spriteId;
+            int sid = npcs[game.activeNPC].spriteId;
 
-            if (textDisplayLength < (int)wrappedDialogueText.length())
+            if (game.textDisplayLength < (int)dialogueText.wrapped.length())
             {
-                prevTextDisplayLength = textDisplayLength;
-                textDisplayLength = (int)wrappedDialogueText.length();
+                game.prevTextDisplayLength = game.textDisplayLength;
+                game.textDisplayLength = (int)dialogueText.wrapped.length();
 
-                for (int k = prevTextDisplayLength; k < textDisplayLength; ++k)
+                for (int k = game.prevTextDisplayLength; k < game.textDisplayLength; ++k)
                 {
-                    PlayDialogueCharSound(activeNPC, wrappedDialogueText[k]);
+                    PlayDialogueCharSound(game.activeNPC, dialogueText.wrapped[k]);
                 }
 
-                punctuationPauseRemaining = 0.0f;
-                charTimer = 0.0f;
+                game.punctuationPauseRemaining = 0.0f;
+                game.charTimer = 0.0f;
 
-                if (sid == 1 && popSound.frameCount != 0) StopSound(popSound);
+                if (sid == CLIP_CAT_POP && popSound.frameCount != 0) StopSound(popSound);
             }
             else
             {
                 // Logika przechodzenia między fazami dialogu
-                if (currentDialogueLine == -1)
+                if (game.currentDialogueLine == -1)
                 {
                     // Właśnie skończyliśmy czytać podziękowanie -> zacznij od faktycznej pierwszej linii (0)
-                    currentDialogueLine = 0;
+                    game.currentDialogueLine = 0;
                 }
-                else if (currentDialogueLine == -2)
+                else if (game.currentDialogueLine == -2)
                 {
                     // Właśnie skończyliśmy czytać prośbę o monety -> wymuś zamknięcie dialogu
-                    currentDialogueLine = (int)npcs[activeNPC].lines.size();
+                    game.currentDialogueLine = (int)npcs[game.activeNPC].lines.size();
                 }
                 else
                 {
                     // Normalne przewijanie linii edukacyjnych
-                    currentDialogueLine++;
+                    game.currentDialogueLine++;
                 }
 
-                if (currentDialogueLine < (int)npcs[activeNPC].lines.size())
+                if (game.currentDialogueLine < (int)npcs[game.activeNPC].lines.size())
                 {
-                    rawDialogueText = npcs[activeNPC].lines[currentDialogueLine];
-                    wrappedDialogueText = WordWrapText(rawDialogueText, MAX_TEXT_WIDTH, uiFont, TEXT_FONT_SIZE, 4.0f);
-                    textDisplayLength = 0;
-                    prevTextDisplayLength = 0;
-                    charTimer = 0.0f;
-                    punctuationPauseRemaining = 0.0f;
-                    mouthOpen = false;
-                    mouthTimer = 0.0f;
-
-                    if (sid == 1 && !(popSound.frameCount != 0 && IsSoundPlaying(popSound)) && popSound.frameCount != 0) PlaySound(popSound);
+                    rawDialogueText = npcs[game.activeNPC].lines[game.currentDialogueLine];
+                    SetUiText(dialogueText, rawDialogueText, ui);
+                    game.textDisplayLength = 0;
+                    game.prevTextDisplayLength = 0;
+                    game.charTimer = 0.0f;
+                    game.punctuationPauseRemaining = 0.0f;
+                    game.mouthOpen = false;
+                    game.mouthTimer = 0.0f;
+
+                    if (sid == CLIP_CAT_POP && !(popSound.frameCount != 0 && IsSoundPlaying(popSound)) && popSound.frameCount != 0) PlaySound(popSound);
                 }
                 else
                 {
                     // Zamknięcie dialogu
-                    if (sid == 1 && popSound.frameCount != 0) StopSound(popSound);
-                    if (sid == 2 && crunchSound.frameCount != 0) StopSound(crunchSound);
+                    if (sid == CLIP_CAT_POP && popSound.frameCount != 0) StopSound(popSound);
+                    if (sid == CLIP_CAT_CRUNCH && crunchSound.frameCount != 0) StopSound(crunchSound);
 
-                    activeNPC = -1;
+                    game.activeNPC = -1;
                     rawDialogueText.clear();
-                    wrappedDialogueText.clear();
-                    textDisplayLength = 0;
-                    prevTextDisplayLength = 0;
-                    charTimer = 0.0f;
-                    punctuationPauseRemaining = 0.0f;
-                    mouthOpen = false;
-                    mouthTimer = 0.0f;
+                    SetUiText(dialogueText, "", ui);
+                    game.textDisplayLength = 0;
+                    game.prevTextDisplayLength = 0;
+                    game.charTimer = 0.0f;
+                    game.punctuationPauseRemaining = 0.0f;
+                    game.mouthOpen = false;
+                    game.mouthTimer = 0.0f;
                 }
             }
         }
 
         // Reveal text with punctuation pause
-        if (!finishTriggered && activeNPC != -1 && textDisplayLength < (int)wrappedDialogueText.length())
+        if (!game.finishTriggered && game.activeNPC != -1 && game.textDisplayLength < (int)dialogueText.wrapped.length())
         {
-            if (punctuationPauseRemaining > 0.0f)
+            if (game.punctuationPauseRemaining > 0.0f)
             {
-                punctuationPauseRemaining -= dt;
-                if (punctuationPauseRemaining <= 0.0f)
+                game.punctuationPauseRemaining -= dt;
+                if (game.punctuationPauseRemaining <= 0.0f)
                 {
-                    punctuationPauseRemaining = 0.0f;
-                    charTimer = 0.0f;
+                    game.punctuationPauseRemaining = 0.0f;
+                    game.charTimer = 0.0f;
                 }
             }
             else
             {
-                charTimer += dt;
-                while (charTimer >= charInterval && textDisplayLength < (int)wrappedDialogueText.length())
+                game.charTimer += dt;
+                while (game.charTimer >= charInterval && game.textDisplayLength < (int)dialogueText.wrapped.length())
                 {
-                    charTimer -= charInterval;
-                    int revealIndex = textDisplayLength;
-                    char ch = wrappedDialogueText[revealIndex];
-                    textDisplayLength++;
-                    PlayDialogueCharSound(activeNPC, ch);
+                    game.charTimer -= charInterval;
+                    int revealIndex = game.textDisplayLength;
+                    char ch = dialogueText.wrapped[revealIndex];
+                    game.textDisplayLength++;
+                    PlayDialogueCharSound(game.activeNPC, ch);
 
                     if (PUNCTUATION_CHARS.find(ch) != string::npos)
                     {
-                        punctuationPauseRemaining = PUNCTUATION_PAUSE;
+                        game.punctuationPauseRemaining = PUNCTUATION_PAUSE;
                         break;
                     }
                 }
 
-                if (textDisplayLength >= (int)wrappedDialogueText.length())
+                if (game.textDisplayLength >= (int)dialogueText.wrapped.length())
                 {
-                    int sid = npcs[activeNPC].spriteId;
-                    if (sid == 1 && popSound.frameCount != 0) StopSound(popSound);
+                    int sid = npcs[game.activeNPC].spriteId;
+                    if (sid == CLIP_CAT_POP && popSound.frameCount != 0) StopSound(popSound);
                 }
             }
         }
 
         // Ensure crunch loops during conversation
-        if (!finishTriggered && activeNPC != -1 && npcs[activeNPC].spriteId == 2)
+        if (!game.finishTriggered && game.activeNPC != -1 && npcs[game.activeNPC].spriteId == CLIP_CAT_CRUNCH)
         {
             if (!(crunchSound.frameCount != 0 && IsSoundPlaying(crunchSound)) && crunchSound.frameCount != 0) PlaySound(crunchSound);
         }
 
         // Mouth animation while text reveals
-        if (!finishTriggered && activeNPC != -1 && textDisplayLength < (int)wrappedDialogueText.length())
+        if (!game.finishTriggered && game.activeNPC != -1 && game.textDisplayLength < (int)dialogueText.wrapped.length())
+        {
+            game.mouthTimer += dt;
+            if (game.mouthTimer >= mouthToggleInterval)
+            {
+                game.mouthOpen = !game.mouthOpen;
+                game.mouthTimer = 0.0f;
+            }
+        }
+        else
         {
-            mouthTimer += dt;
-            if (mouthTimer >= mouthToggleInterval)
+            game.mouthOpen = false;
+            game.mouthTimer = 0.0f;
+        }
+
+        // Water simulation: the Aral lesson drains the basin live while the player listens
+        bool aralLessonActive = (game.activeNPC != -1 && game.activeNPC == aralNpc && game.npcStates[game.activeNPC].paid);
+
+        // Aral time-lapse: 5 starts and ends it near the Aral NPC, ',' and '.' scrub, the timeline can be dragged.
+        // The basin is held at the historical level instead of draining.
+        bool nearAral = fabsf(game.player.x + game.player.width / 2.0f - ARAL_NPC_X) < SEG_W / 2.0f;
+        if (nearAral && aral.loaded && IsKeyPressed(KEY_FIVE))
+        {
+            game.aralTimelapse = !game.aralTimelapse;
+            game.aralYear = GetAralScenarioFirstYear(aral);
+        }
+        if (!nearAral) game.aralTimelapse = false;
+        if (game.aralTimelapse)
+        {
+            const float firstYear = GetAralScenarioFirstYear(aral);
+            const float lastYear = GetAralScenarioLastYear(aral);
+            int direction = 1;
+            Rectangle grab = { aralTimeline.x - 10.0f, aralTimeline.y - 10.0f, aralTimeline.width + 20.0f, aralTimeline.height + 20.0f };
+            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && CheckCollisionPointRec(GetMousePosition(), grab)) aralDragging = true;
+            if (!IsMouseButtonDown(MOUSE_BUTTON_LEFT)) aralDragging = false;
+
+            if (aralDragging)
+            {
+                float t = (GetMousePosition().x - aralTimeline.x) / aralTimeline.width;
+                float year = firstYear + fminf(1.0f, fmaxf(0.0f, t)) * (lastYear - firstYear);
+                if (year < game.aralYear) direction = -1;
+                game.aralYear = year;
+            }
+            else if (IsKeyDown(KEY_COMMA))
             {
-                mouthOpen = !mouthOpen;
-                mouthTimer = 0.0f;
+                game.aralYear -= ARAL_SCRUB_YEARS_PER_SECOND * dt;
+                direction = -1;
             }
+            else if (IsKeyDown(KEY_PERIOD))
+            {
+                game.aralYear += ARAL_SCRUB_YEARS_PER_SECOND * dt;
+            }
+            else
+            {
+                game.aralYear += ARAL_TIMELAPSE_YEARS_PER_SECOND * dt;
+            }
+            game.aralYear = fminf(lastYear, fmaxf(firstYear, game.aralYear));
+
+            PrefetchAralScenario(aral, game.aralYear, direction);
+            aralNow = SampleAralScenario(aral, game.aralYear);
+            float fill = (aralNow.level - ARAL_DRY_LEVEL) / (aralStart.level - ARAL_DRY_LEVEL);
+            water.regions[aralDrainRegion].targetLevel = WATER_START_LEVEL * fminf(1.0f, fmaxf(0.0f, fill));
         }
         else
         {
-            mouthOpen = false;
-            mouthTimer = 0.0f;
+            aralDragging = false;
+            water.regions[aralDrainRegion].targetLevel = -1.0f;
+        }
+        water.regions[aralDrainRegion].active = aralLessonActive || game.aralTimelapse;
+
+        // Full resolution only around last frame's view, the rest of the river runs coarse
+        float focusMinX = camera.target.x - camera.offset.x / camera.zoom;
+        SetShallowWaterFocus(water, focusMinX, focusMinX + (float)SCREEN_WIDTH / camera.zoom);
+
+        // Player toggles the pollution sources
+        if (IsKeyPressed(KEY_ONE)) pollution.sources[factoryOutfall].active = !pollution.sources[factoryOutfall].active;
+        if (IsKeyPressed(KEY_TWO)) pollution.sources[treatmentPlant].active = !pollution.sources[treatmentPlant].active;
+
+        // Wells: 3 drills one under the player, 4 caps the nearest
+        float wellX = game.player.x + game.player.width / 2.0f;
+        if (IsKeyPressed(KEY_THREE))
+        {
+            bool crowded = false;
+            for (const GroundwaterWell& w : groundwater.wells) crowded = crowded || fabsf(w.x - wellX) < WELL_MIN_SPACING;
+            if (!crowded) AddGroundwaterWell(groundwater, wellX, WELL_DEPTH, WELL_PUMP_RATE);
+        }
+        if (IsKeyPressed(KEY_FOUR) && !groundwater.wells.empty())
+        {
+            int nearest = 0;
+            for (int i = 1; i < (int)groundwater.wells.size(); ++i)
+                if (fabsf(groundwater.wells[i].x - wellX) < fabsf(groundwater.wells[nearest].x - wellX)) nearest = i;
+            RemoveGroundwaterWell(groundwater, nearest);
+        }
+
+        // Dams: 6 builds one at the player, or tears down the one standing there
+        if (IsKeyPressed(KEY_SIX))
+        {
+            float damX = game.player.x + game.player.width / 2.0f;
+            int nearest = -1;
+            for (int i = 0; i < (int)water.dams.size(); ++i)
+                if (fabsf(GetWaterDamX(water, i) - damX) < DAM_MIN_SPACING && (nearest == -1 || fabsf(GetWaterDamX(water, i) - damX) < fabsf(GetWaterDamX(water, nearest) - damX))) nearest = i;
+            if (nearest != -1) RemoveWaterDam(water, nearest);
+            else if (damX > 128.0f) AddWaterDam(water, damX, DAM_CREST, DAM_INTAKE_LEVEL, DAM_TURBINE_CAPACITY);
+        }
+
+        // Kiosk autosave, a crash resumes from at most one interval back
+        if (!autosavePath.empty() && !game.finishTriggered)
+        {
+            autosaveTimer += dt;
+            if (autosaveTimer >= SNAPSHOT_AUTOSAVE_INTERVAL)
+            {
+                autosaveTimer = 0.0f;
+                SaveSnapshot(autosavePath);
+            }
         }
 
         // Advance fade timer if crossfading
-        if (fadingTo != -1)
+        if (game.fadingTo != -1)
         {
-            fadeTimer += dt;
-            if (fadeTimer >= FADE_DURATION)
+            game.fadeTimer += dt;
+            if (game.fadeTimer >= FADE_DURATION)
             {
-                displayedBiome = fadingTo;
-                fadingFrom = -1;
-                fadingTo = -1;
-                fadeTimer = 0.0f;
+                game.displayedBiome = game.fadingTo;
+                game.fadingFrom = -1;
+                game.fadingTo = -1;
+                game.fadeTimer = 0.0f;
             }
         }
 
-        // If finish triggered update happy animation timer and determine if finished
-        if (finishTriggered)
+        // Rewind: the frame's update is overwritten by an older recorded state; on release the
+        // history after it is dropped and recording carries on from there
+        if (IsKeyDown(KEY_BACKSPACE) && rewind.newest >= 0 && !game.finishTriggered)
+        {
+            if (!rewinding) rewindCursor = rewind.newest;
+            rewinding = true;
+            rewindCursor = max(rewind.oldest, rewindCursor - REWIND_SPEED);
+            GameState past;
+            if (RestoreRewindFrame(rewind, rewindCursor, past)) RestoreSnapshot(past);
+        }
+        else
+        {
+            if (rewinding) TruncateRewindBuffer(rewind, rewindCursor);
+            rewinding = false;
+            CaptureLessonSettings();
+            RecordRewindFrame(rewind, game);
+        }
+
+        // Talking NPCs open their mouth on the manual two-frame clips
+        for (size_t i = 0; i < npcs.size(); ++i)
+        {
+            Animator& a = animators[npcs[i].animator];
+            if (clips[a.clip].loopMode == ANIM_MANUAL) a.frame = ((int)i == game.activeNPC && game.mouthOpen) ? 1 : 0;
+        }
+
+        // Player animation state (walk/run only while moving on the ground)
+        PlayerAnimInput playerAnimInput;
+        playerAnimInput.moving = isMoving;
+        playerAnimInput.running = speedMultiplier > 1.0f;
+        playerAnimInput.jumping = game.isJumping;
+        playerAnimInput.jumpStarted = jumpStarted;
+        playerAnimInput.celebrating = game.finishTriggered;
+        UpdatePlayerAnimMachine(playerAnim, playerAnimInput, animators, clips, dt);
+
+        // Advance every sprite animation in one pass
+        UpdateAnimators(animators, clips, dt);
+
+        // If finish triggered determine if the happy animation finished
+        if (game.finishTriggered)
         {
-            happyTimer += dt;
-            congratsTimer += dt;
-            int totalFramesPlayed = (int)floorf(happyTimer / HAPPY_FRAME_TIME);
-            if (totalFramesPlayed >= HAPPY_FRAME_COUNT * HAPPY_LOOPS)
+            if (animators[playerAnim.animator].loops >= HAPPY_LOOPS)
             {
                 // finished all loops -> exit main loop to allow cleanup and close
                 break;
@@ -1088,7 +1288,7 @@ int main(void)
         }
 
         // Camera follow
-        camera.target = { player.x + player.width / 2.0f, player.y + player.height / 2.0f };
+        camera.target = { game.player.x + game.player.width / 2.0f, game.player.y + game.player.height / 2.0f };
         if (playerCenterX < 0.0f)
         {
             camera.target.x = SECRET_X_OFFSET / 2.0f;
@@ -1105,36 +1305,36 @@ int main(void)
         }
         camera.target.y = (float)SCREEN_HEIGHT / 2.0f;
 
-        // Draw
+        // Bake parallax layers for the current and neighbouring biomes before drawing starts
+        UpdateParallaxCache(parallax, segIndex);
+
+        float viewMinX = camera.target.x - camera.offset.x / camera.zoom;
+        float viewMaxX = viewMinX + (float)SCREEN_WIDTH / camera.zoom;
+        UpdateStaticWorld(staticWorld, viewMinX, viewMaxX);
+
+        // Rain follows the view and the water-cycle precipitation under it
+        particles.emitters[rainEmitter].position = { (viewMinX + viewMaxX) * 0.5f, -20.0f };
+        particles.emitters[rainEmitter].rate = rainStress ? RAIN_STRESS_RATE : GetWaterCyclePrecipitation(waterCycle, viewMinX, viewMaxX) * RAIN_DROPS_PER_MM_H;
+        UpdateParticles(particles, dt);
+        UpdateWaterRenderer(waterRenderer, water, &pollution, viewMinX, viewMaxX, waterDatumY);
+
+        // Draw the world at the scaler's resolution, then upscale it under the HUD
+        updateSeconds = chrono::duration<float>(chrono::high_resolution_clock::now() - frameStart).count();
         BeginDrawing();
+        BeginScaledWorld(scaler);
         ClearBackground(RAYWHITE);
 
-        // Draw static screen-space biome backgrounds with fade
-        auto drawBiomeTex = [&](int idx, float alphaFactor) {
-            if (idx < 0 || idx >= SEG_COUNT) return false;
-            if (biomeTextures[idx].id != 0)
-            {
-                Rectangle src = { 0.0f, 0.0f, (float)biomeTextures[idx].width, (float)biomeTextures[idx].height };
-                Rectangle dst = { 0.0f, 0.0f, (float)SCREEN_WIDTH, (float)SCREEN_HEIGHT };
-                Color c = WHITE;
-                c.a = (unsigned char)(255 * alphaFactor);
-                DrawTexturePro(biomeTextures[idx], src, dst, { 0, 0 }, 0.0f, c);
-                return true;
-            }
-            return false;
-            };
-
-        if (displayedBiome >= 0)
+        // Draw parallax biome backgrounds with fade
+        if (game.displayedBiome >= 0)
         {
             if (camera.target.x > 0)
             {
-                if (fadingTo == -1) {
-                    drawBiomeTex(displayedBiome, 1.0f);
+                if (game.fadingTo == -1) {
+                    DrawParallaxBackground(biomeBackground, parallax, game.displayedBiome, -1, 0.0f, camera.target.x);
                 }
                 else {
-                    float t = fmin(1.0f, fadeTimer / FADE_DURATION);
-                    drawBiomeTex(fadingFrom, 1.0f - t);
-                    drawBiomeTex(fadingTo, t);
+                    float t = fmin(1.0f, game.fadeTimer / FADE_DURATION);
+                    DrawParallaxBackground(biomeBackground, parallax, game.fadingFrom, game.fadingTo, t, camera.target.x);
                 }
             }
         }
@@ -1143,326 +1343,407 @@ int main(void)
             DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, SKYBLUE);
         }
 
+        // Aral time-lapse: dried seabed rises from the horizon and dust hazes the sky as the sea shrinks
+        if (game.aralTimelapse && aralStart.area > 0.0f)
+        {
+            const Color seabed = { 214, 186, 140, 255 };
+            float loss = fminf(1.0f, fmaxf(0.0f, 1.0f - aralNow.area / aralStart.area));
+            int groundY = SCREEN_HEIGHT - GROUND_HEIGHT;
+            int bandH = (int)(loss * SCREEN_HEIGHT * 0.45f);
+            DrawRectangle(0, 0, SCREEN_WIDTH, groundY, ColorAlpha(seabed, 0.2f * loss));
+            DrawRectangleGradientV(0, groundY - bandH, SCREEN_WIDTH, bandH, ColorAlpha(seabed, 0.0f), ColorAlpha(seabed, 0.85f * loss));
+        }
+
         BeginMode2D(camera);
 
-        // Draw secret room
-        DrawRectangle(SECRET_X_OFFSET, 0, SECRET_ROOM_WIDTH, SCREEN_HEIGHT, CLITERAL(Color){ 10, 10, 30, 255 });
+        // Draw baked static world (secret room, ground, finish flag)
+        DrawStaticWorld(staticWorld, viewMinX, viewMaxX);
 
-        if (catSpinningTexture.id != 0 && !spinningCatVanished)
+        // Queue the world sprites; the batch draws them by layer, grouped by texture
+        // Spinning cat: the shader animates it, only its size and fade are updated here
+        SetAnimatedSpriteVisible(animatedSprites, spinningCatSprite, !game.spinningCatVanished);
+        if (IsClipDrawable(spinningClip) && !game.spinningCatVanished)
         {
-            float destW = CATSPINNING_FRAME_WIDTH * spinningCatScale;
-            float destH = CATSPINNING_FRAME_HEIGHT * spinningCatScale;
+            float destW = spinningClip.frameWidth * game.spinningCatScale;
+            float destH = spinningClip.frameHeight * game.spinningCatScale;
             float destX = SECRET_X_OFFSET + (SECRET_ROOM_WIDTH / 2.0f) - (destW / 2.0f);
             float destY = SCREEN_HEIGHT - GROUND_HEIGHT - destH;
             
             Color c = WHITE;
-            if (spinningCatVanishing)
+            if (game.spinningCatVanishing)
             {
-                float alpha = 1.0f - (spinningCatVanishTimer / SPINNING_CAT_VANISH_DURATION);
+                float alpha = 1.0f - (game.spinningCatVanishTimer / SPINNING_CAT_VANISH_DURATION);
                 c.a = (unsigned char)(255 * fmax(0.0f, alpha));
             }
             
-            Rectangle srcRec = { (float)(catSpinningFrame * CATSPINNING_FRAME_WIDTH), 0.0f, (float)CATSPINNING_FRAME_WIDTH, (float)CATSPINNING_FRAME_HEIGHT };
-            Rectangle destRec = { destX, destY, destW, destH };
-            DrawTexturePro(catSpinningTexture, srcRec, destRec, { 0, 0 }, 0.0f, c);
-            
-            // Interaction border for spinning cat
-            if (!spinningCatVanishing && isDebugMode)
-            {
-                Color zoneColor = nearSpinningCat ? RED : YELLOW;
-                DrawRectangleLinesEx(spinningCatInteractionArea, 2, zoneColor);
-            }
+            SetAnimatedSprite(animatedSprites, spinningCatSprite, { destX, destY, destW, destH }, c);
         }
 
-        // Draw coins
-        for (const auto& coin : activeCoins) {
-            if (coin.active) {
-                float animY = coin.position.y + sinf((float)GetTime() * 3.0f + coin.bobOffset) * 10.0f;
-                if (coinTexture.id != 0) {
-                    float scale = 40.0f / (float)coinTexture.width;
-                    DrawTextureEx(coinTexture, { coin.position.x - 20, animY - 20 }, 0, scale, WHITE);
-                }
-                else {
-                    DrawCircle((int)coin.position.x, (int)animY, 15, YELLOW);
-                    DrawCircleLines((int)coin.position.x, (int)animY, 15, GOLD);
-                }
-            }
-        }
-
-        // Draw tiled grass
-        int tileW = (grassTexture.id != 0) ? grassTexture.width : GRASS_TILE_SIZE;
-        int groundY = SCREEN_HEIGHT - GROUND_HEIGHT;
-        for (int gx = 0; gx < WORLD_WIDTH; gx += tileW)
+        // Wells: pump housing on the ground line, lever on top (same texture, so submission order holds)
+        for (const GroundwaterWell& w : groundwater.wells)
         {
-            if (grassTexture.id != 0)
-                DrawTexture(grassTexture, gx, groundY, WHITE);
-            else
-                DrawRectangle(gx, groundY, tileW, GROUND_HEIGHT, DARKGREEN);
+            float groundY = (float)(SCREEN_HEIGHT - GROUND_HEIGHT);
+            SubmitSpriteRect(sprites, { w.x - 8.0f, groundY - 36.0f, 16.0f, 36.0f }, DARKGRAY, SPRITE_LAYER_PROPS);
+            SubmitSpriteRect(sprites, { w.x - 14.0f, groundY - 44.0f, 28.0f, 8.0f }, GRAY, SPRITE_LAYER_PROPS);
+            SubmitSpriteRect(sprites, { w.x - 1.5f, groundY - 56.0f, 3.0f, 12.0f }, GRAY, SPRITE_LAYER_PROPS);
+            SubmitSpriteRect(sprites, { w.x - 1.5f, groundY - 56.0f, 21.5f, 3.0f }, GRAY, SPRITE_LAYER_PROPS);
         }
 
-
-        // Draw finish flag
-        if (finishTexture.id != 0)
-        {
-            Rectangle srcF = { 0.0f, 0.0f, (float)finishTexture.width, (float)finishTexture.height };
-            Rectangle dstF = { finishFlagBounds.x, finishFlagBounds.y, finishFlagBounds.width, finishFlagBounds.height };
-            DrawTexturePro(finishTexture, srcF, dstF, { 0, 0 }, 0.0f, WHITE);
-        }
-        else
+        // Dams: concrete wall from the channel datum to just above the crest, foam while spilling
+        for (int i = 0; i < (int)water.dams.size(); ++i)
         {
-            DrawRectangle(finishFlagBounds.x, finishFlagBounds.y, finishFlagBounds.width, finishFlagBounds.height, RED);
+            const WaterDam& dam = water.dams[i];
+            float x = GetWaterDamX(water, i);
+            float top = waterDatumY - dam.crest - 6.0f;
+            SubmitSpriteRect(sprites, { x - 10.0f, top, 20.0f, waterDatumY - top }, CLITERAL(Color){ 150, 150, 140, 255 }, SPRITE_LAYER_PROPS);
+            SubmitSpriteRect(sprites, { x - 14.0f, top - 4.0f, 28.0f, 4.0f }, GRAY, SPRITE_LAYER_PROPS);
+            if (dam.spillFlow > 1.0f) SubmitSpriteRect(sprites, { x + 10.0f, top + 6.0f, 6.0f, waterDatumY - top - 6.0f }, Fade(WHITE, 0.6f), SPRITE_LAYER_PROPS);
         }
 
-        // Draw finish flag border
-        if (isDebugMode)
-        {
-            bool playerNearFlag = CheckCollisionRecs(player, finishFlagBounds);
-            Color zoneColor = playerNearFlag ? RED : YELLOW;
-            DrawRectangleLinesEx(finishFlagBounds, 2, zoneColor);
+        // Coins: only their rest positions go to the GPU, the bob is animated in the shader
+        coinInstances.clear();
+        for (int i = 0; i < game.activeCoinCount; ++i) {
+            const Coin& coin = game.activeCoins[i];
+            if (!coin.active) continue;
+            if (coinTexture.id != 0) {
+                coinInstances.push_back({ coin.position.x, coin.position.y, coin.bobOffset });
+            }
+            else {
+                float animY = coin.position.y + sinf((float)GetTime() * COIN_BOB_SPEED + coin.bobOffset) * COIN_BOB_AMPLITUDE;
+                DrawCircle((int)coin.position.x, (int)animY, 15, YELLOW);
+                DrawCircleLines((int)coin.position.x, (int)animY, 15, GOLD);
+            }
         }
-
-        // Draw NPCs
-        for (size_t i = 0; i < npcs.size(); ++i)
+        if (coinStress)
         {
-            NPC& npc = npcs[i];
-            bool isCurrentlyNear = ((int)i == foundNear);
-
-            if (isDebugMode)
+            // F9 stress test: a grid of coins over the whole world
+            float step = sqrtf((float)WORLD_WIDTH * WORLD_HEIGHT / COIN_STRESS_COUNT);
+            int columns = (int)(WORLD_WIDTH / step);
+            for (int i = 0; i < COIN_STRESS_COUNT; ++i)
             {
-                Color zoneColor = isCurrentlyNear ? (YELLOW) : YELLOW;
-                if (isCurrentlyNear) zoneColor = (/*dialogueFinished?*/ false ? DARKGRAY : RED);
-                DrawRectangleLinesEx(npc.interactionArea, 2, zoneColor);
+                coinInstances.push_back({ step * (i % columns + 0.5f), step * (i / columns + 0.5f), i * 0.37f });
             }
+        }
+        if (coinTexture.id != 0) coinSprites.size = { COIN_SIZE, COIN_SIZE * coinTexture.height / coinTexture.width };
+        SetSpriteInstances(coinSprites, coinInstances.data(), (int)coinInstances.size());
 
-            Texture2D const* texPtr = nullptr;
-            int frameWidth = 0;
-            int frameHeight = 0;
-            int frameCount = 0;
-            int frameIndex = 0;
-
-            if (npc.spriteId == 2 && catCrunchTexture.id != 0)
-            {
-                texPtr = &catCrunchTexture;
-                frameWidth = CATCRUNCH_FRAME_WIDTH;
-                frameHeight = CATCRUNCH_FRAME_HEIGHT;
-                frameCount = CATCRUNCH_FRAME_COUNT;
-                frameIndex = catCrunchFrame;
-            }
-            else if (npc.spriteId == 3 && catCryTexture.id != 0)
-            {
-                texPtr = &catCryTexture;
-                frameWidth = CATCRY_FRAME_WIDTH;
-                frameHeight = CATCRY_FRAME_HEIGHT;
-                frameCount = CATCRY_FRAME_COUNT;
-                frameIndex = catCryFrame;
-            }
-            else if (npc.spriteId == 1 && catPopTexture.id != 0)
-            {
-                texPtr = &catPopTexture;
-                frameWidth = CATPOP_FRAME_WIDTH;
-                frameHeight = CATPOP_FRAME_HEIGHT;
-                frameCount = CATPOP_FRAME_COUNT;
-                frameIndex = ((int)i == activeNPC && mouthOpen) ? 1 : 0;
-            }
-            else if (npcTexture.id != 0)
+        // F8 stress test: a sheet of coins over the view
+        if (spriteStress && coinTexture.id != 0)
+        {
+            Rectangle src = { 0.0f, 0.0f, (float)coinTexture.width, (float)coinTexture.height };
+            int columns = (int)sqrtf((float)SPRITE_STRESS_COUNT * SCREEN_WIDTH / SCREEN_HEIGHT);
+            float step = (float)SCREEN_WIDTH / columns;
+            for (int i = 0; i < SPRITE_STRESS_COUNT; ++i)
             {
-                texPtr = &npcTexture;
-                frameWidth = NPC_FRAME_WIDTH;
-                frameHeight = NPC_FRAME_HEIGHT;
-                frameCount = NPC_FRAME_COUNT;
-                frameIndex = ((int)i == activeNPC && mouthOpen) ? 1 : 0;
+                float bob = sinf((float)GetTime() * 3.0f + i * 0.37f) * 4.0f;
+                Rectangle dst = { viewMinX + (i % columns) * step, (i / columns) * step + bob, step, step };
+                SubmitSprite(sprites, coinTexture, src, dst, WHITE, SPRITE_LAYER_PICKUPS);
             }
+        }
 
-            if (frameCount > 0 && frameIndex >= frameCount) frameIndex = frameCount - 1;
+        // NPCs
+        for (size_t i = 0; i < npcs.size(); ++i)
+        {
+            const NPC& npc = npcs[i];
+            const AnimationClip& clip = clips[animators[npc.animator].clip];
 
-            if (texPtr != nullptr && texPtr->id != 0)
+            if (npc.animatedSprite >= 0 && IsClipDrawable(clip)) continue;
+            if (IsClipDrawable(clip))
             {
                 float targetHeight = npc.bounds.height * 2.2f;
-                float scale = targetHeight / (float)frameHeight;
-                float renderW = frameWidth * scale;
-                float renderH = frameHeight * scale;
+                float scale = targetHeight / (float)clip.frameHeight;
+                float renderW = clip.frameWidth * scale;
+                float renderH = clip.frameHeight * scale;
 
                 float destX = npc.bounds.x + npc.bounds.width / 2.0f - renderW / 2.0f;
                 float destY = npc.bounds.y + npc.bounds.height - renderH;
 
-                Rectangle srcRec = { (float)(frameIndex * frameWidth), 0.0f, (float)frameWidth, (float)frameHeight };
+                Rectangle srcRec = GetClipFrameRect(clip, animators[npc.animator].frame);
                 Rectangle destRec = { destX, destY, renderW, renderH };
 
-                DrawTexturePro(*texPtr, srcRec, destRec, { 0, 0 }, 0.0f, WHITE);
+                SubmitSprite(sprites, *clip.sheet, srcRec, destRec, WHITE, SPRITE_LAYER_CHARACTERS);
             }
             else
             {
-                DrawRectangleRec(npc.bounds, BLUE);
-                DrawTextEx(uiFont, "NPC", { npc.bounds.x + 5, npc.bounds.y - 20 }, 20.0f, 1.0f, BLUE);
+                SubmitSpriteRect(sprites, npc.bounds, BLUE, SPRITE_LAYER_CHARACTERS);
             }
         }
 
-        // Player
-        if (finishTriggered && happyTexture.id != 0)
-        {
-            int totalFramesPlayed = (int)floorf(happyTimer / HAPPY_FRAME_TIME);
-            int happyFrameIndex = totalFramesPlayed % HAPPY_FRAME_COUNT;
-            int cols = (happyTexture.width > 0) ? (happyTexture.width / HAPPY_FRAME_W) : 1;
-            if (cols <= 0) cols = 1;
-            int row = happyFrameIndex / cols;
-            int col = happyFrameIndex % cols;
-            float srcX = (float)(col * HAPPY_FRAME_W);
-            float srcY = (float)(row * HAPPY_FRAME_H);
-
-            if (srcX + HAPPY_FRAME_W > happyTexture.width) srcX = (float)max(0, happyTexture.width - HAPPY_FRAME_W);
-            if (srcY + HAPPY_FRAME_H > happyTexture.height) srcY = (float)max(0, happyTexture.height - HAPPY_FRAME_H);
+        // Player: current pose from the state machine, previous pose fading out on top during a blend
+        auto submitPlayerPose = [&](int clipId, int frame, float alpha, int layer) {
+            const AnimationClip& clip = clips[clipId];
+            if (!IsClipDrawable(clip) || alpha <= 0.0f) return;
 
-            Rectangle srcRec = { srcX, srcY, (float)HAPPY_FRAME_W, (float)HAPPY_FRAME_H };
-            Rectangle destRec = { player.x, player.y - HAPPY_DRAW_OFFSET_Y, HAPPY_RENDER_SIZE, HAPPY_RENDER_SIZE };
-            DrawTexturePro(happyTexture, srcRec, destRec, { 0, 0 }, 0.0f, WHITE);
-        }
-        else
-        {
-            // normal player rendering (jump/run/walk)
-            if (isJumping && catJumpTexture.id != 0)
+            Rectangle srcRec = GetClipFrameRect(clip, frame);
+            Rectangle destRec = { game.player.x, game.player.y, game.player.width, game.player.height };
+            if (clipId == CLIP_HAPPY)
             {
-                Rectangle sourceRec = {
-                    (float)jumpFrame * (float)FRAME_WIDTH,
-                    0.0f,
-                    (float)FRAME_WIDTH * frameDirection,
-                    (float)FRAME_HEIGHT
-                };
-                Rectangle destRec = {
-                    player.x,
-                    player.y,
-                    player.width,
-                    player.height
-                };
-                DrawTexturePro(catJumpTexture, sourceRec, destRec, { 0, 0 }, 0.0f, WHITE);
-            }
-            else if (speedMultiplier > 1.0f && isMoving && catRunTexture.id != 0)
-            {
-                Rectangle sourceRec = {
-                    (float)currentRunFrame * (float)FRAME_WIDTH,
-                    0.0f,
-                    (float)FRAME_WIDTH * frameDirection,
-                    (float)FRAME_HEIGHT
-                };
-                Rectangle destRec = {
-                    player.x,
-                    player.y,
-                    player.width,
-                    player.height
-                };
-                DrawTexturePro(catRunTexture, sourceRec, destRec, { 0, 0 }, 0.0f, WHITE);
+                destRec = { game.player.x, game.player.y - HAPPY_DRAW_OFFSET_Y, HAPPY_RENDER_SIZE, HAPPY_RENDER_SIZE };
             }
             else
             {
-                Rectangle sourceRec = {
-                    (float)currentFrame * FRAME_WIDTH,
-                    0.0f,
-                    FRAME_WIDTH * frameDirection,
-                    FRAME_HEIGHT
-                };
-                Rectangle destRec = {
-                    player.x,
-                    player.y,
-                    player.width,
-                    player.height
-                };
-                DrawTexturePro(catWalkTexture, sourceRec, destRec, { 0, 0 }, 0.0f, WHITE);
+                srcRec.width *= game.frameDirection;
             }
+            SubmitSprite(sprites, *clip.sheet, srcRec, destRec, Fade(WHITE, alpha), layer);
+            };
+
+        const Animator& playerAnimator = animators[playerAnim.animator];
+        submitPlayerPose(playerAnimator.clip, playerAnimator.frame, 1.0f, SPRITE_LAYER_PLAYER);
+        if (playerAnim.blend.weight > 0.0f)
+        {
+            submitPlayerPose(playerAnim.blend.clip, playerAnim.blend.frame, playerAnim.blend.weight, SPRITE_LAYER_PLAYER_BLEND);
+        }
+
+        // Props behind the river, then the river mesh mirroring the sky of the biome on screen
+        FlushSpriteBatch(sprites, SPRITE_LAYER_PROPS);
+        DrawAnimatedSprites(animatedSprites, SPRITE_LAYER_PROPS, (float)GetTime());
+        {
+            int skyBiome = game.displayedBiome;
+            if (game.fadingTo != -1) skyBiome = (game.fadeTimer / FADE_DURATION > 0.5f) ? game.fadingTo : game.fadingFrom;
+            Texture2D sky = { 0 };
+            float skyScroll = 0.0f;
+            float skyScale = 1.0f;
+            if (skyBiome < 0 || camera.target.x <= 0 || !GetParallaxSky(parallax, skyBiome, camera.target.x, sky, skyScroll, skyScale)) sky.id = 0;
+            DrawWaterRenderer(waterRenderer, sky, skyScroll, skyScale);
         }
+        FlushSpriteBatch(sprites, SPRITE_LAYER_PICKUPS);
+        DrawInstancedSprites(coinSprites, coinTexture, (float)GetTime());
+        FlushSpriteBatch(sprites, SPRITE_LAYER_CHARACTERS);
+        DrawAnimatedSprites(animatedSprites, SPRITE_LAYER_CHARACTERS, (float)GetTime());
+        FlushSpriteBatch(sprites);
+
+        // Labels of NPCs without a sprite sheet, over their placeholder rectangles
+        for (const NPC& npc : npcs)
+            if (!IsClipDrawable(clips[animators[npc.animator].clip])) DrawTextEx(ui.font, "NPC", { npc.bounds.x + 5, npc.bounds.y - 20 }, 20.0f, 1.0f, BLUE);
 
+        // Rain, splashes and sparks in front of everything in the world
+        DrawParticles(particles);
+
+        // Interaction zones on top of the sprites
         if (isDebugMode)
         {
-            DrawRectangleLinesEx(player, 2, GREEN);
+            if (IsClipDrawable(spinningClip) && !game.spinningCatVanished && !game.spinningCatVanishing)
+            {
+                DrawRectangleLinesEx(spinningCatInteractionArea, 2, nearSpinningCat ? RED : YELLOW);
+            }
+
+            bool playerNearFlag = CheckCollisionRecs(game.player, finishFlagBounds);
+            DrawRectangleLinesEx(finishFlagBounds, 2, playerNearFlag ? RED : YELLOW);
+
+            for (size_t i = 0; i < npcs.size(); ++i)
+            {
+                DrawRectangleLinesEx(npcs[i].interactionArea, 2, ((int)i == foundNear) ? RED : YELLOW);
+            }
+
+            DrawRectangleLinesEx(game.player, 2, GREEN);
         }
 
         EndMode2D();
+        EndScaledWorld();
+
+        ClearBackground(BLACK);
+        DrawScaledWorld(scaler);
+        BeginUi(ui);
 
         // Draw congratulation animation
-        if (finishTriggered && congratsTexture.id != 0)
+        if (game.finishTriggered && congratsTexture.id != 0)
         {
-            int frameIndex = (int)floorf(congratsTimer / CONGRATS_FRAME_TIME) % CONGRATS_FRAMES;
-            int cols = (congratsTexture.width > 0) ? (congratsTexture.width / CONGRATS_W) : 1;
-            if (cols <= 0) cols = 1;
-            int row = frameIndex / cols;
-            int col = frameIndex % cols;
-            float srcX = (float)(col * CONGRATS_W);
-            float srcY = (float)(row * CONGRATS_H);
-
-            if (srcX + CONGRATS_W > congratsTexture.width) srcX = (float)max(0, congratsTexture.width - CONGRATS_W);
-            if (srcY + CONGRATS_H > congratsTexture.height) srcY = (float)max(0, congratsTexture.height - CONGRATS_H);
-
-            Rectangle src = { srcX, srcY, (float)CONGRATS_W, (float)CONGRATS_H };
+            Rectangle src = GetClipFrameRect(clips[CLIP_CONGRATS], animators[congratsAnimator].frame);
 
-            float cx = (float)SCREEN_WIDTH * 0.5f - CONGRATS_RENDER_W * 0.5f;
+            float cx = ui.width * 0.5f - CONGRATS_RENDER_W * 0.5f;
             Rectangle dst = { cx, CONGRATS_MARGIN_TOP, CONGRATS_RENDER_W, CONGRATS_RENDER_H };
             DrawTexturePro(congratsTexture, src, dst, { 0, 0 }, 0.0f, WHITE);
         }
 
         // Dialogue box
-        if (!finishTriggered && activeNPC != -1)
+        if (!game.finishTriggered && game.activeNPC != -1)
         {
             Rectangle dialogueBoxRec = {
-                (float)SCREEN_WIDTH * 0.1f,
+                ui.width * 0.1f,
                 10.0f,
-                (float)SCREEN_WIDTH * 0.8f,
+                ui.width * 0.8f,
                 (float)TEXTBOX_HEIGHT
             };
             DrawRectangleRec(dialogueBoxRec, CLITERAL(Color){ 20, 20, 20, 220 });
             DrawRectangleLinesEx(dialogueBoxRec, 5, WHITE);
 
-            string visibleText = wrappedDialogueText.substr(0, textDisplayLength);
-            DrawWrappedText(uiFont, visibleText, dialogueBoxRec.x + TEXT_PADDING, dialogueBoxRec.y + TEXT_PADDING, TEXT_FONT_SIZE, 4.0f, WHITE);
+            string visibleText = dialogueText.wrapped.substr(0, game.textDisplayLength);
+            DrawWrappedText(ui.font, visibleText, dialogueBoxRec.x + TEXT_PADDING, dialogueBoxRec.y + TEXT_PADDING, TEXT_FONT_SIZE, 4.0f, WHITE);
         }
 
         if (isDebugMode)
         {
-            DrawTextEx(uiFont, TextFormat("Player X: %.2f", player.x), { 10.0f, 10.0f }, 20.0f, 1.0f, DARKGRAY);
-            DrawTextEx(uiFont, TextFormat("Active NPC: %s", activeNPC == -1 ? "NONE" : "YES"), { 10.0f, 40.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Player X: %.2f", game.player.x), { 10.0f, 10.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Active NPC: %s", game.activeNPC == -1 ? "NONE" : "YES"), { 10.0f, 40.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Water: %.3f ms (%d workers, %d/%d tiles coarse), pollution %.3f ms x%d, Aral level %.1f", water.lastUpdateMs, GetJobWorkerCount(jobs), water.coarseTiles, (int)water.tiles.size(), pollution.lastStepMs, pollution.lastSubsteps, GetWaterMeanLevel(water, ARAL_NPC_X - ARAL_BASIN_HALF_WIDTH, ARAL_NPC_X + ARAL_BASIN_HALF_WIDTH)), { 10.0f, 70.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Particles: %d, update %.3f ms, draw %.3f ms%s", GetParticleCount(particles), particles.lastUpdateMs, particles.lastDrawMs, rainStress ? " [F4 stress]" : ""), { 10.0f, 100.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Water cycle: %.3f ms, day %d", waterCycle.lastUpdateMs, (int)(waterCycle.hours / 24.0)), { 10.0f, 130.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Groundwater: %.3f ms/frame, %.2f ms/step, CG %d it, residual %.1e", groundwater.lastFrameMs, groundwater.lastSolveMs, groundwater.lastIterations, groundwater.lastResidual), { 10.0f, 160.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Aral: year %.2f, %d chunk decodes", game.aralYear, aral.chunksDecoded), { 10.0f, 190.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Water mesh: %d edges, upload %.3f ms, draw %.3f ms%s", waterRenderer.edgeCount, waterRenderer.lastUploadMs, waterRenderer.lastDrawMs, waterRenderer.hasShader ? "" : " [no shader]"), { 10.0f, 220.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Snapshot: %d bytes, last save %.0f us [F6 save, F7 load]", GAME_STATE_HEADER_SIZE + (int)sizeof(GameState), lastSnapshotUs), { 10.0f, 250.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Rewind: %.1f s in %d KB, record %.4f ms, restore %.4f ms%s", GetRewindSeconds(rewind), (int)(rewind.storedBytes / 1024), rewind.lastRecordMs, rewind.lastRestoreMs, rewinding ? " [rewinding]" : ""), { 10.0f, 280.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Hot reload: %s, %d assets reloaded, last swap %.3f ms", IsHotReloaderUsingInotify(hotReloader) ? "inotify" : "polling", GetHotReloadCount(hotReloader), GetHotReloadApplyMs(hotReloader)), { 10.0f, 310.0f }, 20.0f, 1.0f, DARKGRAY);
+            AssetCacheStats assetStats = GetAssetCacheStats(assets);
+            DrawTextEx(ui.font, TextFormat("Assets: %d/%d resident, %.1f of %.0f MB, %d hits, %d loads, %d evicted", assetStats.resident, assetStats.entries, assetStats.residentBytes / 1048576.0f, assetStats.budgetBytes / 1048576.0f, assetStats.hits, assetStats.loads, assetStats.evictions), { 10.0f, 340.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Sprites: %d in %d draw calls, flush %.3f ms%s%s", sprites.lastSprites, sprites.lastDrawCalls, sprites.lastFlushMs, sprites.hasShader ? "" : " [no shader]", spriteStress ? " [F8 stress]" : ""), { 10.0f, 370.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Coins: %d instances in 1 draw call, %d uploads, draw %.3f ms%s%s", coinSprites.count, coinSprites.uploads, coinSprites.lastDrawMs, coinSprites.instanced ? "" : " [no instancing]", coinStress ? " [F9 stress]" : ""), { 10.0f, 400.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Animated sprites: %d in %d draw calls, %d uploads, draw %.3f ms%s", (int)animatedSprites.upload.size(), (int)animatedSprites.groups.size(), animatedSprites.uploads, animatedSprites.lastDrawMs, animatedSprites.instanced ? "" : " [CPU frames]"), { 10.0f, 430.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("Sim step: %.3f ms %s, main thread waited %.3f ms", GetSimStepMs(sim), IsSimThreaded(sim) ? "during EndDrawing" : "inline [--no-sim-thread]", GetSimWaitMs(sim)), { 10.0f, 460.0f }, 20.0f, 1.0f, DARKGRAY);
+            DrawTextEx(ui.font, TextFormat("World resolution: %dx%d (%d%%), frame %.2f ms of which %.2f ms update, %d changes", scaler.width, scaler.height, (int)lroundf(RESOLUTION_LEVELS[scaler.level] * 100.0f), scaler.smoothedFrame * 1000.0f, scaler.smoothedUpdate * 1000.0f, scaler.changes), { 10.0f, 490.0f }, 20.0f, 1.0f, DARKGRAY);
+        }
+
+        // Pollution source toggles near the pollution lesson
+        if (fabsf(game.player.x + game.player.width / 2.0f - POLLUTION_NPC_X) < SEG_W / 2.0f)
+        {
+            DrawTextEx(ui.font, TextFormat("[1] Zrzut ścieków: %s   [2] Oczyszczalnia: %s",
+                pollution.sources[factoryOutfall].active ? "WŁ" : "WYŁ",
+                pollution.sources[treatmentPlant].active ? "WŁ" : "WYŁ"),
+                { 10.0f, ui.height - 30.0f }, 20.0f, 1.0f, WHITE);
+        }
+
+        // Aquifer cross-section near the over-extraction lesson: the whole world squeezed into a
+        // strip, blue where the aquifer is full and sand-coloured where wells have drawn it down
+        if (fabsf(game.player.x + game.player.width / 2.0f - EXTRACTION_NPC_X) < SEG_W / 2.0f)
+        {
+            if (groundwaterTextureDirty && groundwaterTexture.id != 0)
+            {
+                const Color full = { 30, 80, 170, 255 };
+                const Color dry = { 194, 160, 100, 255 };
+                for (int i = 0; i < groundwater.columns * groundwater.rows; ++i)
+                {
+                    float t = (WATER_START_LEVEL - groundwater.head[i]) / GROUNDWATER_VIEW_DRAWDOWN;
+                    groundwaterPixels[i] = ColorLerp(full, dry, fminf(1.0f, fmaxf(0.0f, t)));
+                }
+                UpdateTexture(groundwaterTexture, groundwaterPixels.data());
+                groundwaterTextureDirty = false;
+            }
+
+            Rectangle section = { ui.width - 660.0f, ui.height - 170.0f, 640.0f, 128.0f };
+            float sx = section.width / (float)WORLD_WIDTH;
+            DrawRectangle((int)section.x - 10, (int)section.y - 34, (int)section.width + 20, (int)section.height + 44, ColorAlpha(BLACK, 0.5f));
+            DrawTexturePro(groundwaterTexture, { 0.0f, 0.0f, (float)groundwaterTexture.width, (float)groundwaterTexture.height }, section, { 0, 0 }, 0.0f, WHITE);
+            for (const GroundwaterWell& w : groundwater.wells)
+            {
+                float wx = section.x + w.x * sx;
+                float wy = section.y + (w.row + 0.5f) * GROUNDWATER_CELL_HEIGHT * section.height / GROUNDWATER_DEPTH;
+                DrawLineEx({ wx, section.y }, { wx, wy }, 2.0f, DARKGRAY);
+            }
+            float px = section.x + (game.player.x + game.player.width / 2.0f) * sx;
+            DrawTriangle({ px - 6.0f, section.y - 10.0f }, { px, section.y }, { px + 6.0f, section.y - 10.0f }, YELLOW);
+            DrawTextEx(ui.font, TextFormat("[3] Studnia  [4] Zamknij studnię   studnie: %d/%d, obniżenie zwierciadła: %.1f",
+                (int)groundwater.wells.size(), GROUNDWATER_MAX_WELLS, WATER_START_LEVEL - GetGroundwaterTableAt(groundwater, game.player.x + game.player.width / 2.0f)),
+                { section.x, section.y - 30.0f }, 20.0f, 1.0f, WHITE);
+        }
+
+        // Aral time-lapse timeline with the interpolated values, or the hint to start it
+        if (fabsf(game.player.x + game.player.width / 2.0f - ARAL_NPC_X) < SEG_W / 2.0f && aral.loaded)
+        {
+            if (game.aralTimelapse)
+            {
+                const float firstYear = GetAralScenarioFirstYear(aral);
+                const float lastYear = GetAralScenarioLastYear(aral);
+                DrawRectangleRec({ 0.0f, aralTimeline.y - 44.0f, ui.width, 80.0f }, ColorAlpha(BLACK, 0.5f));
+                DrawTextEx(ui.font, TextFormat("Jezioro Aralskie %d   poziom %.1f m n.p.m.   powierzchnia %.0f km2   objętość %.0f km3   [,/.] przewijanie  [5] koniec",
+                    (int)game.aralYear, aralNow.level, aralNow.area, aralNow.volume), { aralTimeline.x, aralTimeline.y - 36.0f }, 20.0f, 1.0f, WHITE);
+
+                float t = (game.aralYear - firstYear) / fmaxf(1.0f, lastYear - firstYear);
+                DrawRectangleRec(aralTimeline, DARKGRAY);
+                DrawRectangleRec({ aralTimeline.x, aralTimeline.y, aralTimeline.width * t, aralTimeline.height }, SKYBLUE);
+                for (int decade = ((int)firstYear + 9) / 10 * 10; decade <= (int)lastYear; decade += 10)
+                {
+                    float dx = aralTimeline.x + aralTimeline.width * (decade - firstYear) / (lastYear - firstYear);
+                    DrawLineEx({ dx, aralTimeline.y }, { dx, aralTimeline.y + aralTimeline.height }, 1.0f, LIGHTGRAY);
+                }
+                float mx = aralTimeline.x + aralTimeline.width * t;
+                DrawRectangleRec({ mx - 4.0f, aralTimeline.y - 4.0f, 8.0f, aralTimeline.height + 8.0f }, aralDragging ? YELLOW : WHITE);
+            }
+            else
+            {
+                DrawTextEx(ui.font, "[5] Jezioro Aralskie w latach 1960-2020   [6] Zbuduj tamę na rzece", { 10.0f, ui.height - 30.0f }, 20.0f, 1.0f, WHITE);
+            }
+        }
+
+        // Nearest dam in view: reservoir, releases, power and what happens to the sediment
+        {
+            int shown = -1;
+            float playerMid = game.player.x + game.player.width / 2.0f;
+            for (int i = 0; i < (int)water.dams.size(); ++i)
+                if (fabsf(GetWaterDamX(water, i) - playerMid) < SEG_W / 2.0f && (shown == -1 || fabsf(GetWaterDamX(water, i) - playerMid) < fabsf(GetWaterDamX(water, shown) - playerMid))) shown = i;
+            if (shown != -1)
+            {
+                const WaterDam& dam = water.dams[shown];
+                float capacity = fmaxf(1.0f, GetWaterDamStorage(dam, dam.crest));
+                float meanScour = (float)(dam.scouredSediment / (WATER_DAM_SCOUR_CELLS * water.cellSize));
+                Rectangle panel = { ui.width - 600.0f, 80.0f, 580.0f, 112.0f };
+                DrawRectangleRec(panel, ColorAlpha(BLACK, 0.5f));
+                DrawTextEx(ui.font, TextFormat("Tama: zbiornik %3.0f%% (poziom %.1f / korona %.0f)   [6] rozbierz", 100.0f * dam.poolStorage / capacity, dam.poolLevel, dam.crest),
+                    { panel.x + 10.0f, panel.y + 8.0f }, 20.0f, 1.0f, WHITE);
+                DrawTextEx(ui.font, TextFormat("Dopływ %.0f, turbiny %.0f, przelew %.0f, moc %.0f MW", dam.inflow, dam.turbineFlow, dam.spillFlow, dam.power * DAM_MW_PER_UNIT),
+                    { panel.x + 10.0f, panel.y + 34.0f }, 20.0f, 1.0f, WHITE);
+                DrawTextEx(ui.font, TextFormat("Osady zatrzymane w zbiorniku: %.0f%%, zamulenie %.1f%%", 100.0f * dam.trapEfficiency, 100.0f * dam.trappedSediment / capacity),
+                    { panel.x + 10.0f, panel.y + 60.0f }, 20.0f, 1.0f, WHITE);
+                DrawTextEx(ui.font, TextFormat("Erozja koryta poniżej tamy: %.1f (max %.0f)", meanScour, WATER_DAM_MAX_SCOUR),
+                    { panel.x + 10.0f, panel.y + 86.0f }, 20.0f, 1.0f, meanScour > 0.5f * WATER_DAM_MAX_SCOUR ? ORANGE : WHITE);
+            }
+        }
+
+        // Water balance of every biome near the water-cycle lesson, rates extrapolated to a year
+        if (fabsf(game.player.x + game.player.width / 2.0f - WATER_CYCLE_NPC_X) < SEG_W / 2.0f)
+        {
+            float lineY = ui.height - 30.0f - 24.0f * BIOME_CLIMATE_COUNT;
+            DrawRectangle(0, (int)lineY - 34, 640, 34 + 24 * BIOME_CLIMATE_COUNT + 10, ColorAlpha(BLACK, 0.5f));
+            DrawTextEx(ui.font, TextFormat("Obieg wody, dzień %d", (int)(waterCycle.hours / 24.0)), { 10.0f, lineY - 28.0f }, 20.0f, 1.0f, WHITE);
+            for (int b = 0; b < BIOME_CLIMATE_COUNT; ++b)
+            {
+                const WaterCycleTotals& t = waterCycle.totals[b];
+                double perYear = (t.hours > 0.0) ? WATER_CYCLE_HOURS_PER_YEAR / (t.hours * waterCycle.biomeColumns[b]) : 0.0;
+                DrawTextEx(ui.font, TextFormat("Biom %d: opady %4.0f mm/rok, parowanie %4.0f mm/rok, zapas %3.0f mm",
+                    b + 1, t.precipitation * perYear, t.evaporation * perYear, GetWaterCycleStorage(waterCycle, b)),
+                    { 10.0f, lineY + 24.0f * b }, 20.0f, 1.0f, (b == segIndex) ? YELLOW : WHITE);
+            }
         }
 
         // Tło licznika
-        DrawRectangle(SCREEN_WIDTH - 180, 20, 160, 50, ColorAlpha(BLACK, 0.5f));
+        DrawRectangleRec({ ui.width - 180.0f, 20.0f, 160.0f, 50.0f }, ColorAlpha(BLACK, 0.5f));
         if (coinTexture.id != 0) {
             float scale = 30.0f / coinTexture.width;
-            DrawTextureEx(coinTexture, { (float)SCREEN_WIDTH - 170, 30 }, 0, scale, WHITE);
+            DrawTextureEx(coinTexture, { ui.width - 170.0f, 30.0f }, 0, scale, WHITE);
         }
         else {
-            DrawCircle(SCREEN_WIDTH - 155, 45, 10, YELLOW);
+            DrawCircleV({ ui.width - 155.0f, 45.0f }, 10.0f, YELLOW);
         }
-        DrawTextEx(uiFont, TextFormat("x %d", collectedCoins), { (float)SCREEN_WIDTH - 130, 30 }, 30, 2, WHITE);
+        DrawTextEx(ui.font, TextFormat("x %d", game.collectedCoins), { ui.width - 130.0f, 30.0f }, 30, 2, WHITE);
+        EndUi();
+
+        // Everything above is done with the environment for this frame: step it while EndDrawing
+        // waits on the swap. The result shows up next frame, one frame behind the player.
+        KickSimStep(sim, [&water, &pollution, &waterCycle, &groundwater, &groundwaterTextureDirty, dt]() {
+            int waterTicks = AdvanceShallowWater(water, dt);
+            for (int t = 0; t < waterTicks; ++t) StepPollution(pollution, water, WATER_TICK);
+            UpdateWaterCycle(waterCycle, dt, &water);
+
+            // Rain soaks into the aquifer where the river is dry
+            for (int c = 0; c < groundwater.columns; ++c)
+            {
+                float x0 = groundwater.originX + c * GROUNDWATER_CELL_WIDTH;
+                groundwater.recharge[c] = GetWaterCyclePrecipitation(waterCycle, x0, x0 + GROUNDWATER_CELL_WIDTH) * GROUNDWATER_RECHARGE_PER_MM_H;
+            }
+            if (UpdateGroundwater(groundwater, water, dt)) groundwaterTextureDirty = true;
+            });
 
         EndDrawing();
     }
 
-    // Cleanup textures
-    UnloadTexture(catWalkTexture);
-    UnloadTexture(catRunTexture);
-    UnloadTexture(npcTexture);
-    UnloadTexture(catPopTexture);
-    UnloadTexture(catCrunchTexture);
-    UnloadTexture(catCryTexture);
-    UnloadTexture(catJumpTexture);
-    UnloadTexture(catSpinningTexture);
-
-    if (grassTexture.id != 0) UnloadTexture(grassTexture);
-    if (coinTexture.id != 0) UnloadTexture(coinTexture);
-    for (int i = 0; i < SEG_COUNT; ++i)
-        if (biomeTextures[i].id != 0) UnloadTexture(biomeTextures[i]);
-
-    // Unload finish/happy assets
-    if (finishTexture.id != 0) UnloadTexture(finishTexture);
-    if (happyTexture.id != 0) UnloadTexture(happyTexture);
-    if (congratsTexture.id != 0) UnloadTexture(congratsTexture);
-
-    UnloadFont(uiFont);
-
-    if (meow1Sound.frameCount != 0) UnloadSound(meow1Sound);
-    if (meow2Sound.frameCount != 0) UnloadSound(meow2Sound);
-    if (popSound.frameCount != 0) UnloadSound(popSound);
-    if (crunchSound.frameCount != 0) UnloadSound(crunchSound);
-    if (jumpSound.frameCount != 0) UnloadSound(jumpSound);
-    if (sprintSound.frameCount != 0) UnloadSound(sprintSound);
-    if (cheerSound.frameCount != 0) UnloadSound(cheerSound);
-    if (vanishSound.frameCount != 0) UnloadSound(vanishSound);
+    // The watcher goes first so nothing is swapped in while assets are unloaded
+    DestroyHotReloader(hotReloader);
+    DestroySimThread(sim);
+
+    UnloadStaticWorld(staticWorld);
+    UnloadParallaxBackground(parallax);
+    UnloadBiomeBackground(biomeBackground);
+    UnloadUiLayer(ui);
+    DestroyAssetCache(assets);
 
     // Stop and unload background music
     for (auto& m : musicPlaylist) {
@@ -1470,6 +1751,16 @@ int main(void)
         UnloadMusicStream(m);
     }
 
+    UnloadParticleSystem(particles);
+    UnloadSpriteBatch(sprites);
+    UnloadInstancedSprites(coinSprites);
+    UnloadAnimatedSprites(animatedSprites);
+    UnloadWaterRenderer(waterRenderer);
+    UnloadAralScenario(aral);
+    if (groundwaterTexture.id != 0) UnloadTexture(groundwaterTexture);
+    UnloadResolutionScaler(scaler);
+    DestroyJobSystem(jobs);
+
     CloseAudioDevice();
     CloseWindow();
     return 0;